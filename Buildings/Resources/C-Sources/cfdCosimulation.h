@@ -32,7 +32,91 @@
 #include <stdint.h> /* Needed to detect 32 vs. 64 bit using UINTPTR_MAX*/
 #endif
 
-CosimulationData *cosim;
-
 /*declare the ffd_dll function in DLL*/
 void *ffd_dll(CosimulationData *cosim);
+
+#if !defined(_MSC_VER) && !defined(__WIN32__) /* Linux*/
+/*declare the functions in DLL added with the message rings*/
+/*they are weak, so that they are NULL if the library does not export them*/
+void ffd_set_flag(CosimulationData *cosim, int *flag, int value)
+  __attribute__((weak));
+int ffd_wait_flag(CosimulationData *cosim, int *flag, int value, int equal,
+                  int timeout) __attribute__((weak));
+void ffd_free_sync(CosimulationData *cosim) __attribute__((weak));
+double *ffd_ring_reserve(CosimulationData *cosim, MessageRing *ring,
+                         int timeout) __attribute__((weak));
+void ffd_ring_commit(CosimulationData *cosim, MessageRing *ring)
+  __attribute__((weak));
+double *ffd_ring_peek(CosimulationData *cosim, MessageRing *ring, int timeout)
+  __attribute__((weak));
+void ffd_ring_release(CosimulationData *cosim, MessageRing *ring)
+  __attribute__((weak));
+#endif
+
+#ifndef _CFD_COSIMULATION_H
+#define _CFD_COSIMULATION_H
+/*
+ * Data exchanged with an FFD library built before the message rings
+ *
+ * Such a library only exports ffd_dll(), runs one room and exchanges the
+ * data through the flags of the Modelica and FFD data, which both sides poll.
+ */
+typedef struct {
+  REAL t; /* Current time of integration*/
+  REAL lt; /* Last time of integration*/
+  int flag; /* To control the data exchange. 0: old data, 1: new data; -1: Stop coupled simulation*/
+  REAL dt; /* Time step size for next synchronization*/
+  REAL *temHea; /* temHea[nSur]: Temperature or heat flow rate depending on surBou.bouCon*/
+  REAL sensibleHeat; /* Convective sensible heat input into the room*/
+  REAL latentHeat; /* Latent heat input into the room*/
+  REAL *shaConSig; /* shaConSig[nConExtWin], valid only when there is a shade*/
+  REAL *shaAbsRad; /* shaAbsRad[nConExtWin]: Radiation absorbed by shades*/
+  REAL p; /* Room average static pressure*/
+  REAL *mFloRatPor; /* mFloRatPor[nPorts]: Mass flow rates into the room*/
+  REAL *TPor; /* TPor[nPorts] Air temperatures of the medium*/
+  REAL **XiPor; /* XiPor[nPorts][Medium.nXi]: species concentration of inflowing medium at the port*/
+  REAL **CPor; /* CPor[nPorts][Medium.nC]: the trace substances of the inflowing medium*/
+}LegacyModelicaSharedData;
+
+typedef struct {
+  REAL t; /* Current time of integration*/
+  int flag; /* To control the data exchange. 0: old data, 1: new data*/
+  REAL *temHea; /* temHea[nSur]: Temperature or heat flow rate depending on surBou.bouCon*/
+  REAL TRoo; /* Averaged room air temperature*/
+  REAL *TSha; /* TSha[nConExtWin]: temperature for the shade if there is a shade*/
+  REAL *TPor; /* TPor[nPorts] Air temperatures that the medium has at the port*/
+  REAL **XiPor; /* XiPor[nPorts][Medium.nXi]: species concentration of medium at the port*/
+  REAL **CPor; /* CPor[nPorts][medium.nC]: the trace substances of medium at the port*/
+  REAL *senVal; /* senVal[nSen]: value of sensor data*/
+  char *msg; /* Message to be passed to Modelica*/
+}LegacyFfdSharedData;
+
+typedef struct{
+  ParameterSharedData *para; /* Same parameters as for the current library*/
+  LegacyFfdSharedData *ffd;
+  LegacyModelicaSharedData *modelica;
+} LegacyCosimulationData;
+
+/*
+ * Cosimulation data of one room
+ *
+ * The functions of the FFD library added with the message rings are looked up
+ * when the room is created, so that the C-Sources still work with a prebuilt
+ * library that has not been rebuilt since. Without them, the data is exchanged
+ * through legacy.
+ */
+typedef struct{
+  CosimulationData cosim; /* Data exchanged with the FFD library*/
+  void (*set_flag)(CosimulationData *cosim, int *flag, int value);
+  int (*wait_flag)(CosimulationData *cosim, int *flag, int value, int equal,
+                   int timeout);
+  void (*free_sync)(CosimulationData *cosim);
+  double *(*ring_reserve)(CosimulationData *cosim, MessageRing *ring,
+                          int timeout);
+  void (*ring_commit)(CosimulationData *cosim, MessageRing *ring);
+  double *(*ring_peek)(CosimulationData *cosim, MessageRing *ring,
+                       int timeout);
+  void (*ring_release)(CosimulationData *cosim, MessageRing *ring);
+  LegacyCosimulationData *legacy; /* Data for a library without the rings, NULL otherwise*/
+} CfdInstance;
+#endif
@@ -15,142 +15,213 @@
 #include <ModelicaUtilities.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <math.h>
 /*
- * Exchange the data between Modelica and CFD
+ * Exchange the data with an FFD library without the message rings
+ *
+ * The inputs and outputs are in the same order as in the messages.
  *
+ * @param legacy Pointer to the data exchanged with the library
  * @param t0 Current time of integration for Modelica
  * @param dt Time step size for next synchronization defined by Modelica
  * @param u Pointer to the input data from Modelica to CFD
- * @param nU Number of inputs from Modelica to CFD
- * @param nY Number of outputs from CFD to Modelica
- * @param y Pointer to the output data from CFD to Modelica
+ * @param y Pointer to the message from CFD: t1, nMisDea, y[nY]
  *
- * @return 0 if no error occurred
+ * @return No return needed
  */
-int cfdExchangeData(double t0, double dt, double *u, size_t nU, size_t nY,
-                 double *t1, double *y) {
-  size_t i, j, k;
-
-  /*check if current modelica time equals to last time*/
-  /*if yes, it means cfdExchangeData() was called multiple times at one synchronization point, then directly return*/
-  if(abs(cosim->modelica->lt - t0) < 1E-6){
-    return 0;
-  }
+static void cfdExchangeLegacy(LegacyCosimulationData *legacy, double t0,
+                              double dt, double *u, double *y) {
+  ParameterSharedData *para = legacy->para;
+  LegacyModelicaSharedData *modelica = legacy->modelica;
+  LegacyFfdSharedData *ffd = legacy->ffd;
+  int i, j, k;
 
-  /*--------------------------------------------------------------------------
-  | Write data to CFD
-  | Command:
-  | -1: fake data
-  |  0: data has been read by the other program
-  |  1: data waiting for the other program to read
-  --------------------------------------------------------------------------*/
   /* If previous data hasn't been read, wait*/
-  while(cosim->modelica->flag==1) {
-    if(cosim->para->ffdError==1)
-      ModelicaError(cosim->ffd->msg);
+  while(modelica->flag==1) {
+    if(para->ffdError==1)
+      ModelicaError(ffd->msg);
     else
       Sleep(10);
   }
 
-  cosim->modelica->t = t0;
-  cosim->modelica->dt = dt;
-  cosim->modelica->lt = t0;
+  modelica->t = t0;
+  modelica->dt = dt;
+  modelica->lt = t0;
 
   /* Copy the Modelica data to shared memory*/
-  for(i=0; i<cosim->para->nSur; i++) {
-    cosim->modelica->temHea[i] = u[i];
+  for(i=0; i<para->nSur; i++) {
+    modelica->temHea[i] = u[i];
   }
 
-  if(cosim->para->sha==1) {
-    for(j=0; j<cosim->para->nConExtWin; j++) {
-      cosim->modelica->shaConSig[j] = u[i+j];
-      cosim->modelica->shaAbsRad[j] = u[i+j+cosim->para->nConExtWin];
+  if(para->sha==1) {
+    for(j=0; j<para->nConExtWin; j++) {
+      modelica->shaConSig[j] = u[i+j];
+      modelica->shaAbsRad[j] = u[i+j+para->nConExtWin];
     }
-    i = i + 2*cosim->para->nConExtWin;
+    i = i + 2*para->nConExtWin;
   }
 
-  cosim->modelica->sensibleHeat = u[i];
-  i++;
-
-  cosim->modelica->latentHeat = u[i];
-  i++;
-
-  cosim->modelica->p = u[i];
-  i++;
+  modelica->sensibleHeat = u[i++];
+  modelica->latentHeat = u[i++];
+  modelica->p = u[i++];
 
-  for(j=0; j<cosim->para->nPorts; j++) {
-    cosim->modelica->mFloRatPor[j] = u[i+j];
-    cosim->modelica->TPor[j] = u[i+j+cosim->para->nPorts];
+  for(j=0; j<para->nPorts; j++) {
+    modelica->mFloRatPor[j] = u[i+j];
+    modelica->TPor[j] = u[i+j+para->nPorts];
   }
+  i = i + 2*para->nPorts;
 
-  i = i + 2*cosim->para->nPorts;
-  for(j=0; j<cosim->para->nPorts; j++)
-    for(k=0; k<cosim->para->nXi; k++) {
-      cosim->modelica->XiPor[j][k] = u[i+j*cosim->para->nXi+k];
-    }
+  for(j=0; j<para->nPorts; j++)
+    for(k=0; k<para->nXi; k++, i++)
+      modelica->XiPor[j][k] = u[i];
 
-  i = i + cosim->para->nPorts*cosim->para->nXi;
-  for(j=0; j<cosim->para->nPorts; j++)
-    for(k=0; k<cosim->para->nC; k++) {
-      cosim->modelica->CPor[j][k] = u[i+j*cosim->para->nC+k];
-    }
+  for(j=0; j<para->nPorts; j++)
+    for(k=0; k<para->nC; k++, i++)
+      modelica->CPor[j][k] = u[i];
 
   /* Set the flag to new data*/
-  cosim->modelica->flag = 1;
+  modelica->flag = 1;
 
-  /****************************************************************************
-  | Copy data from CFD
-  ****************************************************************************/
   /* If the data is not ready or not updated, check again*/
-  while(cosim->ffd->flag!=1) {
-    if(cosim->para->ffdError==1)
-      ModelicaError(cosim->ffd->msg);
+  while(ffd->flag!=1) {
+    if(para->ffdError==1)
+      ModelicaError(ffd->msg);
     else
       Sleep(10);
   }
 
-  /* Get the temperature/heat flux for solid surface*/
-  for(i=0; i<cosim->para->nSur; i++) {
-    y[i] = cosim->ffd->temHea[i];
-  }
+  /* The library does not count missed deadlines*/
+  y[0] = ffd->t;
+  y[1] = 0;
+  i = 2;
+
+  for(j=0; j<para->nSur; j++, i++)
+    y[i] = ffd->temHea[j];
+
+  y[i++] = ffd->TRoo;
+
+  if(para->sha==1)
+    for(j=0; j<para->nConExtWin; j++, i++)
+      y[i] = ffd->TSha[j];
+
+  for(j=0; j<para->nPorts; j++, i++)
+    y[i] = ffd->TPor[j];
+
+  for(j=0; j<para->nPorts; j++)
+    for(k=0; k<para->nXi; k++, i++)
+      y[i] = ffd->XiPor[j][k];
+
+  for(j=0; j<para->nPorts; j++)
+    for(k=0; k<para->nC; k++, i++)
+      y[i] = ffd->CPor[j][k];
+
+  for(j=0; j<para->nSen; j++, i++)
+    y[i] = ffd->senVal[j];
+
+  /* Update the data status*/
+  ffd->flag = 0;
+} /* End of cfdExchangeLegacy()*/
 
-  /* Get the averaged room temperature*/
-  y[i] = cosim->ffd->TRoo;
-  i++;
+/*
+ * Exchange the data between Modelica and CFD
+ *
+ * @param thread Pointer to the cosimulation data of the room
+ * @param t0 Current time of integration for Modelica
+ * @param dt Time step size for next synchronization defined by Modelica
+ * @param u Pointer to the input data from Modelica to CFD
+ * @param nU Number of inputs from Modelica to CFD
+ * @param nY Number of outputs from CFD to Modelica
+ * @param y Pointer to the output data from CFD to Modelica
+ *
+ * @return 0 if no error occurred
+ */
+int cfdExchangeData(void *thread, double t0, double dt, double *u, size_t nU,
+                 size_t nY, double *t1, double *y) {
+  CfdInstance *cfd = (CfdInstance *) thread;
+  CosimulationData *cosim = &cfd->cosim;
+  double *slot, *last;
+  int rejected;
+
+  if(nU+2!=(size_t) cosim->input->size || nY+2!=(size_t) cosim->output->size) {
+    ModelicaFormatError("Mismatched size of data exchange with CFD: nU=%d, nY=%d",
+                        (int) nU, (int) nY);
+  }
+  last = cosim->modelica->last;
 
-  /* Get the temperature of shading device if there is a shading device*/
-  if(cosim->para->sha==1) {
-    for(j=0; j<cosim->para->nConExtWin; i++, j++) {
-      y[i] = cosim->ffd->TSha[j];
+  /*check if current modelica time equals to last time*/
+  /*if yes and the data is the same, it means cfdExchangeData() was called multiple times at one synchronization point, then directly return the last data*/
+  /*if the time is earlier or the data changed, Modelica stepped back and FFD computes the window again from its state at t0*/
+  if(fabs(cosim->modelica->lt - t0) < 1E-6 && last[1] == dt
+     && memcmp(last+2, u, nU*sizeof(double)) == 0){
+    memcpy(y, last+nU+4, nY*sizeof(double));
+    *t1 = last[nU+2];
+    return 0;
+  }
+  /*if the time is not later, FFD computes the window from the last time with the rejected inputs*/
+  rejected = t0 < cosim->modelica->lt + 1E-6;
+
+  /* A library without the message rings cannot compute a window again and*/
+  /* keeps the outputs accepted at t0*/
+  if(cfd->legacy != NULL) {
+    if(rejected == 0) {
+      cfdExchangeLegacy(cfd->legacy, t0, dt, u, last+nU+2);
+      cosim->modelica->lt = t0;
     }
+    memcpy(y, last+nU+4, nY*sizeof(double));
+    *t1 = last[nU+2];
+    last[0] = t0;
+    last[1] = dt;
+    memcpy(last+2, u, nU*sizeof(double));
+    return 0;
   }
 
-  /* Get the temperature fluid at the fluid ports*/
-  for(j=0; j<cosim->para->nPorts; i++, j++) {
-    y[i] = cosim->ffd->TPor[j];
+  /*--------------------------------------------------------------------------
+  | Write data to CFD
+  | Message: t0, dt, u[nU]
+  --------------------------------------------------------------------------*/
+  /* If all the previous data hasn't been read, wait until FFD signals*/
+  while((slot=cfd->ring_reserve(cosim, cosim->input, 100))==NULL) {
+    if(cosim->para->ffdError==1)
+      ModelicaError(cosim->ffd->msg);
   }
 
-  /* Get the mass fraction at fluid ports*/
-  for(j=0; j<cosim->para->nPorts; j++)
-    for(k=0; k<cosim->para->nXi; k++, i++) {
-       y[i] = cosim->ffd->XiPor[j][k];
-    }
+  cosim->modelica->lt = t0;
 
-  /* Get the trace substance at fluid ports*/
-  for(j=0; j<cosim->para->nPorts; j++)
-    for(k=0; k<cosim->para->nC; k++, i++) {
-       y[i] = cosim->ffd->CPor[j][k];
-    }
+  /* Copy the Modelica data to the message*/
+  slot[0] = t0;
+  slot[1] = dt;
+  memcpy(slot+2, u, nU*sizeof(double));
 
-  /* Get the sensor data*/
-  for(j=0; j<cosim->para->nSen; j++, i++) {
-    y[i] = cosim->ffd->senVal[j];
+  /* Publish the new data and wake up FFD*/
+  cfd->ring_commit(cosim, cosim->input);
+
+  /****************************************************************************
+  | Copy data from CFD
+  | Message: t1, number of missed real-time deadlines, y[nY]
+  ****************************************************************************/
+  /* If the data is not ready or not updated, wait until FFD signals*/
+  while((slot=cfd->ring_peek(cosim, cosim->output, 100))==NULL) {
+    if(cosim->para->ffdError==1)
+      ModelicaError(cosim->ffd->msg);
   }
 
-  /* Update the data status*/
-  cosim->ffd->flag = 0;
+  /* Discard the outputs of a rejected window and return the outputs accepted*/
+  /* at t0 again, FFD sends the outputs of the new inputs at the next*/
+  /* synchronization point*/
+  if(rejected == 0) {
+    memcpy(last+nU+2, slot, (nY+2)*sizeof(double));
+  }
+  memcpy(y, last+nU+4, nY*sizeof(double));
+  *t1 = last[nU+2];
 
-  *t1 = cosim->ffd->t;
+  /* Keep the exchanged data for repeated calls*/
+  last[0] = t0;
+  last[1] = dt;
+  memcpy(last+2, u, nU*sizeof(double));
+
+  /* Update the data status*/
+  cfd->ring_release(cosim, cosim->output);
 
   return 0;
 } /* End of cfdExchangeData()*/
@@ -0,0 +1,31 @@
+/*
+ *
+ * \file   cfdMissedDeadlines.c
+ *
+ * \brief  Function to get the number of missed real-time deadlines of CFD
+ *
+ * \author Xu Han
+ *         University of Colorado Boulder
+ *         xuha3556@colorado.edu
+ *
+ * \date   10/18/2026
+ *
+ */
+#include "cfdCosimulation.h"
+
+/*
+ * Get the number of windows in which CFD missed the real-time deadline
+ *
+ * The number is sent by CFD with the outputs of the last exchange.
+ *
+ * @param thread Pointer to the cosimulation data of the room
+ *
+ * @return Number of missed deadlines
+ */
+int cfdMissedDeadlines(void *thread) {
+  CosimulationData *cosim = &((CfdInstance *) thread)->cosim;
+
+  /* The message from CFD follows the message to CFD: t1, nMisDea, y[nY]*/
+  /* last has input->size+output->size elements and output->size is nY+2*/
+  return (int) cosim->modelica->last[cosim->input->size+1];
+} /* End of cfdMissedDeadlines*/
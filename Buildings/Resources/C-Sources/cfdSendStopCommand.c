@@ -13,33 +13,116 @@
  */
 #include "cfdCosimulation.h"
 
+/*
+ * Wait for the feedback of FFD to the stop command
+ *
+ * @param cfd Pointer to the cosimulation data of the room
+ *
+ * @return 0 if FFD has stopped, 1 otherwise
+ */
+static int cfdWaitStop(CfdInstance *cfd) {
+  CosimulationData *cosim = &cfd->cosim;
+
+  /* A library without the message rings is polled*/
+  if(cfd->legacy != NULL) {
+    if(cosim->para->flag==0) {
+      Sleep(10);
+      return 1;
+    }
+    return 0;
+  }
+
+  return cfd->wait_flag(cosim, &cosim->para->flag, 0, 0, 10);
+} /* End of cfdWaitStop()*/
+
+/*
+ * Get the error message of FFD
+ *
+ * @param cfd Pointer to the cosimulation data of the room
+ *
+ * @return Pointer to the message
+ */
+static char *cfdErrorMessage(CfdInstance *cfd) {
+  if(cfd->legacy != NULL)
+    return cfd->legacy->ffd->msg;
+  return cfd->cosim.ffd->msg;
+} /* End of cfdErrorMessage()*/
+
+/*
+ * Free the data exchanged with an FFD library without the message rings
+ *
+ * @param legacy Pointer to the data exchanged with the library
+ *
+ * @return No return needed
+ */
+static void cfdFreeLegacy(LegacyCosimulationData *legacy) {
+  ParameterSharedData *para = legacy->para;
+  int i;
+
+  free(legacy->modelica->temHea);
+  free(legacy->modelica->shaConSig);
+  free(legacy->modelica->shaAbsRad);
+  free(legacy->modelica->mFloRatPor);
+  free(legacy->modelica->TPor);
+  free(legacy->ffd->temHea);
+  free(legacy->ffd->TSha);
+  free(legacy->ffd->TPor);
+  free(legacy->ffd->senVal);
+  for(i=0; i<para->nPorts; i++) {
+    if (legacy->modelica->XiPor != NULL){
+      free(legacy->modelica->XiPor[i]);
+    }
+    if (legacy->modelica->CPor != NULL){
+      free(legacy->modelica->CPor[i]);
+    }
+    if (legacy->ffd->XiPor != NULL){
+      free(legacy->ffd->XiPor[i]);
+    }
+    if (legacy->ffd->CPor != NULL){
+      free(legacy->ffd->CPor[i]);
+    }
+  }
+  free(legacy->modelica->XiPor);
+  free(legacy->modelica->CPor);
+  free(legacy->ffd->XiPor);
+  free(legacy->ffd->CPor);
+  free(legacy->modelica);
+  free(legacy->ffd);
+  free(legacy);
+} /* End of cfdFreeLegacy()*/
+
 /*
  * Send a stop command to terminate the CFD simulation
  *
+ * @param thread Pointer to the cosimulation data of the room
+ *
  * @return No return needed
  */
 void cfdSendStopCommand(void *thread) {
-
+  CfdInstance *cfd = (CfdInstance *) thread;
+  CosimulationData *cosim = &cfd->cosim;
   size_t i = 0;
   size_t imax = 10000;
 
   /*send stop command to FFD*/
-  cosim->para->flag = 0;
+  if(cfd->legacy != NULL)
+    cosim->para->flag = 0;
+  else
+    cfd->set_flag(cosim, &cosim->para->flag, 0);
 
   /* Wait for the feedback from FFD*/
- while(cosim->para->flag==0 && i<imax) {
+  while(cfdWaitStop(cfd)!=0 && i<imax) {
     if(cosim->para->ffdError==1) {
-      ModelicaError(cosim->ffd->msg);
+      ModelicaError(cfdErrorMessage(cfd));
     }
     else {
-      Sleep(10);
       i++;
     }
   }
 
   if(i<imax) {
     if(cosim->para->ffdError==1) {
-      ModelicaError(cosim->ffd->msg);
+      ModelicaError(cfdErrorMessage(cfd));
     }
     else {
       ModelicaMessage("Successfully stopped the FFD simulation.\n");
@@ -71,9 +154,6 @@ void cfdSendStopCommand(void *thread) {
     }
   }
   if (cosim->para->nSen>0){
-    if (cosim->ffd->senVal != NULL){
-      free(cosim->ffd->senVal);
-    }
     for(i=0; i<cosim->para->nSen; i++) {
       free(cosim->para->sensorName[i]);
     }
@@ -81,27 +161,7 @@ void cfdSendStopCommand(void *thread) {
       free(cosim->para->sensorName);
     }
   }
-  if (cosim->modelica->temHea != NULL){
-    free(cosim->modelica->temHea);
-  }
-  if (cosim->para->sha==1){
-    if (cosim->modelica->shaConSig != NULL){
-      free(cosim->modelica->shaConSig);
-    }
-    if (cosim->modelica->shaAbsRad != NULL){
-      free(cosim->modelica->shaAbsRad);
-    }
-    if (cosim->ffd->TSha != NULL){
-      free(cosim->ffd->TSha);
-    }
-  }
   if (cosim->para->nPorts>0){
-    for(i=0; i<cosim->para->nPorts; i++) {
-      free(cosim->modelica->XiPor[i]);
-      free(cosim->ffd->XiPor[i]);
-      free(cosim->modelica->CPor[i]);
-      free(cosim->ffd->CPor[i]);
-    }
     if (cosim->modelica->CPor != NULL){
       free(cosim->modelica->CPor);
     }
@@ -114,36 +174,44 @@ void cfdSendStopCommand(void *thread) {
     if (cosim->ffd->XiPor != NULL){
       free(cosim->ffd->XiPor);
     }
-    if (cosim->modelica->TPor != NULL){
-      free(cosim->modelica->TPor);
-    }
-    if (cosim->ffd->TPor != NULL){
-      free(cosim->ffd->TPor);
-    }
     for(i=0; i<cosim->para->nPorts; i++) {
       free(cosim->para->portName[i]);
     }
     if (cosim->para->portName != NULL){
       free(cosim->para->portName);
     }
-    if (cosim->modelica->mFloRatPor != NULL){
-      free(cosim->modelica->mFloRatPor);
-    }
   }
-  if (cosim->ffd->temHea != NULL){
-    free(cosim->ffd->temHea);
+  /* The arrays of Modelica and FFD data point to the messages in the rings*/
+  if (cosim->input != NULL){
+    free(cosim->input->mem);
+  }
+  if (cosim->output != NULL){
+    free(cosim->output->mem);
   }
   if (cosim->para != NULL){
     free(cosim->para);
   }
   if (cosim->modelica != NULL){
+    if (cosim->modelica->last != NULL){
+      free(cosim->modelica->last);
+    }
     free(cosim->modelica);
   }
   if (cosim->ffd != NULL){
+    if (cosim->ffd->msg != NULL){
+      free(cosim->ffd->msg);
+    }
     free(cosim->ffd);
   }
-  if (cosim != NULL){
-    free(cosim);
+  /* The FFD thread no longer uses the flags once it has stopped*/
+  if (i<imax){
+    if (cfd->legacy != NULL){
+      cfdFreeLegacy(cfd->legacy);
+    }
+    else {
+      cfd->free_sync(cosim);
+    }
   }
+  free(cfd);
 
 } /* End of cfdSendStopCommand*/
@@ -16,11 +16,126 @@
  */
 #include "cfdCosimulation.h"
 
+/*
+ * Allocate a message ring
+ *
+ * @param size Number of values in one message without the time and time step
+ * @param name Name of the ring used in the error message
+ *
+ * @return Pointer to the message ring
+ */
+static MessageRing *cfdAllocateRing(size_t size, const char *name) {
+  MessageRing *ring;
+  void *mem;
+  size_t line = FFD_CACHE_LINE/sizeof(double);
+  size_t stride;
+
+  /* Let every slot start at a cache line*/
+  stride = ((size + 2 + line - 1)/line)*line;
+  mem = calloc(1, FFD_CACHE_LINE + FFD_RING_OFFSET
+                  + FFD_RING_SIZE*stride*sizeof(double));
+  if (mem == NULL){
+    ModelicaFormatError("Failed to allocate memory for cosim->%s in cfdStartCosimulation.c", name);
+  }
+  /* The ring and its slots are in one block starting at a cache line*/
+  ring = (MessageRing *) (((uintptr_t) mem + FFD_CACHE_LINE - 1)
+                          & ~((uintptr_t) FFD_CACHE_LINE - 1));
+  ring->head = 0;
+  ring->tail = 0;
+  ring->size = (int) (size + 2);
+  ring->stride = (int) stride;
+  ring->offset = (int) FFD_RING_OFFSET;
+  ring->mem = mem;
+
+  return ring;
+} /* End of cfdAllocateRing()*/
+
+/*
+ * Allocate the data exchanged with an FFD library without the message rings
+ *
+ * @param legacy Pointer to the data exchanged with the library
+ * @param haveSensor Flag: 1->have sensor; 0->No sensor
+ *
+ * @return No return needed
+ */
+static void cfdAllocateLegacy(LegacyCosimulationData *legacy, int haveSensor) {
+  ParameterSharedData *para = legacy->para;
+  int i;
+
+  /* Set the flag to initial value*/
+  legacy->modelica->flag = 0;
+  legacy->ffd->flag = 0;
+  legacy->modelica->t = 0;
+  legacy->modelica->lt = -1;
+
+  legacy->modelica->temHea = (double *) malloc(para->nSur*sizeof(double));
+  if (legacy->modelica->temHea == NULL){
+    ModelicaError("Failed to allocate memory for cosim->modelica->temHea in cfdStartCosimulation.c");
+  }
+  /* Having a shade for window*/
+  if(para->sha==1) {
+    legacy->modelica->shaConSig = (double *) malloc(para->nConExtWin*sizeof(double));
+    if (legacy->modelica->shaConSig == NULL){
+      ModelicaError("Failed to allocate memory for cosim->modelica->shaConSig in cfdStartCosimulation.c");
+    }
+    legacy->modelica->shaAbsRad = (double *) malloc(para->nConExtWin*sizeof(double));
+    if (legacy->modelica->shaAbsRad == NULL){
+      ModelicaError("Failed to allocate memory for cosim->modelica->shaAbsRad in cfdStartCosimulation.c");
+    }
+    legacy->ffd->TSha = (double *) malloc(para->nConExtWin*sizeof(double));
+    if (legacy->ffd->TSha == NULL){
+      ModelicaError("Failed to allocate memory for cosim->ffd->TSha in cfdStartCosimulation.c");
+    }
+  }
+  legacy->modelica->mFloRatPor = (double *) malloc(para->nPorts*sizeof(double));
+  if (legacy->modelica->mFloRatPor == NULL){
+    ModelicaError("Failed to allocate memory for cosim->modelica->mFloRatPor in cfdStartCosimulation.c");
+  }
+  legacy->modelica->TPor = (double *) malloc(para->nPorts*sizeof(double));
+  if (legacy->modelica->TPor == NULL){
+    ModelicaError("Failed to allocate memory for cosim->modelica->TPor in cfdStartCosimulation.c");
+  }
+  legacy->modelica->XiPor = (double **) malloc(para->nPorts*sizeof(double *));
+  legacy->modelica->CPor = (double **) malloc(para->nPorts*sizeof(double *));
+  legacy->ffd->XiPor = (double **) malloc(para->nPorts*sizeof(double *));
+  legacy->ffd->CPor = (double **) malloc(para->nPorts*sizeof(double *));
+  if (legacy->modelica->XiPor == NULL || legacy->modelica->CPor == NULL
+      || legacy->ffd->XiPor == NULL || legacy->ffd->CPor == NULL){
+    ModelicaError("Failed to allocate memory for the species and trace substances in cfdStartCosimulation.c");
+  }
+  for(i=0; i<para->nPorts; i++) {
+    legacy->modelica->XiPor[i] = (double *) malloc(para->nXi*sizeof(double));
+    legacy->modelica->CPor[i] = (double *) malloc(para->nC*sizeof(double));
+    legacy->ffd->XiPor[i] = (double *) malloc(para->nXi*sizeof(double));
+    legacy->ffd->CPor[i] = (double *) malloc(para->nC*sizeof(double));
+    if (legacy->modelica->XiPor[i] == NULL || legacy->modelica->CPor[i] == NULL
+        || legacy->ffd->XiPor[i] == NULL || legacy->ffd->CPor[i] == NULL){
+      ModelicaError("Failed to allocate memory for the species and trace substances in cfdStartCosimulation.c");
+    }
+  }
+
+  legacy->ffd->temHea = (double *) malloc(para->nSur*sizeof(double));
+  if (legacy->ffd->temHea == NULL){
+    ModelicaError("Failed to allocate memory for cosim->ffd->temHea in cfdStartCosimulation.c");
+  }
+  legacy->ffd->TPor = (double *) malloc(para->nPorts*sizeof(double));
+  if (legacy->ffd->TPor == NULL){
+    ModelicaError("Failed to allocate memory for cosim->ffd->TPor in cfdStartCosimulation.c");
+  }
+  if(haveSensor) {
+    legacy->ffd->senVal = (double *) malloc(para->nSen*sizeof(double));
+    if (legacy->ffd->senVal == NULL){
+      ModelicaError("Failed to allocate memory for cosim->ffd->senVal in cfdStartCosimulation.c");
+    }
+  }
+} /* End of cfdAllocateLegacy()*/
+
 /*
  * Start the cosimulation
  *
  * Allocate memory for the data exchange and launch CFD simulation
  *
+ * @param thread Pointer to the cosimulation data of the room
  * @param cfdFilNam Name of the input file for the CFD simulation
  * @param name Pointer to the names of surfaces and fluid ports
  * @param A Pointer to the area of surfaces in the same order of name
@@ -41,10 +156,13 @@
  *
  * @return 0 if no error occurred
  */
-int cfdStartCosimulation(char *cfdFilNam, char **name, double *A, double *til,
-                int *bouCon, int nPorts, char** portName, int haveSensor,
-                char **sensorName, int haveShade, size_t nSur, size_t nSen,
-                size_t nConExtWin, size_t nXi, size_t nC, double rho_start) {
+int cfdStartCosimulation(void *thread, char *cfdFilNam, char **name, double *A,
+                double *til, int *bouCon, int nPorts, char** portName,
+                int haveSensor, char **sensorName, int haveShade, size_t nSur,
+                size_t nSen, size_t nConExtWin, size_t nXi, size_t nC,
+                double rho_start) {
+  CfdInstance *cfd = (CfdInstance *) thread;
+  CosimulationData *cosim = &cfd->cosim;
   size_t i;
   size_t nBou;
 
@@ -116,10 +234,6 @@ int cfdStartCosimulation(char *cfdFilNam, char **name, double *A, double *til,
     if (  cosim->para->sensorName == NULL){
       ModelicaError("Failed to allocate memory for cosim->para->sensorName in cfdStartCosimulation.c");
     }
-    cosim->ffd->senVal = (double *) malloc(nSen*sizeof(double));
-    if (  cosim->ffd->senVal == NULL){
-      ModelicaError("Failed to allocate memory for cosim->ffd->senVal in cfdStartCosimulation.c");
-    }
     for(i=0; i<nSen; i++) {
       cosim->para->sensorName[i] = NULL;
       cosim->para->sensorName[i] = (char *)malloc(sizeof(char)*(strlen(sensorName[i])+1));
@@ -131,37 +245,12 @@ int cfdStartCosimulation(char *cfdFilNam, char **name, double *A, double *til,
   }
 
   /* Set the flag to initial value*/
-  cosim->modelica->flag = 0;
-  cosim->ffd->flag = 0;
   cosim->para->flag = 1;
   cosim->para->ffdError = 0;
   cosim->modelica->t = 0;
   cosim->modelica->lt = -1;/*initialize lt to -1 to avoid skipping all exchange() at time = 0*/
 
-  cosim->modelica->temHea = (double *) malloc(nSur*sizeof(double));
-  if (cosim->modelica->temHea == NULL){
-    ModelicaError("Failed to allocate memory for cosim->modelica->temHea in cfdStartCosimulation.c");
-  }
-  /* Having a shade for window*/
-  if(haveShade==1) {
-    cosim->modelica->shaConSig = (double *) malloc(nConExtWin*sizeof(double));
-    if (  cosim->modelica->shaConSig == NULL){
-      ModelicaError("Failed to allocate memory for cosim->modelica->shaConSig in cfdStartCosimulation.c");
-    }
-    cosim->modelica->shaAbsRad = (double *) malloc(nConExtWin*sizeof(double));
-    if (  cosim->modelica->shaAbsRad == NULL){
-      ModelicaError("Failed to allocate memory for cosim->modelica->shaAbsRad in cfdStartCosimulation.c");
-    }
-  }
-  cosim->modelica->mFloRatPor = (double *) malloc(nPorts*sizeof(double));
-  if (cosim->modelica->mFloRatPor == NULL){
-    ModelicaError("Failed to allocate memory for cosim->modelica->mFloRatPor in cfdStartCosimulation.c");
-  }
-  cosim->modelica->TPor = (double *) malloc(nPorts*sizeof(double));
-  if (cosim->modelica->TPor == NULL){
-    ModelicaError("Failed to allocate memory for cosim->modelica->TPor in cfdStartCosimulation.c");
-  }
-
+  /* The arrays of Modelica and FFD data point to the messages in the rings*/
   cosim->modelica->XiPor = (double **) malloc(nPorts*sizeof(double *));
   if (cosim->modelica->XiPor == NULL){
     ModelicaError("Failed to allocate memory for cosim->modelica->XiPor in cfdStartCosimulation.c");
@@ -170,19 +259,6 @@ int cfdStartCosimulation(char *cfdFilNam, char **name, double *A, double *til,
   if (cosim->ffd->XiPor == NULL){
     ModelicaError("Failed to allocate memory for cosim->ffd->XiPor in cfdStartCosimulation.c");
   }
-  for(i=0; i<nPorts; i++) {
-    cosim->modelica->XiPor[i] = NULL;
-    cosim->modelica->XiPor[i] = (double *) malloc(cosim->para->nXi*sizeof(double));
-    if (  cosim->modelica->XiPor[i] == NULL){
-      ModelicaError("Failed to allocate memory for cosim->modelica->XiPor[i] in cfdStartCosimulation.c");
-    }
-    cosim->ffd->XiPor[i] = NULL;
-    cosim->ffd->XiPor[i] = (double *) malloc(cosim->para->nXi*sizeof(double));
-    if (  cosim->ffd->XiPor[i] == NULL){
-      ModelicaError("Failed to allocate memory for cosim->ffd->XiPor[i] in cfdStartCosimulation.c");
-    }
-  }
-
   cosim->modelica->CPor = (double **) malloc(nPorts*sizeof(double *));
   if (cosim->modelica->CPor == NULL){
     ModelicaError("Failed to allocate memory for cosim->modelica->CPor in cfdStartCosimulation.c");
@@ -191,38 +267,36 @@ int cfdStartCosimulation(char *cfdFilNam, char **name, double *A, double *til,
   if (cosim->ffd->CPor == NULL){
     ModelicaError("Failed to allocate memory for cosim->ffd->CPor in cfdStartCosimulation.c");
   }
-  for(i=0; i<nPorts; i++) {
-    cosim->modelica->CPor[i] = NULL;
-    cosim->modelica->CPor[i] = (double *) malloc(cosim->para->nC*sizeof(double));
-    if (  cosim->modelica->CPor[i] == NULL){
-      ModelicaError("Failed to allocate memory for cosim->modelica->CPor[i] in cfdStartCosimulation.c");
-    }
-    cosim->ffd->CPor[i] = NULL;
-    cosim->ffd->CPor[i] = (double *) malloc(cosim->para->nC*sizeof(double));
-    if (  cosim->ffd->CPor[i] == NULL){
-      ModelicaError("Failed to allocate memory for cosim->ffd->CPor[i] in cfdStartCosimulation.c");
-    }
-  }
 
-  cosim->ffd->temHea = (double *) malloc(nSur*sizeof(double));
-  if (cosim->ffd->temHea == NULL){
-    ModelicaError("Failed to allocate memory for cosim->ffd->temHea in cfdStartCosimulation.c");
-  }
-  if(haveShade==1){
-     cosim->ffd->TSha = (double *) malloc(nConExtWin*sizeof(double));
-     if (   cosim->ffd->TSha == NULL){
-       ModelicaError("Failed to allocate memory for    cosim->ffd->TSha in cfdStartCosimulation.c");
-     }
-  }
-  cosim->ffd->TPor = (double *) malloc(nPorts*sizeof(double));
-  if (cosim->ffd->TPor == NULL){
-    ModelicaError("Failed to allocate memory for cosim->ffd->TPor in cfdStartCosimulation.c");
+  /* Inputs: temHea[nSur], shaConSig[nConExtWin], shaAbsRad[nConExtWin],*/
+  /* sensibleHeat, latentHeat, p, mFloRatPor[nPorts], TPor[nPorts],*/
+  /* XiPor[nPorts][nXi], CPor[nPorts][nC]*/
+  cosim->input = cfdAllocateRing(nSur + 2*nConExtWin*haveShade + 3
+                                 + nPorts*(2 + nXi + nC), "input");
+  /* Outputs: temHea[nSur], TRoo, TSha[nConExtWin], TPor[nPorts],*/
+  /* XiPor[nPorts][nXi], CPor[nPorts][nC], senVal[nSen]*/
+  cosim->output = cfdAllocateRing(nSur + 1 + nConExtWin*haveShade
+                                  + nPorts*(1 + nXi + nC) + nSen, "output");
+
+  /* Keep the last exchange to answer repeated calls at the same time*/
+  cosim->modelica->last = (double *) calloc(cosim->input->size
+                                            + cosim->output->size,
+                                            sizeof(double));
+  if (cosim->modelica->last == NULL){
+    ModelicaError("Failed to allocate memory for cosim->modelica->last in cfdStartCosimulation.c");
   }
 
   /****************************************************************************
   | Implicitly launch DLL module.
   ****************************************************************************/
-  ffd_dll(cosim);
+  if(cfd->legacy != NULL) {
+    /* The library reads the data in the layout before the message rings*/
+    cfdAllocateLegacy(cfd->legacy, haveSensor);
+    ffd_dll((CosimulationData *) cfd->legacy);
+  }
+  else {
+    ffd_dll(cosim);
+  }
 
   return 0;
 } /* End of cfdStartCosimulation()*/
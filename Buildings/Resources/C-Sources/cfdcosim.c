@@ -21,28 +21,68 @@
  */
 #include "cfdCosimulation.h"
 #include <ModelicaUtilities.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Number of rooms using an FFD library without the message rings*/
+static int cfdLegacyInstances = 0;
+
+/*
+ * Look up the functions of the FFD library added with the message rings
+ *
+ * @param cfd Pointer to the cosimulation data of the room
+ *
+ * @return 0 if the library exports all of them
+ */
+static int cfdLoadFunctions(CfdInstance *cfd) {
+#if defined(_MSC_VER) || defined(__WIN32__) /* Windows */
+  HMODULE lib = GetModuleHandleA("ffd.dll");
+
+  if (lib == NULL){
+    return 1;
+  }
+  *(FARPROC *) &cfd->set_flag = GetProcAddress(lib, "ffd_set_flag");
+  *(FARPROC *) &cfd->wait_flag = GetProcAddress(lib, "ffd_wait_flag");
+  *(FARPROC *) &cfd->free_sync = GetProcAddress(lib, "ffd_free_sync");
+  *(FARPROC *) &cfd->ring_reserve = GetProcAddress(lib, "ffd_ring_reserve");
+  *(FARPROC *) &cfd->ring_commit = GetProcAddress(lib, "ffd_ring_commit");
+  *(FARPROC *) &cfd->ring_peek = GetProcAddress(lib, "ffd_ring_peek");
+  *(FARPROC *) &cfd->ring_release = GetProcAddress(lib, "ffd_ring_release");
+#else /* Linux*/
+  cfd->set_flag = ffd_set_flag;
+  cfd->wait_flag = ffd_wait_flag;
+  cfd->free_sync = ffd_free_sync;
+  cfd->ring_reserve = ffd_ring_reserve;
+  cfd->ring_commit = ffd_ring_commit;
+  cfd->ring_peek = ffd_ring_peek;
+  cfd->ring_release = ffd_ring_release;
+#endif
+
+  return cfd->set_flag == NULL || cfd->wait_flag == NULL
+         || cfd->free_sync == NULL || cfd->ring_reserve == NULL
+         || cfd->ring_commit == NULL || cfd->ring_peek == NULL
+         || cfd->ring_release == NULL;
+} /* End of cfdLoadFunctions()*/
+
 /*
  * Start the cosimulation
  *
- * Allocate memory for cosimulation variables
+ * Allocate memory for cosimulation variables of one room
  *
  */
 void *cfdcosim() {
-
-  /****************************************************************************
-  | return modelica error if more than one ffd instances are created
-  ****************************************************************************/
-  if ( cosim != NULL )
-    ModelicaError("ModelicaError: Only one room with FFD can be used, but more than one is used.");
+  CfdInstance *cfd;
+  CosimulationData *cosim;
 
   /****************************************************************************
   | Allocate memory for cosimulation variables
   ****************************************************************************/
-  cosim = NULL;
-  cosim = (CosimulationData *) malloc(sizeof(CosimulationData));
-  if (cosim == NULL){
+  cfd = NULL;
+  cfd = (CfdInstance *) malloc(sizeof(CfdInstance));
+  if (cfd == NULL){
     ModelicaError("Failed to allocate memory for cosim in cfdcosim.c");
   }
+  cosim = &cfd->cosim;
   cosim->para = NULL;
   cosim->para = (ParameterSharedData *) malloc(sizeof(ParameterSharedData));
   if (cosim->para == NULL){
@@ -64,10 +104,11 @@ void *cfdcosim() {
   /****************************************************************************
   | Initialize cosimulation variables
   ****************************************************************************/
-  cosim->modelica->flag = 0;
-  cosim->ffd->flag = 0;
   cosim->para->flag = 1;
   cosim->para->ffdError = 0;
+  cosim->sync = NULL;
+  cosim->input = NULL;
+  cosim->output = NULL;
   cosim->para->nSur = 0;
   cosim->para->nSen = 0;
   cosim->para->nConExtWin = 0;
@@ -76,6 +117,7 @@ void *cfdcosim() {
   cosim->para->nC = 0;
   cosim->para->nXi = 0;
   cosim->ffd->msg = NULL;
+  cosim->modelica->last = NULL;
   cosim->para->fileName = NULL;
   cosim->para->are = NULL;
   cosim->para->til = NULL;
@@ -97,5 +139,31 @@ void *cfdcosim() {
   cosim->modelica->shaAbsRad = NULL;
   cosim->ffd->TSha = NULL;
 
-  return (void*) cosim;
+  /****************************************************************************
+  | Use the flags of the old data exchange if the library was not rebuilt
+  ****************************************************************************/
+  cfd->legacy = NULL;
+  if (cfdLoadFunctions(cfd) != 0){
+    if (cfdLegacyInstances > 0)
+      ModelicaError("ModelicaError: Only one room with FFD can be used with an FFD library built before the message rings, but more than one is used.");
+    cfdLegacyInstances++;
+
+    cfd->legacy = (LegacyCosimulationData *) malloc(sizeof(LegacyCosimulationData));
+    if (cfd->legacy == NULL){
+      ModelicaError("Failed to allocate memory for cfd->legacy in cfdcosim.c");
+    }
+    cfd->legacy->para = cosim->para;
+    cfd->legacy->modelica = (LegacyModelicaSharedData *) malloc(sizeof(LegacyModelicaSharedData));
+    if (cfd->legacy->modelica == NULL){
+      ModelicaError("Failed to allocate memory for cfd->legacy->modelica in cfdcosim.c");
+    }
+    cfd->legacy->ffd = (LegacyFfdSharedData *) malloc(sizeof(LegacyFfdSharedData));
+    if (cfd->legacy->ffd == NULL){
+      ModelicaError("Failed to allocate memory for cfd->legacy->ffd in cfdcosim.c");
+    }
+    memset(cfd->legacy->modelica, 0, sizeof(LegacyModelicaSharedData));
+    memset(cfd->legacy->ffd, 0, sizeof(LegacyFfdSharedData));
+  }
+
+  return (void*) cfd;
 } /* End of cfdcosim()*/
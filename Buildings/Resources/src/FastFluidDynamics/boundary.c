@@ -249,327 +249,76 @@ int set_bnd_vel(PARA_DATA *para, REAL **var, int var_type, REAL *psi,
 	*/
 int set_bnd_temp(PARA_DATA *para, REAL **var, int var_type, REAL *psi,
                  int **BINDEX) {
-  int i, j, k;
-  int it;
-  int index=para->geom->index;
+  int f, c, n;
   int imax = para->geom->imax, jmax = para->geom->jmax;
-  int kmax = para->geom->kmax;
   int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
-  REAL *aw = var[AW], *ae = var[AE], *as = var[AS], *an = var[AN];
-  REAL *af = var[AF], *ab = var[AB], *b=var[B],
-       *qflux = var[QFLUX], *qfluxbc = var[QFLUXBC];
-  REAL axy, ayz, azx; /* Area of surfaces*/
+  int *start = para->geom->face_start;
+  REAL *b=var[B], *qflux = var[QFLUX], *qfluxbc = var[QFLUXBC];
+  REAL *tempbc = var[TEMPBC];
   REAL h;
   REAL rhoCp_1 = 1/ (para->prob->rho * para->prob->Cp);
-  REAL D;
-  REAL *flagp = var[FLAGP];
+  REAL *hcoef;
+  REAL *coef[6]; /* Coefficient of the neighbor cell toward the boundary cell*/
+  BOUNDARY_FACE *face = para->geom->face;
+
+  coef[0] = var[AE]; coef[1] = var[AW];
+  coef[2] = var[AN]; coef[3] = var[AS];
+  coef[4] = var[AF]; coef[5] = var[AB];
 
   /****************************************************************************
-  | Go through all the boundary cells
+  | Get the heat transfer coefficients computed for current time step
   ****************************************************************************/
-  for(it=0; it<index; it++) {
-    i = BINDEX[0][it];
-    j = BINDEX[1][it];
-    k = BINDEX[2][it];
-
-    axy = area_xy(para, var, i, j, k);
-    ayz = area_yz(para, var, i, j, k);
-    azx = area_zx(para, var, i, j, k);
+  if(check_coef_cache(para, var, BINDEX)!=0) {
+    ffd_log("set_bnd_temp(): Could not update the coefficient cache.",
+            FFD_ERROR);
+    return 1;
+  }
+  hcoef = para->cache->h;
 
-    /*-------------------------------------------------------------------------
-    | Inlet boundary
-    | 0: Inlet, -1: Fluid,  1: Solid Wall or Block, 2: Outlet
-    -------------------------------------------------------------------------*/
-    if(flagp[IX(i,j,k)]==INLET) psi[IX(i,j,k)] = var[TEMPBC][IX(i,j,k)];
+  /****************************************************************************
+  | Inlet boundary
+  ****************************************************************************/
+  for(f=start[INLET]; f<start[INLET+1]; f++) {
+    c = IX(face[f].i,face[f].j,face[f].k);
+    psi[c] = tempbc[c];
+  }
 
-    /*-------------------------------------------------------------------------
-    | Solid wall or block
-    -------------------------------------------------------------------------*/
-    if(flagp[IX(i,j,k)]==SOLID) {
-      /*......................................................................
-      | Constant temperature
-      ......................................................................*/
-      if(BINDEX[3][it]==1) {
-        psi[IX(i,j,k)] = var[TEMPBC][IX(i,j,k)];
-
-        /* West boundary wall and eastern neighbor cell is fluid*/
-        if(i==0) {
-          if(flagp[IX(i+1,j,k)]==FLUID) {
-            D = 0.5 * length_x(para,var,i+1,j,k);
-            h = h_coef(para,var,i+1,j,k,D);
-            aw[IX(i+1,j,k)] = h * rhoCp_1 * ayz;
-            qflux[IX(i,j,k)] = h * (psi[IX(i+1,j,k)]-psi[IX(i,j,k)]);
-          }
-        } /* End of if(i==0)*/
-        /* East boundary wall and western neighbor cell is fluid*/
-        else if(i==imax+1) {
-          if(flagp[IX(i-1,j,k)]==FLUID) {
-            D = 0.5 * length_x(para,var,i-1,j,k);
-            h = h_coef(para,var,i-1,j,k,D);
-            ae[IX(i-1,j,k)] = h * rhoCp_1 * ayz;
-            qflux[IX(i,j,k)] = h * (psi[IX(i-1,j,k)]-psi[IX(i,j,k)]);
-          }
-        } /* End of else if(i==imax+1)*/
-        /* Between West and East*/
-        else {
-          /* Eastern neighbor cell is fluid*/
-          if(flagp[IX(i+1,j,k)]==FLUID) {
-            D = 0.5 * length_x(para,var,i+1,j,k);
-            h = h_coef(para,var,i+1,j,k,D);
-            aw[IX(i+1,j,k)] = h * rhoCp_1 * ayz;
-            qflux[IX(i,j,k)] = h * (psi[IX(i+1,j,k)]-psi[IX(i,j,k)]);
-          }
-          /* Western neighbor cell is fluid*/
-          if(flagp[IX(i-1,j,k)]==FLUID) {
-            D = 0.5 * length_x(para,var,i-1,j,k);
-            h = h_coef(para,var,i-1,j,k,D);
-            ae[IX(i-1,j,k)] = h * rhoCp_1 * ayz;
-            qflux[IX(i,j,k)] = h * (psi[IX(i-1,j,k)]-psi[IX(i,j,k)]);
-          }
-        } /* End of 0<i<imax+1*/
-        /* South wall boundary and northern neighbor is fluid*/
-        if(j==0) {
-          if(flagp[IX(i,j+1,k)]==FLUID) {
-            D = 0.5 * length_y(para,var,i,j+1,k);
-            h = h_coef(para,var,i,j+1,k,D);
-            as[IX(i,j+1,k)] = h * rhoCp_1 * azx;
-            qflux[IX(i,j,k)] = h * (psi[IX(i,j+1,k)]-psi[IX(i,j,k)]);
-          }
-        }
-        /* North wall boundary and southern neighbor is fluid*/
-        else if(j==jmax+1) {
-          if(flagp[IX(i,j-1,k)]==FLUID) {
-            D = 0.5 * length_y(para,var,i,j-1,k);
-            h = h_coef(para,var,i,j-1,k,D);
-            an[IX(i,j-1,k)] = h * rhoCp_1 * azx;
-            qflux[IX(i,j,k)] = h * (psi[IX(i,j-1,k)]-psi[IX(i,j,k)]);
-          }
-        }
-        /* Between South and North*/
-        else {
-          /* Southern neighbor is fluid*/
-          if(flagp[IX(i,j-1,k)]==FLUID) {
-            D = 0.5 * length_y(para,var,i,j-1,k);
-            h = h_coef(para,var,i,j-1,k,D);
-            an[IX(i,j-1,k)] = h * rhoCp_1 * azx;
-            qflux[IX(i,j,k)] = h * (psi[IX(i,j-1,k)]-psi[IX(i,j,k)]);
-          }
-          /* Northern neighbor is fluid*/
-          if(flagp[IX(i,j+1,k)]==FLUID) {
-            D = 0.5 * length_y(para,var,i,j+1,k);
-            h = h_coef(para,var,i,j+1,k,D);
-            as[IX(i,j+1,k)] = h * rhoCp_1 * azx;
-            qflux[IX(i,j,k)] = h * (psi[IX(i,j+1,k)]-psi[IX(i,j,k)]);
-          }
-        }
-        /* Floor and ceiling neighbor is fluid*/
-        if(k==0) {
-          if(flagp[IX(i,j,k+1)]==FLUID) {
-            D = 0.5 * length_z(para,var,i,j,k+1);
-            h = h_coef(para,var,i,j,k+1,D);
-            ab[IX(i,j,k+1)] = h * rhoCp_1 * axy;
-            qflux[IX(i,j,k)] = h * (psi[IX(i,j,k+1)]-psi[IX(i,j,k)]);
-          }
-        }
-        /* Ceiling and floor neighbor is fluid*/
-        else if(k==kmax+1) {
-          if(flagp[IX(i,j,k-1)]==FLUID) {
-            D = 0.5 * length_z(para,var,i,j,k-1);
-            h = h_coef(para,var,i,j,k-1,D);
-            af[IX(i,j,k-1)] = h * rhoCp_1 * axy;
-            qflux[IX(i,j,k)] = h * (psi[IX(i,j,k-1)]-psi[IX(i,j,k)]);
-          }
-        }
-        /* Between Floor and Ceiling*/
-        else {
-          /* Ceiling neighbor is fluid*/
-          if(flagp[IX(i,j,k+1)]==FLUID) {
-            D = 0.5 * length_z(para,var,i,j,k+1);
-            h = h_coef(para,var,i,j,k+1,D);
-            ab[IX(i,j,k+1)] = h * rhoCp_1 * axy;
-            qflux[IX(i,j,k)] = h * (psi[IX(i,j,k+1)]-psi[IX(i,j,k)]);
-          }
-          /* Floor neighbor is fluid*/
-          if(flagp[IX(i,j,k-1)]==FLUID) {
-            D = 0.5 * length_z(para,var,i,j,k-1);
-            h = h_coef(para,var,i,j,k-1,D);
-            af[IX(i,j,k-1)] = h * rhoCp_1 * axy;
-            qflux[IX(i,j,k)] = h * (psi[IX(i,j,k-1)]-psi[IX(i,j,k)]);
-          }
-        }
-      } /* End of constant temperature wall*/
-      /*.......................................................................
-      | Constant heat flux
-      .......................................................................*/
-      if(BINDEX[3][it]==0) {
-        /* West wall boundary and eastern neighbor is fluid*/
-        if(i==0) {
-          if(flagp[IX(i+1,j,k)]==FLUID) {
-            aw[IX(i+1,j,k)] = 0;
-            D = 0.5 * length_z(para,var,i+1,j,k);
-            h = h_coef(para,var,i+1,j,k,D);
-            b[IX(i+1,j,k)] += rhoCp_1 * qfluxbc[IX(i,j,k)] * ayz;
-            /* get the temperature of solid surface*/
-            psi[IX(i,j,k)] = qfluxbc[IX(i,j,k)]/h + psi[IX(i+1,j,k)];
-          }
-        } /* End of if(i==0)*/
-        /* East wall boundary and western neighbor is fluid*/
-        else if(i==imax+1) {
-          if(flagp[IX(i-1,j,k)]==FLUID) {
-            ae[IX(i-1,j,k)] = 0;
-            D = 0.5 * length_z(para,var,i-1,j,k);
-            h = h_coef(para,var,i-1,j,k,D);
-            b[IX(i-1,j,k)] += rhoCp_1 * qfluxbc[IX(i,j,k)] * ayz;
-            /* get the temperature of solid surface*/
-            psi[IX(i,j,k)] = qfluxbc[IX(i,j,k)]/h + psi[IX(i-1,j,k)];
-          }
-        } /* End of else if(i==imax+1)*/
-        /* Between West and East*/
-        else {
-          /* Eastern neighbor is fluid*/
-          if(flagp[IX(i+1,j,k)]==FLUID) {
-            aw[IX(i+1,j,k)] = 0;
-            D = 0.5 * length_z(para,var,i+1,j,k);
-            h = h_coef(para,var,i+1,j,k,D);
-            b[IX(i+1,j,k)] += rhoCp_1 * qfluxbc[IX(i,j,k)] * ayz;
-            /* get the temperature of solid surface*/
-            psi[IX(i,j,k)] = qfluxbc[IX(i,j,k)]/h + psi[IX(i+1,j,k)];
-          }
-          /* Western neighbor is fluid*/
-          if(flagp[IX(i-1,j,k)]==FLUID) {
-            ae[IX(i-1,j,k)] = 0;
-            D = 0.5 * length_z(para,var,i-1,j,k);
-            h = h_coef(para,var,i-1,j,k,D);
-            b[IX(i-1,j,k)] += rhoCp_1 * qfluxbc[IX(i,j,k)] * ayz;
-            /* get the temperature of solid surface*/
-            psi[IX(i,j,k)] = qfluxbc[IX(i,j,k)]/h + psi[IX(i-1,j,k)];
-          }
-        } /* End of else*/
-        /* South wall boundary and northern neighbor is fluid*/
-        if(j==0) {
-          if(flagp[IX(i,j+1,k)]==FLUID) {
-            as[IX(i,j+1,k)] = 0;
-            D = 0.5 * length_z(para,var,i,j+1,k);
-            h = h_coef(para,var,i,j+1,k,D);
-            b[IX(i,j+1,k)] += rhoCp_1 * qfluxbc[IX(i,j,k)] * azx;
-            /* get the temperature of solid surface*/
-            psi[IX(i,j,k)] = qfluxbc[IX(i,j,k)]/h + psi[IX(i,j+1,k)];
-          }
-        }
-        /* North wall boundary and southern neighbor is fluid*/
-        else if(j==jmax+1) {
-          if(flagp[IX(i,j-1,k)]==FLUID) {
-            an[IX(i,j-1,k)] = 0;
-            D = 0.5 * length_z(para,var,i,j-1,k);
-            h = h_coef(para,var,i,j-1,k,D);
-            b[IX(i,j-1,k)] += rhoCp_1 * qfluxbc[IX(i,j,k)] * azx;
-            /* get the temperature of solid surface*/
-            psi[IX(i,j,k)] = qfluxbc[IX(i,j,k)]/h + psi[IX(i,j-1,k)];
-          }
-        }
-        /* Between South and North*/
-        else {
-          /* Southern neighbor is fluid*/
-          if(flagp[IX(i,j-1,k)]==FLUID) {
-            an[IX(i,j-1,k)] = 0;
-            D = 0.5 * length_z(para,var,i,j-1,k);
-            h = h_coef(para,var,i,j-1,k,D);
-            b[IX(i,j-1,k)] += rhoCp_1 * qfluxbc[IX(i,j,k)] * azx;
-            /* get the temperature of solid surface*/
-            psi[IX(i,j,k)] = qfluxbc[IX(i,j,k)]/h + psi[IX(i,j-1,k)];
-          }
-          /* Northern neighbor is fluid*/
-          if(flagp[IX(i,j+1,k)]==FLUID) {
-            as[IX(i,j+1,k)] = 0;
-            D = 0.5 * length_z(para,var,i,j+1,k);
-            h = h_coef(para,var,i,j+1,k,D);
-            b[IX(i,j+1,k)] += rhoCp_1 * qfluxbc[IX(i,j,k)] * azx;
-            /* get the temperature of solid surface*/
-            psi[IX(i,j,k)] = qfluxbc[IX(i,j,k)]/h + psi[IX(i,j+1,k)];
-          }
-        }
-        /* Floor boundary and ceiling neighbor is fluid*/
-        if(k==0) {
-          if(flagp[IX(i,j,k+1)]==FLUID) {
-            ab[IX(i,j,k+1)] = 0;
-            D = 0.5 * length_z(para,var,i,j,k+1);
-            h = h_coef(para,var,i,j,k+1,D);
-            b[IX(i,j,k+1)] += rhoCp_1 * qfluxbc[IX(i,j,k)] * axy;
-            /* Get the temperature on the solid surface*/
-            psi[IX(i,j,k)] = qfluxbc[IX(i,j,k)]/h + psi[IX(i,j,k+1)];
-          }
-        }
-        /* Ceiling boundary and floor neighbor is fluid*/
-        else if(k==kmax+1) {
-          if(flagp[IX(i,j,k-1)]==FLUID) {
-            af[IX(i,j,k-1)] = 0;
-            D = 0.5 * length_z(para,var,i,j,k-1);
-            h = h_coef(para,var,i,j,k-1,D);
-            b[IX(i,j,k-1)] += rhoCp_1 * qfluxbc[IX(i,j,k)] * axy;
-            /* Get the temperature on the solid surface*/
-            psi[IX(i,j,k)] = qfluxbc[IX(i,j,k)]/h + psi[IX(i,j,k-1)];
-          }
-        }
-        /* Between Floor and Ceiling*/
-        else {
-          /* Ceiling neighbor is fluid*/
-          if(flagp[IX(i,j,k+1)]==FLUID) {
-            ab[IX(i,j,k+1)] = 0;
-            D = 0.5 * length_z(para,var,i,j,k+1);
-            h = h_coef(para,var,i,j,k+1,D);
-            b[IX(i,j,k+1)] += rhoCp_1 * qfluxbc[IX(i,j,k)] * axy;
-            /* Get the temperature on the solid surface*/
-            psi[IX(i,j,k)] = qfluxbc[IX(i,j,k)]/h + psi[IX(i,j,k+1)];
-          }
-          /* Floor neighbor is fluid*/
-          if(flagp[IX(i,j,k-1)]==FLUID) {
-            af[IX(i,j,k-1)] = 0;
-            D = 0.5 * length_z(para,var,i,j,k-1);
-            h = h_coef(para,var,i,j,k-1,D);
-            b[IX(i,j,k-1)] += rhoCp_1 * qfluxbc[IX(i,j,k)] * axy;
-            /* Get the temperature on the solid surface*/
-            psi[IX(i,j,k)] = qfluxbc[IX(i,j,k)]/h + psi[IX(i,j,k-1)];
-          }
-        }
-      } /* End of constant heat flux*/
-    } /* End of wall boundary*/
+  /****************************************************************************
+  | Solid wall or block
+  ****************************************************************************/
+  for(f=start[SOLID]; f<start[SOLID+1]; f++) {
+    c = IX(face[f].i,face[f].j,face[f].k);
+    n = c + face[f].nb;
+    h = hcoef[f];
+
+    /*.........................................................................
+    | Constant temperature
+    .........................................................................*/
+    if(BINDEX[3][face[f].it]==1) {
+      psi[c] = tempbc[c];
+      coef[face[f].dir][n] = h * rhoCp_1 * face[f].area;
+      qflux[c] = h * (psi[n]-psi[c]);
+    }
+    /*.........................................................................
+    | Constant heat flux
+    .........................................................................*/
+    else if(BINDEX[3][face[f].it]==0) {
+      coef[face[f].dir][n] = 0;
+      b[n] += rhoCp_1 * qfluxbc[c] * face[f].area;
+      /* Get the temperature on the solid surface*/
+      psi[c] = qfluxbc[c]/h + psi[n];
+    }
+  } /* End of wall boundary*/
 
-    /*-------------------------------------------------------------------------
-    | Outlet boundary
-    -------------------------------------------------------------------------*/
-    if(flagp[IX(i,j,k)]==OUTLET) {
-      /* West*/
-      if(i==0) {
-        aw[IX(i+1,j,k)] = 0;
-        psi[IX(i,j,k)] = psi[IX(i+1,j,k)];
-      }
-      /* North*/
-      if(i==imax+1) {
-        ae[IX(i-1,j,k)] = 0;
-        psi[IX(i,j,k)] = psi[IX(i-1,j,k)];
-      }
-      /* South*/
-      if(j==0) {
-        as[IX(i,j+1,k)] = 0;
-        psi[IX(i,j,k)] = psi[IX(i,j+1,k)];
-      }
-      /* North*/
-      if(j==jmax+1) {
-        an[IX(i,j-1,k)] = 0;
-        psi[IX(i,j,k)] = psi[IX(i,j-1,k)];
-      }
-      /* Floor*/
-      if(k==0) {
-        ab[IX(i,j,k+1)] = 0;
-        psi[IX(i,j,k)] = psi[IX(i,j,k+1)];
-      }
-      /* Ceiling*/
-      if(k==kmax+1) {
-        af[IX(i,j,k-1)] = 0;
-        psi[IX(i,j,k)] = psi[IX(i,j,k-1)];
-      }
-    } /* End of boundary for outlet*/
-  } /* End of for() loop for go through the index*/
+  /****************************************************************************
+  | Outlet boundary
+  ****************************************************************************/
+  for(f=start[OUTLET]; f<start[OUTLET+1]; f++) {
+    c = IX(face[f].i,face[f].j,face[f].k);
+    n = c + face[f].nb;
+    coef[face[f].dir][n] = 0;
+    psi[c] = psi[n];
+  }
 
   return 0;
 } /* End of set_bnd_temp()*/
@@ -773,6 +522,11 @@ int set_bnd_pressure(PARA_DATA *para, REAL **var, REAL *p, int **BINDEX) {
 	* Improvements on FFD modeling by using different numerical schemes,
 	* Numerical Heat Transfer, Part B Fundamentals, 58(1), 1-16."
 	*
+	* Only the precomputed outlet faces are updated. With UNIFORM correction,
+	* all the outlets get the same velocity correction. With FLOW_WEIGHTED
+	* correction, the mass difference is shared by the outlets in proportion to
+	* their current outflow.
+	*
 	* @param para Pointer to FFD parameters
 	* @param var Pointer to FFD simulation variables
 	* @param BINDEX Pointer to boundary index
@@ -780,35 +534,55 @@ int set_bnd_pressure(PARA_DATA *para, REAL **var, REAL *p, int **BINDEX) {
 	* @return 0 if no error occurred
 	*/
 int mass_conservation(PARA_DATA *para, REAL **var, int **BINDEX) {
-  int i, j, k;
-  int it;
-  int imax = para->geom->imax, jmax = para->geom->jmax;
-  int kmax = para->geom->kmax;
-  int index= para->geom->index;
-  int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
-  REAL *u = var[VX], *v = var[VY], *w = var[VZ];
-  REAL dvel;
-  REAL *flagp = var[FLAGP];
+  int f, f0, f1;
+  int *start = para->geom->face_start;
+  REAL dvel, dvel_id;
+  REAL mass_out = 0, area_out = 0, mass_id, area_id;
+  BOUNDARY_FACE *face = para->geom->face;
 
   dvel = adjust_velocity(para, var, BINDEX); /*(mass_in-mass_out)/area_out*/
 
   /*---------------------------------------------------------------------------
-  | Adjust the outflow
+  | Get the outflow of each outlet for the flow weighted correction
   ---------------------------------------------------------------------------*/
-  for(it=0;it<index;it++) {
-    i = BINDEX[0][it];
-    j = BINDEX[1][it];
-    k = BINDEX[2][it];
-    if(flagp[IX(i,j,k)]==2) {
-      if(i==0) u[IX(i,j,k)] -= dvel;
-      if(i==imax+1) u[IX(i-1,j,k)]+= dvel;
-      if(j==0) v[IX(i,j,k)] -= dvel;
-      if(j==jmax+1) v[IX(i,j-1,k)] += dvel;
-      if(k==0) w[IX(i,j,k)] -= dvel;
-      if(k==kmax+1) w[IX(i,j,k-1)] += dvel;
+  if(para->solv->mass_correction==FLOW_WEIGHTED) {
+    for(f0=start[OUTLET]; f0<start[OUTLET+1]; f0=f1) {
+      mass_id = 0;
+      for(f1=f0; f1<start[OUTLET+1] && face[f1].id==face[f0].id; f1++) {
+        mass_id += face_outflow(para, var, &face[f1]);
+        area_out += face[f1].area;
+      }
+      /* Outlet with back flow does not take the correction*/
+      if(mass_id>0) mass_out += mass_id;
     }
   }
 
+  /*---------------------------------------------------------------------------
+  | Adjust the same velocity on all the outlets
+  ---------------------------------------------------------------------------*/
+  if(para->solv->mass_correction==UNIFORM || mass_out<SMALL*area_out) {
+    for(f=start[OUTLET]; f<start[OUTLET+1]; f++)
+      face_correct_outflow(para, var, &face[f], dvel);
+    return 0;
+  }
+
+  /*---------------------------------------------------------------------------
+  | Distribute the mass correction to outlets according to their outflow
+  ---------------------------------------------------------------------------*/
+  for(f0=start[OUTLET]; f0<start[OUTLET+1]; f0=f1) {
+    mass_id = 0;
+    area_id = 0;
+    for(f1=f0; f1<start[OUTLET+1] && face[f1].id==face[f0].id; f1++) {
+      mass_id += face_outflow(para, var, &face[f1]);
+      area_id += face[f1].area;
+    }
+    if(mass_id<=0) continue;
+
+    dvel_id = dvel * area_out * (mass_id/mass_out) / area_id;
+    for(f=f0; f<f1; f++)
+      face_correct_outflow(para, var, &face[f], dvel_id);
+  }
+
   return 0;
 } /* End of mass_conservation()*/
 
@@ -827,80 +601,25 @@ int mass_conservation(PARA_DATA *para, REAL **var, int **BINDEX) {
 	* @return Mass flow difference divided by the outflow area
 	*/
 REAL adjust_velocity(PARA_DATA *para, REAL **var, int **BINDEX) {
-  int i, j, k;
-  int it;
-  int imax = para->geom->imax, jmax = para->geom->jmax;
-  int kmax = para->geom->kmax;
-  int index= para->geom->index;
-  int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
-  REAL *u = var[VX], *v = var[VY], *w = var[VZ];
+  int f;
+  int *start = para->geom->face_start;
   REAL mass_in = (REAL) 0.0, mass_out = (REAL) 0.00000001;
   REAL area_out=0;
-  REAL *flagp = var[FLAGP];
-  REAL axy, ayz, azx;
+  BOUNDARY_FACE *face = para->geom->face;
 
-  /* Go through all the inlets and outlets*/
-  for(it=0; it<index; it++) {
-    i = BINDEX[0][it];
-    j = BINDEX[1][it];
-    k = BINDEX[2][it];
+  /*---------------------------------------------------------------------------
+  | Compute the total inflow
+  ---------------------------------------------------------------------------*/
+  for(f=start[INLET]; f<start[INLET+1]; f++)
+    mass_in -= face_outflow(para, var, &face[f]);
 
-    axy = area_xy(para, var, i, j, k);
-    ayz = area_yz(para, var, i, j, k);
-    azx = area_zx(para, var, i, j, k);
-    /*-------------------------------------------------------------------------
-    | Compute the total inflow
-    -------------------------------------------------------------------------*/
-    if(flagp[IX(i,j,k)]==0) {
-      /* West*/
-      if(i==0) mass_in += u[IX(i,j,k)] * ayz;
-      /* East*/
-      if(i==imax+1) mass_in += (-u[IX(i,j,k)]) * ayz;
-      /* South*/
-      if(j==0) mass_in += v[IX(i,j,k)] * azx;
-      /* North*/
-      if(j==jmax+1) mass_in += (-v[IX(i,j,k)]) * azx;
-      /* Floor*/
-      if(k==0) mass_in += w[IX(i,j,k)] * axy;
-      /* Ceiling*/
-      if(k==kmax+1) mass_in += (-w[IX(i,j,k)]) * axy;
-    }
-    /*-------------------------------------------------------------------------
-    | Compute the total outflow
-    -------------------------------------------------------------------------*/
-    if(flagp[IX(i,j,k)]==2) {
-      /* West*/
-      if(i==0) {
-        mass_out += (-u[IX(i,j,k)]) * ayz;
-        area_out +=  ayz;
-      }
-      /* East*/
-      if(i==imax+1) {
-        mass_out += u[IX(i-1,j,k)] * ayz;
-        area_out += ayz;
-      }
-      /* South*/
-      if(j==0) {
-        mass_out += (-v[IX(i,j,k)]) * azx;
-        area_out += azx;
-      }
-      /* North*/
-      if(j==jmax+1) {
-        mass_out += v[IX(i,j-1,k)] * azx;
-        area_out += azx;
-      }
-      /* Floor*/
-      if(k==0) {
-        mass_out += (-w[IX(i,j,k)]) * axy;
-        area_out += axy;
-      }
-      /* Ceiling*/
-      if(k==kmax+1) {
-        mass_out += w[IX(i,j,k-1)] * axy;
-        area_out += axy;
-      }
-    } /* End of computing outflow*/
-  } /* End of for loop for going through all the inlets and outlets*/
+  /*---------------------------------------------------------------------------
+  | Compute the total outflow
+  ---------------------------------------------------------------------------*/
+  for(f=start[OUTLET]; f<start[OUTLET+1]; f++) {
+    mass_out += face_outflow(para, var, &face[f]);
+    area_out += face[f].area;
+  }
 
   /*---------------------------------------------------------------------------
   | Return the adjusted velocity for mass conservation
@@ -908,6 +627,50 @@ REAL adjust_velocity(PARA_DATA *para, REAL **var, int **BINDEX) {
   return (mass_in-mass_out)/area_out;
 } /* End of adjust_velocity()*/
 
+/*
+	* Get the flow rate leaving the room through a boundary face
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	* @param face Pointer to the boundary face
+	*
+	* @return Volume flow rate, positive if the flow leaves the room
+	*/
+REAL face_outflow(PARA_DATA *para, REAL **var, BOUNDARY_FACE *face) {
+  int imax = para->geom->imax, jmax = para->geom->jmax;
+  int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
+  /* VX, VY and VZ are stored in sequence*/
+  REAL vel = var[VX+face->dir/2][IX(face->i,face->j,face->k)+face->vel];
+
+  /* The room is at the positive side of the face if dir is odd*/
+  if(face->dir%2==1)
+    return -vel * face->area;
+  else
+    return vel * face->area;
+} /* End of face_outflow()*/
+
+/*
+	* Increase the velocity leaving the room through a boundary face
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	* @param face Pointer to the boundary face
+	* @param dvel Increase of the velocity leaving the room
+	*
+	* @return No return needed
+	*/
+void face_correct_outflow(PARA_DATA *para, REAL **var, BOUNDARY_FACE *face,
+                          REAL dvel) {
+  int imax = para->geom->imax, jmax = para->geom->jmax;
+  int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
+  REAL *vel = &var[VX+face->dir/2][IX(face->i,face->j,face->k)+face->vel];
+
+  if(face->dir%2==1)
+    *vel -= dvel;
+  else
+    *vel += dvel;
+} /* End of face_correct_outflow()*/
+
 /*
 	* Calculate convective heat transfer coefficient
 	*
@@ -923,6 +686,8 @@ REAL adjust_velocity(PARA_DATA *para, REAL **var, int **BINDEX) {
 REAL h_coef(PARA_DATA *para, REAL **var, int i, int j, int k, REAL D) {
   REAL h, kapa;
   REAL nu = para->prob->nu;
+  int imax = para->geom->imax, jmax = para->geom->jmax;
+  int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
 
   switch(para->prob->tur_model) {
     case LAM:
@@ -932,7 +697,7 @@ REAL h_coef(PARA_DATA *para, REAL **var, int i, int j, int k, REAL D) {
       kapa = (REAL)101.0 * nu;
       break;
     case CHEN:
-      kapa = nu + nu_t_chen_zero_equ(para, var, i, j, k);
+      kapa = nu + var[NUT][IX(i,j,k)];
       break;
     default:
       sprintf(msg, "h_coef(): Value (%d) for para->prob->tur_model"
@@ -945,3 +710,108 @@ REAL h_coef(PARA_DATA *para, REAL **var, int i, int j, int k, REAL D) {
   return h;
 
 } /* End of h_coef()*/
+
+/*
+	* Update the coefficients that are computed once per time step
+	*
+	* The cache holds the turbulent viscosity var[NUT] and the convective heat
+	* transfer coefficients on the faces of the solid boundaries. It is
+	* updated after the velocity step and then used by all the coefficient
+	* assemblies of the same time step.
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	* @param BINDEX Pointer to boundary index
+	*
+	* @return 0 if no error occurred
+	*/
+int update_coef_cache(PARA_DATA *para, REAL **var, int **BINDEX) {
+  int i, j, k, f;
+  int nb_face = para->geom->nb_face;
+  int *start = para->geom->face_start;
+  int di[6] = {-1, 1, 0, 0, 0, 0};
+  int dj[6] = {0, 0, -1, 1, 0, 0};
+  int dk[6] = {0, 0, 0, 0, -1, 1};
+  REAL *h, D;
+  BOUNDARY_FACE *face = para->geom->face;
+
+  /****************************************************************************
+  | Update the turbulent viscosity
+  ****************************************************************************/
+  if(para->prob->tur_model==CHEN) {
+    if(nu_t_chen_zero_equ_field(para, var)!=0) {
+      ffd_log("update_coef_cache(): Could not compute the turbulent viscosity.",
+              FFD_ERROR);
+      return 1;
+    }
+  }
+  /* The coefficients do not change in time without the turbulence model*/
+  else if(para->cache->h!=NULL) {
+    para->cache->step = para->mytime->step_current;
+    return 0;
+  }
+
+  /****************************************************************************
+  | Allocate memory for the heat transfer coefficients at the first call
+  ****************************************************************************/
+  if(para->cache->h==NULL || para->cache->nb_face!=nb_face) {
+    if(para->cache->h!=NULL) free(para->cache->h);
+    para->cache->h = (REAL *) malloc((nb_face+1)*sizeof(REAL));
+    if(para->cache->h==NULL) {
+      ffd_log("update_coef_cache(): Could not allocate memory for "
+              "para->cache->h.", FFD_ERROR);
+      return 1;
+    }
+    para->cache->nb_face = nb_face;
+  }
+  h = para->cache->h;
+
+  /****************************************************************************
+  | Compute the heat transfer coefficients on the faces of solid boundaries
+  ****************************************************************************/
+  for(f=0; f<nb_face; f++) h[f] = 0;
+
+  for(f=start[SOLID]; f<start[SOLID+1]; f++) {
+    i = face[f].i + di[face[f].dir];
+    j = face[f].j + dj[face[f].dir];
+    k = face[f].k + dk[face[f].dir];
+
+    if(face[f].dir<2)
+      D = (REAL) 0.5 * length_x(para, var, i, j, k);
+    else if(face[f].dir<4)
+      D = (REAL) 0.5 * length_y(para, var, i, j, k);
+    else
+      D = (REAL) 0.5 * length_z(para, var, i, j, k);
+
+    h[f] = h_coef(para, var, i, j, k, D);
+  }
+
+  para->cache->step = para->mytime->step_current;
+
+  return 0;
+} /* End of update_coef_cache()*/
+
+/*
+	* Check if the coefficient cache was built on current time step
+	*
+	* A stale cache is reported and then updated.
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	* @param BINDEX Pointer to boundary index
+	*
+	* @return 0 if no error occurred
+	*/
+int check_coef_cache(PARA_DATA *para, REAL **var, int **BINDEX) {
+  if(para->cache->step==para->mytime->step_current)
+    return 0;
+
+  if(para->cache->step>=0) {
+    sprintf(msg, "check_coef_cache(): Warning: Coefficient cache was built on "
+            "step %d but current step is %d. Update the cache.",
+            para->cache->step, para->mytime->step_current);
+    ffd_log(msg, FFD_NORMAL);
+  }
+
+  return update_coef_cache(para, var, BINDEX);
+} /* End of check_coef_cache()*/
@@ -148,6 +148,30 @@ int mass_conservation(PARA_DATA *para, REAL **var, int **BINDEX);
 	*/
 REAL adjust_velocity(PARA_DATA *para, REAL **var, int **BINDEX);
 
+/*
+	* Get the flow rate leaving the room through a boundary face
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	* @param face Pointer to the boundary face
+	*
+	* @return Volume flow rate, positive if the flow leaves the room
+	*/
+REAL face_outflow(PARA_DATA *para, REAL **var, BOUNDARY_FACE *face);
+
+/*
+	* Increase the velocity leaving the room through a boundary face
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	* @param face Pointer to the boundary face
+	* @param dvel Increase of the velocity leaving the room
+	*
+	* @return No return needed
+	*/
+void face_correct_outflow(PARA_DATA *para, REAL **var, BOUNDARY_FACE *face,
+                          REAL dvel);
+
 /*
 	* Calculate convective heat transfer coefficient
 	*
@@ -161,3 +185,25 @@ REAL adjust_velocity(PARA_DATA *para, REAL **var, int **BINDEX);
 	* @return Mass flow difference divided by the outflow area
 	*/
 REAL h_coef(PARA_DATA *para, REAL **var, int i, int j, int k, REAL D);
+
+/*
+	* Update the coefficients that are computed once per time step
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	* @param BINDEX Pointer to boundary index
+	*
+	* @return 0 if no error occurred
+	*/
+int update_coef_cache(PARA_DATA *para, REAL **var, int **BINDEX);
+
+/*
+	* Check if the coefficient cache was built on current time step
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	* @param BINDEX Pointer to boundary index
+	*
+	* @return 0 if no error occurred
+	*/
+int check_coef_cache(PARA_DATA *para, REAL **var, int **BINDEX);
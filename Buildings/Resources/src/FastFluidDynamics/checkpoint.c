@@ -0,0 +1,359 @@
+/*
+	*
+	* \file   checkpoint.c
+	*
+	* \brief  Write and read binary checkpoints to restart FFD
+	*
+	* \author Xu Han
+	*         University of Colorado Boulder
+	*         xuha3556@colorado.edu
+	*
+	* \date   10/18/2026
+	*
+	* The variables are stored as they are in memory, so that restarting only
+	* maps the file and copies each variable at once.
+	*
+	*/
+
+#include "checkpoint.h"
+
+/* Variables carried from one time step to the next*/
+static const int checkpoint_var[] = {VX, VY, VZ, VXM, VYM, VZM, VXS, VYS, VZS,
+  IP, QFLUXBC, QFLUX, TEMP, TEMPS, TEMPM, FLAGP, VXBC, VYBC, VZBC, TEMPBC,
+  Xi1, Xi2, Xi1S, Xi2S, Xi1BC, Xi2BC, C1, C2, C1S, C2S, C1BC, C2BC, NUT};
+#define NB_CHECKPOINT_VAR ((int) (sizeof(checkpoint_var)/sizeof(int)))
+
+/*
+	* Check if a variable holds the boundary conditions
+	*
+	* @param id Index of the variable
+	*
+	* @return 1 if the variable holds the boundary conditions, 0 otherwise
+	*/
+static int is_boundary_var(int id) {
+  return id==QFLUXBC || id==FLAGP || id==VXBC || id==VYBC || id==VZBC
+      || id==TEMPBC || id==Xi1BC || id==Xi2BC || id==C1BC || id==C2BC;
+} /* End of is_boundary_var()*/
+
+/*
+	* Add bytes to a hash (FNV-1a)
+	*
+	* @param h Hash of the previous bytes
+	* @param data Pointer to the bytes
+	* @param n Number of bytes
+	*
+	* @return Hash including the bytes
+	*/
+static unsigned long hash_bytes(unsigned long h, const void *data, size_t n) {
+  const unsigned char *c = (const unsigned char *) data;
+  size_t i;
+
+  for(i=0; i<n; i++)
+    h = ((h ^ c[i]) * 16777619UL) & 0xFFFFFFFFUL;
+
+  return h;
+} /* End of hash_bytes()*/
+
+/*
+	* Hash the grid and the solid cells
+	*
+	* The flags of the other cells are not part of the hash, since the
+	* inlets and outlets may change during a cosimulation.
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	*
+	* @return Hash of the geometry
+	*/
+static unsigned int geometry_hash(PARA_DATA *para, REAL **var) {
+  int i, j, k;
+  int imax = para->geom->imax, jmax = para->geom->jmax;
+  int kmax = para->geom->kmax;
+  int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
+  unsigned long h = 2166136261UL;
+  unsigned char solid;
+
+  h = hash_bytes(h, &imax, sizeof(int));
+  h = hash_bytes(h, &jmax, sizeof(int));
+  h = hash_bytes(h, &kmax, sizeof(int));
+  for(i=0; i<=imax+1; i++)
+    h = hash_bytes(h, &var[X][IX(i,0,0)], sizeof(REAL));
+  for(j=0; j<=jmax+1; j++)
+    h = hash_bytes(h, &var[Y][IX(0,j,0)], sizeof(REAL));
+  for(k=0; k<=kmax+1; k++)
+    h = hash_bytes(h, &var[Z][IX(0,0,k)], sizeof(REAL));
+
+  FOR_ALL_CELL
+    solid = (unsigned char) (var[FLAGP][IX(i,j,k)]==SOLID);
+    h = hash_bytes(h, &solid, 1);
+  END_FOR
+
+  return (unsigned int) h;
+} /* End of geometry_hash()*/
+
+/*
+	* Check the header of a checkpoint against the simulation
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	* @param head Pointer to the header
+	* @param size Number of bytes of the checkpoint
+	*
+	* @return 0 if the checkpoint fits the simulation
+	*/
+static int check_checkpoint(PARA_DATA *para, REAL **var,
+                            const CHECKPOINT_HEADER *head, size_t size) {
+  size_t nb_cell = (size_t) (para->geom->imax+2)*(para->geom->jmax+2)
+                 * (para->geom->kmax+2);
+
+  if(head->version!=CHECKPOINT_VERSION) {
+    sprintf(msg, "check_checkpoint(): The checkpoint has version %d instead "
+            "of %d.", head->version, CHECKPOINT_VERSION);
+    ffd_log(msg, FFD_ERROR);
+    return 1;
+  }
+  if(head->byte_order!=CHECKPOINT_BYTE_ORDER
+     || head->real_size!=(int) sizeof(REAL)) {
+    ffd_log("check_checkpoint(): The checkpoint was written on a host with "
+            "another byte order or size of REAL.", FFD_ERROR);
+    return 1;
+  }
+  if(head->imax!=para->geom->imax || head->jmax!=para->geom->jmax
+     || head->kmax!=para->geom->kmax) {
+    sprintf(msg, "check_checkpoint(): The checkpoint has %dx%dx%d cells "
+            "instead of %dx%dx%d.", head->imax, head->jmax, head->kmax,
+            para->geom->imax, para->geom->jmax, para->geom->kmax);
+    ffd_log(msg, FFD_ERROR);
+    return 1;
+  }
+  if(head->geometry!=geometry_hash(para, var)) {
+    ffd_log("check_checkpoint(): The checkpoint was written for another grid "
+            "or another geometry of the solid cells.", FFD_ERROR);
+    return 1;
+  }
+  if(head->nb_sensor!=para->sens->nb_sensor) {
+    sprintf(msg, "check_checkpoint(): The checkpoint has %d sensors instead "
+            "of %d.", head->nb_sensor, para->sens->nb_sensor);
+    ffd_log(msg, FFD_ERROR);
+    return 1;
+  }
+  if(head->nb_var<0 || head->nb_var>NUT+1
+     || size!=sizeof(CHECKPOINT_HEADER)
+              + (size_t) (head->nb_var+head->nb_var%2)*sizeof(int)
+              + (size_t) head->nb_sensor*sizeof(REAL)
+              + (size_t) head->nb_var*nb_cell*sizeof(REAL)) {
+    ffd_log("check_checkpoint(): The checkpoint is incomplete.", FFD_ERROR);
+    return 1;
+  }
+
+  return 0;
+} /* End of check_checkpoint()*/
+
+	/*
+		* Write a checkpoint
+		*
+		* The checkpoint is written to a temporary file first, so that a
+		* failure does not destroy the previous checkpoint.
+		*
+		* @param para Pointer to FFD parameters
+		* @param var Pointer to FFD simulation variables
+		* @param name Pointer to the filename without extension
+		*
+		* @return 0 if no error occurred
+		*/
+int write_checkpoint(PARA_DATA *para, REAL **var, char *name) {
+  CHECKPOINT_HEADER head;
+  size_t size = (size_t) (para->geom->imax+2)*(para->geom->jmax+2)
+              * (para->geom->kmax+2);
+  int n, flag = 0, zero = 0;
+  char *filename, *tmp;
+  FILE *file;
+
+  filename = (char *) malloc((strlen(name)+10)*sizeof(char));
+  tmp = (char *) malloc((strlen(name)+10)*sizeof(char));
+  if(filename==NULL || tmp==NULL) {
+    ffd_log("write_checkpoint(): Failed to allocate memory", FFD_ERROR);
+    if(filename!=NULL) free(filename);
+    if(tmp!=NULL) free(tmp);
+    return 1;
+  }
+  sprintf(filename, "%s.ckp", name);
+  sprintf(tmp, "%s.tmp", name);
+
+  memset(&head, 0, sizeof(CHECKPOINT_HEADER));
+  memcpy(head.magic, CHECKPOINT_MAGIC, 8);
+  head.version = CHECKPOINT_VERSION;
+  head.byte_order = CHECKPOINT_BYTE_ORDER;
+  head.real_size = (int) sizeof(REAL);
+  head.imax = para->geom->imax;
+  head.jmax = para->geom->jmax;
+  head.kmax = para->geom->kmax;
+  head.nb_var = NB_CHECKPOINT_VAR;
+  head.nb_sensor = para->sens->nb_sensor;
+  head.geometry = geometry_hash(para, var);
+  head.step_current = para->mytime->step_current;
+  head.step_mean = para->mytime->step_mean;
+  head.cal_mean = para->outp->cal_mean;
+  head.t = para->mytime->t;
+  head.dt = para->mytime->dt;
+  head.w_mean = para->mytime->w_mean;
+  head.TRooMean = para->sens->TRooMean;
+
+  if((file=fopen(tmp, "wb"))==NULL) {
+    sprintf(msg, "write_checkpoint(): Could not open file %s.", tmp);
+    ffd_log(msg, FFD_ERROR);
+    free(filename);
+    free(tmp);
+    return 1;
+  }
+
+  if(fwrite(&head, sizeof(CHECKPOINT_HEADER), 1, file)!=1
+     || fwrite(checkpoint_var, sizeof(int), NB_CHECKPOINT_VAR, file)
+        !=(size_t) NB_CHECKPOINT_VAR
+     || (NB_CHECKPOINT_VAR%2==1 && fwrite(&zero, sizeof(int), 1, file)!=1)
+     || (head.nb_sensor>0
+         && fwrite(para->sens->senValMean, sizeof(REAL), head.nb_sensor, file)
+            !=(size_t) head.nb_sensor))
+    flag = 1;
+  for(n=0; n<NB_CHECKPOINT_VAR && flag==0; n++)
+    if(fwrite(var[checkpoint_var[n]], sizeof(REAL), size, file)!=size)
+      flag = 1;
+
+  /* The previous checkpoint is only replaced by a complete one*/
+  if(fclose(file)!=0) flag = 1;
+  if(flag==0) {
+    remove(filename);
+    flag = rename(tmp, filename)!=0;
+  }
+
+  if(flag!=0) {
+    sprintf(msg, "write_checkpoint(): Could not write file %s.", filename);
+    ffd_log(msg, FFD_ERROR);
+  }
+  else {
+    sprintf(msg, "write_checkpoint(): Wrote file %s at t=%f[s].", filename,
+            para->mytime->t);
+    ffd_log(msg, FFD_NORMAL);
+  }
+
+  free(filename);
+  free(tmp);
+  return flag;
+} /* End of write_checkpoint()*/
+
+	/*
+		* Write a checkpoint if one is due at the current time step
+		*
+		* @param para Pointer to FFD parameters
+		* @param var Pointer to FFD simulation variables
+		*
+		* @return 0 if no error occurred
+		*/
+int take_checkpoint(PARA_DATA *para, REAL **var) {
+  char name[30];
+
+  if(para->outp->checkpoint_step<1
+     || para->mytime->step_current%para->outp->checkpoint_step!=0)
+    return 0;
+
+  instance_file_name(para, "checkpoint", name);
+  return write_checkpoint(para, var, name);
+} /* End of take_checkpoint()*/
+
+	/*
+		* Check if a file is a checkpoint
+		*
+		* @param filename Pointer to the name of the file
+		*
+		* @return 1 if the file starts with CHECKPOINT_MAGIC
+		*/
+int is_checkpoint(const char *filename) {
+  char magic[8];
+  FILE *file;
+  int flag;
+
+  if((file=fopen(filename, "rb"))==NULL) return 0;
+  flag = fread(magic, 1, 8, file)==8 && memcmp(magic, CHECKPOINT_MAGIC, 8)==0;
+  fclose(file);
+
+  return flag;
+} /* End of is_checkpoint()*/
+
+	/*
+		* Restart from a checkpoint
+		*
+		* In a cosimulation, the time and the boundary conditions are kept
+		* from Modelica.
+		*
+		* @param para Pointer to FFD parameters
+		* @param var Pointer to FFD simulation variables
+		* @param filename Pointer to the name of the file
+		*
+		* @return 0 if no error occurred
+		*/
+int read_checkpoint(PARA_DATA *para, REAL **var, const char *filename) {
+  const unsigned char *data;
+  const CHECKPOINT_HEADER *head;
+  const int *id;
+  const REAL *psi;
+  size_t size, nb_cell = (size_t) (para->geom->imax+2)*(para->geom->jmax+2)
+                       * (para->geom->kmax+2);
+  int n;
+
+  data = map_file(filename, &size);
+  if(data==NULL) {
+    sprintf(msg, "read_checkpoint(): Could not map file %s.", filename);
+    ffd_log(msg, FFD_ERROR);
+    return 1;
+  }
+
+  head = (const CHECKPOINT_HEADER *) data;
+  if(size<sizeof(CHECKPOINT_HEADER)
+     || memcmp(head->magic, CHECKPOINT_MAGIC, 8)!=0
+     || check_checkpoint(para, var, head, size)!=0) {
+    sprintf(msg, "read_checkpoint(): File %s is not a valid checkpoint.",
+            filename);
+    ffd_log(msg, FFD_ERROR);
+    unmap_file(data, size);
+    return 1;
+  }
+
+  /****************************************************************************
+  | Copy the variables
+  ****************************************************************************/
+  id = (const int *) (data + sizeof(CHECKPOINT_HEADER));
+  psi = (const REAL *) (id + head->nb_var + head->nb_var%2);
+  if(head->nb_sensor>0)
+    memcpy(para->sens->senValMean, psi, head->nb_sensor*sizeof(REAL));
+  psi += head->nb_sensor;
+  for(n=0; n<head->nb_var; n++, psi+=nb_cell) {
+    /* The flags of the ports and the boundary conditions were assigned from*/
+    /* the Modelica data of the first exchange*/
+    if(para->solv->cosimulation==1 && is_boundary_var(id[n])) continue;
+    if(id[n]>=0 && id[n]<=NUT)
+      memcpy(var[id[n]], psi, nb_cell*sizeof(REAL));
+  }
+
+  /****************************************************************************
+  | Restore the time average and the time
+  ****************************************************************************/
+  para->mytime->step_current = head->step_current;
+  para->mytime->step_mean = head->step_mean;
+  para->mytime->w_mean = head->w_mean;
+  para->outp->cal_mean = head->cal_mean;
+  para->sens->TRooMean = head->TRooMean;
+  if(para->solv->cosimulation==0) {
+    para->mytime->t = head->t;
+    para->mytime->dt = head->dt;
+  }
+  /* The coefficients were built for the initial fields*/
+  para->cache->step = -1;
+
+  sprintf(msg, "read_checkpoint(): Restarted from file %s written at "
+          "t=%f[s] after %d time steps.", filename, head->t,
+          head->step_current);
+  ffd_log(msg, FFD_NORMAL);
+
+  unmap_file(data, size);
+  return 0;
+} /* End of read_checkpoint()*/
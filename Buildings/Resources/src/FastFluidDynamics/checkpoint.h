@@ -0,0 +1,113 @@
+/*
+	*
+	* @file   checkpoint.h
+	*
+	* @brief  Write and read binary checkpoints to restart FFD
+	*
+	* @author Xu Han
+	*         University of Colorado Boulder
+	*         xuha3556@colorado.edu
+	*
+	* @date   10/18/2026
+	*
+	* A checkpoint keeps the variables carried from one time step to the
+	* next, the sums of the time average and the state of the time. If
+	* outp.checkpoint_step is larger than 0, FFD writes checkpoint.ckp every
+	* outp.checkpoint_step time steps and at the end of the simulation. A
+	* checkpoint given as inpu.old_ffd_file_name is mapped into memory and
+	* copied to the variables. It is rejected if it was written for another
+	* grid or another geometry of the solid cells.
+	*
+	* The numbers are stored in the byte order of the host:
+	*
+	* Header:    CHECKPOINT_HEADER
+	* Variables: ID of each variable (4 bytes each), followed by 0 if the
+	*            number of variables is odd
+	* Sensors:   time averaged value of each sensor
+	* Data:      values of each variable in the order of the IDs
+	*
+	*/
+#ifndef _CHECKPOINT_H
+#define _CHECKPOINT_H
+#endif
+
+#ifndef _DATA_STRUCTURE_H
+#define _DATA_STRUCTURE_H
+#include "data_structure.h"
+#endif
+
+#ifndef _UTILITY_H
+#define _UTILITY_H
+#include "utility.h"
+#endif
+
+#define CHECKPOINT_MAGIC "FFDCHKPT" /* First 8 bytes of a checkpoint*/
+#define CHECKPOINT_VERSION 1 /* Version of the format of the checkpoint*/
+#define CHECKPOINT_BYTE_ORDER 0x01020304 /* Detects another byte order*/
+
+/* Header of a checkpoint; every member is aligned without padding*/
+typedef struct {
+  char magic[8]; /* CHECKPOINT_MAGIC without the ending 0*/
+  int version; /* CHECKPOINT_VERSION*/
+  int byte_order; /* CHECKPOINT_BYTE_ORDER*/
+  int real_size; /* Number of bytes of a REAL*/
+  int imax; /* Number of interior cells in x-direction*/
+  int jmax; /* Number of interior cells in y-direction*/
+  int kmax; /* Number of interior cells in z-direction*/
+  int nb_var; /* Number of variables*/
+  int nb_sensor; /* Number of sensors*/
+  unsigned int geometry; /* Hash of the grid and the solid cells*/
+  int step_current; /* Current iteration step*/
+  int step_mean; /* Steps for time average*/
+  int cal_mean; /* 1: The time average was started*/
+  double t; /* Current time*/
+  double dt; /* Time step size*/
+  REAL w_mean; /* Sum of the weights of the steps for time average*/
+  REAL TRooMean; /* Time averaged room temperature*/
+}CHECKPOINT_HEADER;
+
+/*
+	* Write a checkpoint
+	*
+	* The checkpoint is written to a temporary file first, so that a
+	* failure does not destroy the previous checkpoint.
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	* @param name Pointer to the filename without extension
+	*
+	* @return 0 if no error occurred
+	*/
+int write_checkpoint(PARA_DATA *para, REAL **var, char *name);
+
+/*
+	* Write a checkpoint if one is due at the current time step
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	*
+	* @return 0 if no error occurred
+	*/
+int take_checkpoint(PARA_DATA *para, REAL **var);
+
+/*
+	* Check if a file is a checkpoint
+	*
+	* @param filename Pointer to the name of the file
+	*
+	* @return 1 if the file starts with CHECKPOINT_MAGIC
+	*/
+int is_checkpoint(const char *filename);
+
+/*
+	* Restart from a checkpoint
+	*
+	* In a cosimulation, the time is kept from Modelica.
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	* @param filename Pointer to the name of the file
+	*
+	* @return 0 if no error occurred
+	*/
+int read_checkpoint(PARA_DATA *para, REAL **var, const char *filename);
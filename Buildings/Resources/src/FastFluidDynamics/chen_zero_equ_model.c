@@ -22,6 +22,9 @@
 /*
 	* Computes turbulent viscosity using Chen's zero equation model
 	*
+	* The length scale is the distance to the nearest wall stored in var[DIST],
+	* which is computed once by wall_distance() at the initialization.
+	*
 	* @param para Pointer to FFD parameters
 	* @param var Pointer to FFD simulation variables
 	* @param i I-index of the control volume
@@ -31,31 +34,200 @@
 	* @return Turbulent Kinematic viscosity
 	*/
 REAL nu_t_chen_zero_equ(PARA_DATA *para, REAL **var, int i, int j, int k) {
-  REAL nu_t, l, lx, lx1, lx2, ly, ly1, ly2, lz, lz1, lz2;
-  REAL *x = var[X], *y = var[Y], *z = var[Z];
-  REAL *u = var[VX], *v = var[VY], *w = var[Z];
-  int imax = para->geom->imax, jmax = para->geom->jmax,
-      kmax = para->geom->kmax;
+  REAL nu_t;
+  REAL *u = var[VX], *v = var[VY], *w = var[VZ];
+  int imax = para->geom->imax, jmax = para->geom->jmax;
   int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
 
-  lx1 = x[IX(i,j,k)] - x[IX(0,j,k)];
-  lx2 = x[IX(imax+1,j,k)] - x[IX(i,j,k)];
-  lx = lx1 < lx2 ? lx1 : lx2;
-
-  ly1 = y[IX(i,j,k)] - y[IX(i,0,k)];
-  ly2 = y[IX(i,jmax,k)] - y[IX(i,j,k)];
-  ly = ly1 < ly2 ? ly1 : ly2;
-
-  lz1 = z[IX(i,j,k)] - z[IX(i,j,0)];
-  lz2 = z[IX(i,j,kmax+1)] - z[IX(i,j,k)];
-  lz = lz1 < lz2 ? lz1 : lz2;
-
-  l = lx < ly ? lx : ly;
-  l = lz < l ? lz : l;
-  nu_t = para->prob->chen_a * l
+  nu_t = para->prob->chen_a * var[DIST][IX(i,j,k)]
        * (REAL)sqrt( u[IX(i,j,k)]*u[IX(i,j,k)]
                     +v[IX(i,j,k)]*v[IX(i,j,k)]
                     +w[IX(i,j,k)]*w[IX(i,j,k)] );
 
   return nu_t;
 } /* End of nu_t_chen_zero_equ()*/
+
+/*
+	* Computes the turbulent viscosity field var[NUT] for all the fluid cells
+	*
+	* The field is computed once per time step and shared by the coefficients
+	* of all the transport equations and the wall heat transfer coefficients.
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	*
+	* @return 0 if no error occurred
+	*/
+int nu_t_chen_zero_equ_field(PARA_DATA *para, REAL **var) {
+  int i, j, k;
+  int imax = para->geom->imax, jmax = para->geom->jmax,
+      kmax = para->geom->kmax;
+  int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
+  REAL *nut = var[NUT], *flagp = var[FLAGP];
+
+  FOR_EACH_CELL
+    if(flagp[IX(i,j,k)]==FLUID)
+      nut[IX(i,j,k)] = nu_t_chen_zero_equ(para, var, i, j, k);
+    else
+      nut[IX(i,j,k)] = 0;
+  END_FOR
+
+  return 0;
+} /* End of nu_t_chen_zero_equ_field()*/
+
+/*
+	* Computes the distance from the center of each fluid cell to the nearest
+	* wall
+	*
+	* All the non-fluid cells (domain walls, internal blocks, inlets and
+	* outlets) are treated as walls. A fluid cell next to a wall starts with the
+	* projection of its center on the shared cell surface as the nearest wall
+	* point. The nearest wall points are then propagated to the neighboring
+	* fluid cells by sweeps in the 8 alternating directions until no distance
+	* changes (vector distance transform). The result is exact for the planar
+	* walls and accounts for the internal blocks.
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	*
+	* @return 0 if no error occurred
+	*/
+int wall_distance(PARA_DATA *para, REAL **var) {
+  int i, j, k, n, it, sweep, changed;
+  int is, ie, id, js, je, jd, ks, ke, kd;
+  int imax = para->geom->imax, jmax = para->geom->jmax,
+      kmax = para->geom->kmax;
+  int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
+  int size = (imax+2)*(jmax+2)*(kmax+2);
+  int nb[6];
+  REAL *x = var[X], *y = var[Y], *z = var[Z];
+  REAL *gx = var[GX], *gy = var[GY], *gz = var[GZ];
+  REAL *d = var[DIST], *flagp = var[FLAGP];
+  REAL *px, *py, *pz;
+  REAL big = (REAL) 1e30, dx, dy, dz, tmp;
+
+  /****************************************************************************
+  | Allocate memory for the coordinates of the nearest wall points
+  ****************************************************************************/
+  px = (REAL *) malloc(size*sizeof(REAL));
+  py = (REAL *) malloc(size*sizeof(REAL));
+  pz = (REAL *) malloc(size*sizeof(REAL));
+  if(px==NULL || py==NULL || pz==NULL) {
+    ffd_log("wall_distance(): Could not allocate memory for the wall points.",
+            FFD_ERROR);
+    if(px!=NULL) free(px);
+    if(py!=NULL) free(py);
+    if(pz!=NULL) free(pz);
+    return 1;
+  }
+
+  /****************************************************************************
+  | Set the nearest wall points for cells next to the walls
+  ****************************************************************************/
+  FOR_ALL_CELL
+    d[IX(i,j,k)] = 0;
+  END_FOR
+
+  FOR_EACH_CELL
+    if(flagp[IX(i,j,k)]!=FLUID) continue;
+
+    d[IX(i,j,k)] = big;
+    /* West*/
+    tmp = x[IX(i,j,k)] - gx[IX(i-1,j,k)];
+    if(flagp[IX(i-1,j,k)]!=FLUID && tmp<d[IX(i,j,k)]) {
+      d[IX(i,j,k)] = tmp;
+      px[IX(i,j,k)] = gx[IX(i-1,j,k)];
+      py[IX(i,j,k)] = y[IX(i,j,k)]; pz[IX(i,j,k)] = z[IX(i,j,k)];
+    }
+    /* East*/
+    tmp = gx[IX(i,j,k)] - x[IX(i,j,k)];
+    if(flagp[IX(i+1,j,k)]!=FLUID && tmp<d[IX(i,j,k)]) {
+      d[IX(i,j,k)] = tmp;
+      px[IX(i,j,k)] = gx[IX(i,j,k)];
+      py[IX(i,j,k)] = y[IX(i,j,k)]; pz[IX(i,j,k)] = z[IX(i,j,k)];
+    }
+    /* South*/
+    tmp = y[IX(i,j,k)] - gy[IX(i,j-1,k)];
+    if(flagp[IX(i,j-1,k)]!=FLUID && tmp<d[IX(i,j,k)]) {
+      d[IX(i,j,k)] = tmp;
+      py[IX(i,j,k)] = gy[IX(i,j-1,k)];
+      px[IX(i,j,k)] = x[IX(i,j,k)]; pz[IX(i,j,k)] = z[IX(i,j,k)];
+    }
+    /* North*/
+    tmp = gy[IX(i,j,k)] - y[IX(i,j,k)];
+    if(flagp[IX(i,j+1,k)]!=FLUID && tmp<d[IX(i,j,k)]) {
+      d[IX(i,j,k)] = tmp;
+      py[IX(i,j,k)] = gy[IX(i,j,k)];
+      px[IX(i,j,k)] = x[IX(i,j,k)]; pz[IX(i,j,k)] = z[IX(i,j,k)];
+    }
+    /* Floor*/
+    tmp = z[IX(i,j,k)] - gz[IX(i,j,k-1)];
+    if(flagp[IX(i,j,k-1)]!=FLUID && tmp<d[IX(i,j,k)]) {
+      d[IX(i,j,k)] = tmp;
+      pz[IX(i,j,k)] = gz[IX(i,j,k-1)];
+      px[IX(i,j,k)] = x[IX(i,j,k)]; py[IX(i,j,k)] = y[IX(i,j,k)];
+    }
+    /* Ceiling*/
+    tmp = gz[IX(i,j,k)] - z[IX(i,j,k)];
+    if(flagp[IX(i,j,k+1)]!=FLUID && tmp<d[IX(i,j,k)]) {
+      d[IX(i,j,k)] = tmp;
+      pz[IX(i,j,k)] = gz[IX(i,j,k)];
+      px[IX(i,j,k)] = x[IX(i,j,k)]; py[IX(i,j,k)] = y[IX(i,j,k)];
+    }
+  END_FOR
+
+  /****************************************************************************
+  | Propagate the nearest wall points in 8 alternating directions
+  ****************************************************************************/
+  for(it=0; it<100; it++) {
+    changed = 0;
+
+    for(sweep=0; sweep<8; sweep++) {
+      if(sweep&1) { is = imax; ie = 0; id = -1; }
+      else { is = 1; ie = imax+1; id = 1; }
+      if(sweep&2) { js = jmax; je = 0; jd = -1; }
+      else { js = 1; je = jmax+1; jd = 1; }
+      if(sweep&4) { ks = kmax; ke = 0; kd = -1; }
+      else { ks = 1; ke = kmax+1; kd = 1; }
+
+      for(k=ks; k!=ke; k+=kd)
+        for(j=js; j!=je; j+=jd)
+          for(i=is; i!=ie; i+=id) {
+            if(flagp[IX(i,j,k)]!=FLUID) continue;
+
+            nb[0] = IX(i-1,j,k); nb[1] = IX(i+1,j,k);
+            nb[2] = IX(i,j-1,k); nb[3] = IX(i,j+1,k);
+            nb[4] = IX(i,j,k-1); nb[5] = IX(i,j,k+1);
+
+            for(n=0; n<6; n++) {
+              if(flagp[nb[n]]!=FLUID || d[nb[n]]>=big) continue;
+
+              dx = x[IX(i,j,k)] - px[nb[n]];
+              dy = y[IX(i,j,k)] - py[nb[n]];
+              dz = z[IX(i,j,k)] - pz[nb[n]];
+              tmp = (REAL) sqrt(dx*dx + dy*dy + dz*dz);
+
+              if(tmp < d[IX(i,j,k)]*(1-SMALL)) {
+                d[IX(i,j,k)] = tmp;
+                px[IX(i,j,k)] = px[nb[n]];
+                py[IX(i,j,k)] = py[nb[n]];
+                pz[IX(i,j,k)] = pz[nb[n]];
+                changed = 1;
+              }
+            }
+          }
+    } /* End of for(sweep=0; sweep<8; sweep++)*/
+
+    if(changed==0) break;
+  } /* End of for(it=0; it<100; it++)*/
+
+  free(px);
+  free(py);
+  free(pz);
+
+  sprintf(msg, "wall_distance(): Computed the wall distance with %d sweeps.",
+          8*(it+1));
+  ffd_log(msg, FFD_NORMAL);
+
+  return 0;
+} /* End of wall_distance()*/
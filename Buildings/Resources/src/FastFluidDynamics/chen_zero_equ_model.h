@@ -26,6 +26,11 @@
 #include "data_structure.h"
 #endif
 
+#ifndef _UTILITY_H
+#define _UTILITY_H
+#include "utility.h"
+#endif
+
 /*
 	* Computes turbulent viscosity using Chen's zero equation model
 	*
@@ -38,3 +43,24 @@
 	* @return Turbulent Kinematic viscosity
 	*/
 REAL nu_t_chen_zero_equ(PARA_DATA *para, REAL **var, int i, int j, int k);
+
+/*
+	* Computes the turbulent viscosity field var[NUT] for all the fluid cells
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	*
+	* @return 0 if no error occurred
+	*/
+int nu_t_chen_zero_equ_field(PARA_DATA *para, REAL **var);
+
+/*
+	* Computes the distance from the center of each fluid cell to the nearest
+	* wall
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	*
+	* @return 0 if no error occurred
+	*/
+int wall_distance(PARA_DATA *para, REAL **var);
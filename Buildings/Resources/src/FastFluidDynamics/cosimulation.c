@@ -223,6 +223,9 @@ int read_cosim_parameter(PARA_DATA *para, REAL **var, int **BINDEX) {
 		*/
 int read_cosim_data(PARA_DATA *para, REAL **var, int **BINDEX) {
   int i;
+  REAL *data, *slot;
+  ModelicaSharedData *modelica = para->cosim->modelica;
+  ParameterSharedData *cosim_para = para->cosim->para;
 
   ffd_log("-------------------------------------------------------------------",
           FFD_NORMAL);
@@ -231,24 +234,72 @@ int read_cosim_data(PARA_DATA *para, REAL **var, int **BINDEX) {
             FFD_NORMAL);
   }
   /****************************************************************************
-  | Wait for data to be updated by the other program
+  | Wait for a message from the other program
   ****************************************************************************/
-  while(para->cosim->modelica->flag==0) {
+  para->memo->skip = 0;
+  while((slot=ffd_ring_peek(para->cosim, para->cosim->input, 100))==NULL) {
     if(para->outp->version==DEBUG) {
       sprintf(msg,
               "read_cosim_data(): Data is not ready with "
-              "para->cosim->modelica->flag=%d",
-              para->cosim->modelica->flag);
+              "%d messages read",
+              para->cosim->input->tail);
       ffd_log(msg, FFD_NORMAL);
     }
 		/*return when detecting stop command*/
 		if (para->cosim->para->flag==0){
 				return 0;
-		}		
-		
-    Sleep(10);
-    if(para->outp->version==DEBUG)
-      ffd_log("read_cosim_data(): Sleep for 0.01s.", FFD_NORMAL);
+		}
+  }
+
+  /****************************************************************************
+  | Map the Modelica data to the message in the same order as the inputs of
+  | the Modelica model
+  ****************************************************************************/
+  data = slot;
+  modelica->t = data[0];
+  modelica->dt = data[1];
+  data += 2;
+
+  modelica->temHea = data;
+  data += cosim_para->nSur;
+
+  if(cosim_para->sha==1) {
+    modelica->shaConSig = data;
+    modelica->shaAbsRad = data + cosim_para->nConExtWin;
+    data += 2*cosim_para->nConExtWin;
+  }
+
+  modelica->sensibleHeat = data[0];
+  modelica->latentHeat = data[1];
+  modelica->p = data[2];
+  data += 3;
+
+  modelica->mFloRatPor = data;
+  modelica->TPor = data + cosim_para->nPorts;
+  data += 2*cosim_para->nPorts;
+
+  for(i=0; i<cosim_para->nPorts; i++)
+    modelica->XiPor[i] = data + i*cosim_para->nXi;
+  data += cosim_para->nPorts*cosim_para->nXi;
+
+  for(i=0; i<cosim_para->nPorts; i++)
+    modelica->CPor[i] = data + i*cosim_para->nC;
+
+  /****************************************************************************
+  | Restore the state if Modelica stepped back, otherwise keep the state
+  ****************************************************************************/
+  para->snap->restored = 0;
+  if(modelica->t<para->mytime->t-SMALL) {
+    if(restore_snapshot(para, var, modelica->t)!=0) {
+      ffd_log("read_cosim_data(): Could not restore the state.", FFD_ERROR);
+      return 1;
+    }
+  }
+  /* The initial state is kept by ffd() after the coarse grid and the*/
+  /* checkpoint are applied*/
+  else if(para->snap->slot!=NULL && take_snapshot(para, var)!=0) {
+    ffd_log("read_cosim_data(): Could not keep the state.", FFD_ERROR);
+    return 1;
   }
 
   if(para->outp->version==DEBUG) {
@@ -305,9 +356,18 @@ int read_cosim_data(PARA_DATA *para, REAL **var, int **BINDEX) {
   /****************************************************************************
   | Post-Process after reading the data
   ****************************************************************************/
-  /* Change the flag to indicate that the data has been read*/
-  para->cosim->modelica->flag = 0;
-  /*printf("para->cosim->modelica->flag=%d\n", para->cosim->modelica->flag);*/
+  /* The boundary conditions only need to be assigned again where they change*/
+  para->bc->assigned = 1;
+
+  /* Decide if the next window can be skipped*/
+  if(check_cosim_memo_input(para, slot)!=0) {
+    ffd_log("read_cosim_data(): Could not compare the inputs with the memo",
+            FFD_ERROR);
+    return 1;
+  }
+
+  /* Return the message slot to indicate that the data has been read*/
+  ffd_ring_release(para->cosim, para->cosim->input);
   if(para->outp->version==DEBUG) {
     ffd_log("read_cosim_data(): Ended reading data from Modelica.",
             FFD_NORMAL);
@@ -326,6 +386,9 @@ int read_cosim_data(PARA_DATA *para, REAL **var, int **BINDEX) {
 		*/
 int write_cosim_data(PARA_DATA *para, REAL **var) {
   int i, j, id;
+  REAL *data, *slot;
+  ffdSharedData *ffd = para->cosim->ffd;
+  ParameterSharedData *cosim_para = para->cosim->para;
 
   ffd_log("-------------------------------------------------------------------",
           FFD_NORMAL);
@@ -336,14 +399,42 @@ int write_cosim_data(PARA_DATA *para, REAL **var) {
   }
 
   /****************************************************************************
-  | Wait if the previous data has not been read by Modelica
+  | Wait if all the previous data has not been read by Modelica
   ****************************************************************************/
-  while(para->cosim->ffd->flag==1) {
+  while((slot=ffd_ring_reserve(para->cosim, para->cosim->output, 100))
+        ==NULL) {
     ffd_log("write_cosim_data(): Wait since previous data is not taken "
             "by Modelica", FFD_NORMAL);
-    Sleep(10);
   }
 
+  /****************************************************************************
+  | Map the FFD data to the message in the same order as the outputs of
+  | the Modelica model
+  ****************************************************************************/
+  data = slot + 2;
+
+  ffd->temHea = data;
+  /* Averaged room temperature is written at the end*/
+  data += cosim_para->nSur + 1;
+
+  if(cosim_para->sha==1) {
+    ffd->TSha = data;
+    data += cosim_para->nConExtWin;
+  }
+
+  ffd->TPor = data;
+  data += cosim_para->nPorts;
+
+  for(i=0; i<cosim_para->nPorts; i++)
+    ffd->XiPor[i] = data + i*cosim_para->nXi;
+  data += cosim_para->nPorts*cosim_para->nXi;
+
+  for(i=0; i<cosim_para->nPorts; i++)
+    ffd->CPor[i] = data + i*cosim_para->nC;
+  data += cosim_para->nPorts*cosim_para->nC;
+
+  ffd->senVal = data;
+
   /****************************************************************************
   | Start to write new data
   ****************************************************************************/
@@ -468,11 +559,222 @@ int write_cosim_data(PARA_DATA *para, REAL **var) {
   /****************************************************************************
   | Inform Modelica that the FFD data is updated
   ****************************************************************************/
-  para->cosim->ffd->flag = 1;
+  slot[0] = ffd->t;
+  slot[1] = para->rt->nb_miss;
+  slot[2+cosim_para->nSur] = ffd->TRoo;
+
+  if(store_cosim_memo_output(para, slot)!=0) {
+    ffd_log("write_cosim_data(): Could not store the outputs in the memo",
+            FFD_ERROR);
+    return 1;
+  }
+
+  ffd_ring_commit(para->cosim, para->cosim->output);
 
   return 0;
 } /* End of write_cosim_data()*/
 
+	/*
+		* Send the outputs of the last computed window again for a skipped window
+		*
+		* @param para Pointer to FFD parameters
+		*
+		* @return 0 if no error occurred
+		*/
+int write_cosim_memo(PARA_DATA *para) {
+  REAL *slot;
+
+  while((slot=ffd_ring_reserve(para->cosim, para->cosim->output, 100))
+        ==NULL) {
+    ffd_log("write_cosim_memo(): Wait since previous data is not taken "
+            "by Modelica", FFD_NORMAL);
+  }
+
+  memcpy(slot, para->memo->output,
+         para->cosim->output->size*sizeof(REAL));
+  slot[0] = para->mytime->t;
+  slot[1] = para->rt->nb_miss;
+  ffd_ring_commit(para->cosim, para->cosim->output);
+
+  para->memo->nb_skip++;
+  sprintf(msg, "write_cosim_memo(): Skipped the window ending at t=%f[s] "
+          "with unchanged inputs (%d windows skipped)",
+          para->mytime->t, para->memo->nb_skip);
+  ffd_log(msg, FFD_NORMAL);
+
+  return 0;
+} /* End of write_cosim_memo()*/
+
+	/*
+		* Get the quantity of a value in a message of the cosimulation
+		*
+		* @param para Pointer to FFD parameters
+		* @param i Index of the value after the time and the time step
+		* @param input 1: Message from Modelica; 0: Message to Modelica
+		*
+		* @return Quantity MEMO_T, MEMO_Q, MEMO_SIGNAL, MEMO_P, MEMO_M, MEMO_XI,
+		*         MEMO_C or MEMO_SENSOR
+		*/
+static int memo_quantity(PARA_DATA *para, int i, int input) {
+  ParameterSharedData *p = para->cosim->para;
+  int nSur = p->nSur, nPorts = p->nPorts;
+  int nSha = p->sha==1 ? p->nConExtWin : 0;
+  int nXi = p->nXi, nC = p->nC;
+
+  /* Modelica sends the temperature of the surfaces with bouCon 1*/
+  if(i<nSur)
+    return (p->bouCon[i]==1)==(input==1) ? MEMO_T : MEMO_Q;
+  i -= nSur;
+
+  /* shaConSig, shaAbsRad, sensibleHeat, latentHeat, p, mFloRatPor, TPor*/
+  if(input==1) {
+    if(i<nSha) return MEMO_SIGNAL;
+    i -= nSha;
+    if(i<nSha+2) return MEMO_Q;
+    i -= nSha+2;
+    if(i<1) return MEMO_P;
+    i -= 1;
+    if(i<nPorts) return MEMO_M;
+    i -= nPorts;
+  }
+  /* TRoo, TSha*/
+  else {
+    if(i<1+nSha) return MEMO_T;
+    i -= 1+nSha;
+  }
+
+  if(i<nPorts) return MEMO_T;
+  i -= nPorts;
+  if(i<nPorts*nXi) return MEMO_XI;
+  i -= nPorts*nXi;
+  if(i<nPorts*nC) return MEMO_C;
+
+  return MEMO_SENSOR;
+} /* End of memo_quantity()*/
+
+	/*
+		* Check if a message of the cosimulation changed
+		*
+		* A value changed if it differs by more than the tolerance times the
+		* largest magnitude of the same quantity in the two messages. A single
+		* tolerance thus applies to temperatures, heat flow rates and mass flow
+		* rates alike, and values close to 0 are compared with the other values
+		* of their quantity. Each sensor is compared with its own magnitude.
+		*
+		* @param para Pointer to FFD parameters
+		* @param a Pointer to the new message
+		* @param b Pointer to the old message
+		* @param size Number of values in the messages
+		* @param input 1: Message from Modelica; 0: Message to Modelica
+		*
+		* @return 1 if the message changed, 0 otherwise
+		*/
+static int memo_changed(PARA_DATA *para, REAL *a, REAL *b, int size,
+                        int input) {
+  REAL tol = para->solv->memo_tolerance;
+  REAL scale[MEMO_NB_QUANTITY], tmp;
+  int i, q;
+
+  for(q=0; q<MEMO_NB_QUANTITY; q++)
+    scale[q] = 0;
+
+  /* Time and time step change at every window*/
+  for(i=2; i<size; i++) {
+    q = memo_quantity(para, i-2, input);
+    tmp = fabs(a[i])>fabs(b[i]) ? (REAL) fabs(a[i]) : (REAL) fabs(b[i]);
+    if(q!=MEMO_SENSOR && tmp>scale[q]) scale[q] = tmp;
+  }
+
+  for(i=2; i<size; i++) {
+    q = memo_quantity(para, i-2, input);
+    if(q==MEMO_SENSOR)
+      tmp = fabs(a[i])>fabs(b[i]) ? (REAL) fabs(a[i]) : (REAL) fabs(b[i]);
+    else
+      tmp = scale[q];
+    if(fabs(a[i]-b[i])>tol*tmp) return 1;
+  }
+
+  return 0;
+} /* End of memo_changed()*/
+
+	/*
+		* Compare the message from Modelica with the one of the last computed window
+		*
+		* The next window is skipped if every input differs by less than
+		* para->solv->memo_tolerance and the outputs of the last two windows
+		* computed with these inputs also differed by less than the tolerance.
+		* The tolerance is relative to the magnitude of each quantity, since the
+		* inputs are temperatures, heat flow rates, pressures, mass flow rates
+		* and mass fractions.
+		* The inputs are compared with the window that was last computed, so
+		* that a slow drift of the inputs still leads to a new computation.
+		*
+		* @param para Pointer to FFD parameters
+		* @param slot Pointer to the message from Modelica
+		*
+		* @return 0 if no error occurred
+		*/
+int check_cosim_memo_input(PARA_DATA *para, REAL *slot) {
+  MEMO_DATA *memo = para->memo;
+  REAL tol = para->solv->memo_tolerance;
+  int size = para->cosim->input->size;
+
+  memo->skip = 0;
+  if(tol<=0) return 0;
+
+  if(memo->input==NULL) {
+    memo->input = (REAL *) malloc(size*sizeof(REAL));
+    if(memo->input==NULL) {
+      ffd_log("check_cosim_memo_input(): Could not allocate memory for "
+              "the inputs.", FFD_ERROR);
+      return 1;
+    }
+  }
+  else if(memo_changed(para, slot, memo->input, size, 1)==0) {
+    memo->skip = memo->steady;
+    return 0;
+  }
+
+  /* New inputs: compute until the outputs are steady again*/
+  memcpy(memo->input, slot, size*sizeof(REAL));
+  memo->nb_window = 0;
+  memo->steady = 0;
+
+  return 0;
+} /* End of check_cosim_memo_input()*/
+
+	/*
+		* Store the message to Modelica and check if the outputs are steady
+		*
+		* @param para Pointer to FFD parameters
+		* @param slot Pointer to the message to Modelica
+		*
+		* @return 0 if no error occurred
+		*/
+int store_cosim_memo_output(PARA_DATA *para, REAL *slot) {
+  MEMO_DATA *memo = para->memo;
+  REAL tol = para->solv->memo_tolerance;
+  int size = para->cosim->output->size;
+
+  if(tol<=0) return 0;
+
+  if(memo->output==NULL) {
+    memo->output = (REAL *) malloc(size*sizeof(REAL));
+    if(memo->output==NULL) {
+      ffd_log("store_cosim_memo_output(): Could not allocate memory for "
+              "the outputs.", FFD_ERROR);
+      return 1;
+    }
+  }
+  else if(memo->nb_window>0)
+    memo->steady = memo_changed(para, slot, memo->output, size, 0)==0;
+
+  memcpy(memo->output, slot, size*sizeof(REAL));
+  memo->nb_window++;
+
+  return 0;
+} /* End of store_cosim_memo_output()*/
+
 
 
 	/*
@@ -483,7 +785,8 @@ int write_cosim_data(PARA_DATA *para, REAL **var) {
 		* @return 0 if no error occurred
 		*/
 int compare_boundary_names(PARA_DATA *para) {
-  int i, j, flag;
+  int i, j, size;
+  int *table;
 
   char **name1 = para->cosim->para->name;
   char **name2 = para->bc->wallName;
@@ -493,97 +796,88 @@ int compare_boundary_names(PARA_DATA *para) {
   /****************************************************************************
   | Compare the names of solid surfaces
   ****************************************************************************/
-  for(i=0; i<para->cosim->para->nSur; i++) {
-    /*-------------------------------------------------------------------------
-    | Assume we do not find the name
-    -------------------------------------------------------------------------*/
-    flag = 1;
-
-    /*-------------------------------------------------------------------------
-    | Check the wall names in FFD
-    -------------------------------------------------------------------------*/
-    for(j=0; j<para->bc->nb_wall&&flag!=0; j++) {
-      flag = strcmp(name1[i], name2[j]);
-      /* If found the name*/
-      if(flag==0) {
-        /* If the same name has been found before*/
-        if(para->bc->wallId[j]>0) {
-          sprintf(msg, "compare_boundary_names(): Modelica has "
-            "the same name \"%s\" for two BCs.", name1[i]);
-          ffd_log(msg, FFD_ERROR);
-          return 1;
-        }
-        /* If no same name has been found before, use it*/
-        else {
-          sprintf(msg,
-          "compare_boundary_names(): Matched boundary name \"%s\".",
-          name1[i]);
-          ffd_log(msg, FFD_NORMAL);
-          para->bc->wallId[j] = i;
-        }
-      } /* End of if(flag==0)*/
-    } /* End of for(j=0; j<para->bc->nb_wall&&flag!=0; j++)*/
+  table = build_name_table(name2, para->bc->nb_wall, &size);
+  if(table==NULL) {
+    ffd_log("compare_boundary_names(): Could not allocate memory for the "
+            "table of wall names.", FFD_ERROR);
+    return 1;
+  }
 
+  for(i=0; i<para->cosim->para->nSur; i++) {
+    j = find_name(name2, table, size, name1[i]);
     /*-------------------------------------------------------------------------
     | Stop if name is not found
     -------------------------------------------------------------------------*/
-    if(flag!=0) {
+    if(j<0) {
       sprintf(msg, "compare_boundary_names(): Could not find the Modelica "
         " wall boundary \"%s\" in FFD.", name1[i]);
       ffd_log(msg, FFD_ERROR);
+      free(table);
       return 1;
     }
+    /*-------------------------------------------------------------------------
+    | Stop if the same name has been found before
+    -------------------------------------------------------------------------*/
+    else if(para->bc->wallId[j]>=0) {
+      sprintf(msg, "compare_boundary_names(): Modelica has "
+        "the same name \"%s\" for two BCs.", name1[i]);
+      ffd_log(msg, FFD_ERROR);
+      free(table);
+      return 1;
+    }
+
+    sprintf(msg, "compare_boundary_names(): Matched boundary name \"%s\".",
+            name1[i]);
+    ffd_log(msg, FFD_NORMAL);
+    para->bc->wallId[j] = i;
   } /* Next Modelica Wall name*/
+  free(table);
 
   /****************************************************************************
   | Compare the names of fluid ports
   ****************************************************************************/
   ffd_log("Start to compare port names", FFD_NORMAL);
+  table = build_name_table(name4, para->bc->nb_port, &size);
+  if(table==NULL) {
+    ffd_log("compare_boundary_names(): Could not allocate memory for the "
+            "table of port names.", FFD_ERROR);
+    return 1;
+  }
+
   for(i=0; i<para->cosim->para->nPorts; i++) {
-    /*-------------------------------------------------------------------------
-    | Assume we do not find the name
-    -------------------------------------------------------------------------*/
-    flag = 1;
     sprintf(msg, "\tModelica: port[%d]=%s", i, name3[i]);
     ffd_log(msg, FFD_NORMAL);
-    /*-------------------------------------------------------------------------
-    | Check the FFD inlet and outlet names
-    -------------------------------------------------------------------------*/
-    for(j=0; j<para->bc->nb_port&&flag!=0; j++) {
-      flag = strcmp(name3[i], name4[j]);
-      sprintf(msg, "\tFFD: port[%d]=%s", j, name4[j]);
-      ffd_log(msg, FFD_NORMAL);
-      /* If found the name*/
-      if(flag==0) {
-        /* If the same name has been found before*/
-        if(para->bc->portId[j]>0) {
-          sprintf(msg,
-          "compare_boundary_names(): Modelica has the same name \"%s\" for two BCs.",
-          name3[i]);
-          ffd_log(msg, FFD_ERROR);
-          return 1;
-        }
-        /* If no same name has been found before, use it*/
-        else {
-          sprintf(msg,
-          "compare_boundary_names(): Matched boundary name \"%s\".",
-          name3[i]);
-          ffd_log(msg, FFD_NORMAL);
-          para->bc->portId[j] = i;
-        }
-      } /* End of if(flag==0)*/
-    }
-
+    j = find_name(name4, table, size, name3[i]);
     /*-------------------------------------------------------------------------
     | Stop if name is not found
     -------------------------------------------------------------------------*/
-    if(flag!=0) {
+    if(j<0) {
       sprintf(msg, "compare_boundary_names(): Could not find "
         "the Modelica fluid port boundary \"%s\" in FFD.", name3[i]);
       ffd_log(msg, FFD_ERROR);
+      free(table);
       return 1;
     }
+    /*-------------------------------------------------------------------------
+    | Stop if the same name has been found before
+    -------------------------------------------------------------------------*/
+    else if(para->bc->portId[j]>=0) {
+      sprintf(msg,
+      "compare_boundary_names(): Modelica has the same name \"%s\" for two BCs.",
+      name3[i]);
+      ffd_log(msg, FFD_ERROR);
+      free(table);
+      return 1;
+    }
+
+    sprintf(msg, "\tFFD: port[%d]=%s", j, name4[j]);
+    ffd_log(msg, FFD_NORMAL);
+    sprintf(msg, "compare_boundary_names(): Matched boundary name \"%s\".",
+            name3[i]);
+    ffd_log(msg, FFD_NORMAL);
+    para->bc->portId[j] = i;
   } /* Next Modelica port name*/
+  free(table);
 
   return 0;
 } /* End of compare_boundary_names()*/
@@ -621,9 +915,115 @@ int compare_boundary_area(PARA_DATA *para, REAL **var, int **BINDEX) {
     }
   }
 
+  /****************************************************************************
+  | Map the boundaries to their cells for assigning the Modelica data
+  ****************************************************************************/
+  if(map_boundary_cells(para, var, BINDEX)!=0) {
+    ffd_log("compare_boundary_area(): Could not map the boundaries to the "
+            "boundary cells.", FFD_ERROR);
+    return 1;
+  }
+
   return 0;
 } /* End of compare_boundary_area()*/
 
+	/*
+		* Group the boundary cells by the wall or the port they belong to
+		*
+		* The cells of wall i are bc->wallCell[bc->wallCellStart[i]] to
+		* bc->wallCell[bc->wallCellStart[i+1]-1], and similar for the ports,
+		* so that the Modelica data of a boundary is assigned to its cells
+		* without going through all the boundary cells.
+		*
+		* @param para Pointer to FFD parameters
+		* @param var Pointer to the FFD simulation variables
+		* @param BINDEX Pointer to boundary index
+		*
+		* @return 0 if no error occurred
+		*/
+int map_boundary_cells(PARA_DATA *para, REAL **var, int **BINDEX) {
+  int i, j, k, it, id, n, type, nb_skip = 0;
+  int imax = para->geom->imax, jmax = para->geom->jmax;
+  int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
+  int nb_bou[2], *start[2], *cell[2];
+
+  nb_bou[0] = para->bc->nb_wall;
+  nb_bou[1] = para->bc->nb_port;
+
+  for(n=0; n<2; n++) {
+    start[n] = (int *) calloc(nb_bou[n]+2, sizeof(int));
+    cell[n] = (int *) malloc((para->geom->index+1)*sizeof(int));
+    if(start[n]==NULL || cell[n]==NULL) {
+      ffd_log("map_boundary_cells(): Could not allocate memory for the "
+              "boundary cells.", FFD_ERROR);
+      return 1;
+    }
+  }
+
+  /****************************************************************************
+  | Count the cells of each boundary
+  | Type 0: solid cells belong to a wall; Type 1: inlet or outlet cells to a port
+  ****************************************************************************/
+  for(it=0; it<para->geom->index; it++) {
+    i = BINDEX[0][it];
+    j = BINDEX[1][it];
+    k = BINDEX[2][it];
+    id = BINDEX[4][it];
+    if(var[FLAGP][IX(i,j,k)]==SOLID)
+      type = 0;
+    else if(var[FLAGP][IX(i,j,k)]==INLET || var[FLAGP][IX(i,j,k)]==OUTLET)
+      type = 1;
+    else
+      continue;
+
+    /* Cells of internal blocks may have an ID beyond the walls*/
+    if(id<0 || id>=nb_bou[type]) {
+      nb_skip++;
+      continue;
+    }
+    start[type][id+2]++;
+  }
+
+  /****************************************************************************
+  | Fill the cells of each boundary in the order of BINDEX
+  ****************************************************************************/
+  for(n=0; n<2; n++)
+    for(id=0; id<nb_bou[n]; id++)
+      start[n][id+2] += start[n][id+1];
+
+  for(it=0; it<para->geom->index; it++) {
+    i = BINDEX[0][it];
+    j = BINDEX[1][it];
+    k = BINDEX[2][it];
+    if(var[FLAGP][IX(i,j,k)]==SOLID)
+      type = 0;
+    else if(var[FLAGP][IX(i,j,k)]==INLET || var[FLAGP][IX(i,j,k)]==OUTLET)
+      type = 1;
+    else
+      continue;
+    id = BINDEX[4][it];
+    if(id>=0 && id<nb_bou[type])
+      cell[type][start[type][id+1]++] = it;
+  }
+
+  if(para->bc->wallCell!=NULL) free(para->bc->wallCell);
+  if(para->bc->wallCellStart!=NULL) free(para->bc->wallCellStart);
+  if(para->bc->portCell!=NULL) free(para->bc->portCell);
+  if(para->bc->portCellStart!=NULL) free(para->bc->portCellStart);
+  para->bc->wallCell = cell[0];
+  para->bc->wallCellStart = start[0];
+  para->bc->portCell = cell[1];
+  para->bc->portCellStart = start[1];
+  para->bc->assigned = 0;
+
+  sprintf(msg, "map_boundary_cells(): Mapped %d wall cells and %d port cells, "
+          "skipped %d cells without a wall or port", start[0][nb_bou[0]],
+          start[1][nb_bou[1]], nb_skip);
+  ffd_log(msg, FFD_NORMAL);
+
+  return 0;
+} /* End of map_boundary_cells()*/
+
 	/*
 		* Assign the Modelica solid surface thermal boundary condition data to FFD
 		*
@@ -634,13 +1034,13 @@ int compare_boundary_area(PARA_DATA *para, REAL **var, int **BINDEX) {
 		* @return 0 if no error occurred
 		*/
 int assign_thermal_bc(PARA_DATA *para, REAL **var, int **BINDEX) {
-  int i, j, k, it, id, modelicaId;
+  int i, j, k, it, id, n, modelicaId, nb_dirty = 0;
   int imax = para->geom->imax, jmax = para->geom->jmax,
       kmax = para->geom->kmax;
   int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
   REAL sensibleHeat=para->cosim->modelica->sensibleHeat;
   REAL latentHeat=para->cosim->modelica->latentHeat;
-  REAL *temHea, celVol;
+  REAL value, celVol;
 
   /****************************************************************************
   | Assign the boundary condition if there is a solid surface
@@ -648,70 +1048,61 @@ int assign_thermal_bc(PARA_DATA *para, REAL **var, int **BINDEX) {
   if(para->bc->nb_wall>0) {
     ffd_log("assign_thermal_bc(): Thermal conditions for solid surfaces:",
           FFD_NORMAL);
-    temHea = (REAL *) malloc(para->bc->nb_wall*sizeof(REAL));
-    if(temHea==NULL) {
-      ffd_log("assign_thermal_bc(): Could not allocate memory for temHea.",
-              FFD_ERROR);
-      return 1;
-    }
-    /*-------------------------------------------------------------------------*/
-    /* Convert the data from Modelica order to FFD order*/
-    /*-------------------------------------------------------------------------*/
-    for(j=0; j<para->bc->nb_wall; j++) {
-      i = para->bc->wallId[j];
-      switch(para->cosim->para->bouCon[i]) {
+    for(id=0; id<para->bc->nb_wall; id++) {
+      /*-----------------------------------------------------------------------*/
+      /* Convert the data from Modelica order to FFD order*/
+      /*-----------------------------------------------------------------------*/
+      modelicaId = para->bc->wallId[id];
+      switch(para->cosim->para->bouCon[modelicaId]) {
         case 1: /* Temperature*/
-          temHea[j] = para->cosim->modelica->temHea[i] - 273.15;
+          value = para->cosim->modelica->temHea[modelicaId] - 273.15;
           sprintf(msg, "\t%s: T=%f[degC]",
-            para->bc->wallName[j], temHea[j]);
+            para->bc->wallName[id], value);
           ffd_log(msg, FFD_NORMAL);
           break;
         case 2: /* Heat flow rate*/
-          temHea[j] = para->cosim->modelica->temHea[i] / para->bc->AWall[j];
+          value = para->cosim->modelica->temHea[modelicaId] / para->bc->AWall[id];
           sprintf(msg, "\t%s: Q_dot=%f[W/m2]",
-            para->bc->wallName[j], temHea[j]);
+            para->bc->wallName[id], value);
           ffd_log(msg, FFD_NORMAL);
           break;
         default:
           sprintf(msg,
           "Invalid value (%d) for thermal boundary condition. "
           "Expected value are 1->Fixed T; 2->Fixed heat flux",
-          para->cosim->para->bouCon[i]);
+          para->cosim->para->bouCon[modelicaId]);
           ffd_log(msg, FFD_ERROR);
           return 1;
       }
-    }
-    /*-------------------------------------------------------------------------*/
-    /* Assign the BC*/
-    /*-------------------------------------------------------------------------*/
-    for(it=0; it<para->geom->index; it++) {
-      i = BINDEX[0][it];
-      j = BINDEX[1][it];
-      k = BINDEX[2][it];
-      id = BINDEX[4][it];
-      modelicaId = para->bc->wallId[id];
 
-      if(var[FLAGP][IX(i,j,k)]==SOLID)
-        switch(para->cosim->para->bouCon[modelicaId]) {
-          case 1:
-            var[TEMPBC][IX(i,j,k)] = temHea[id];
-            BINDEX[3][it] = 1; /* Specified temperature*/
-            break;
-          case 2:
-            var[QFLUXBC][IX(i,j,k)] = temHea[id];
-            BINDEX[3][it] = 0; /* Specified heat flux*/
-            break;
-          default:
-            sprintf(msg,
-              "assign_thermal_bc(): Thermal bc value BINDEX[3][%d]=%d "
-              "at [%d,%d,%d] was not valid.",
-              it, BINDEX[3][it], i, j, k);
-            ffd_log(msg, FFD_ERROR);
-            return 1;
-      } /* End of switch(BINDEX[3][it])*/
-    }
-
-    free(temHea);
+      /*-----------------------------------------------------------------------*/
+      /* Assign the BC to the cells of the surface if its value changed*/
+      /*-----------------------------------------------------------------------*/
+      if(para->bc->assigned==1 && value==para->bc->temHea[id]) continue;
+      para->bc->temHea[id] = value;
+      nb_dirty++;
+
+      for(n=para->bc->wallCellStart[id]; n<para->bc->wallCellStart[id+1]; n++) {
+        it = para->bc->wallCell[n];
+        i = BINDEX[0][it];
+        j = BINDEX[1][it];
+        k = BINDEX[2][it];
+        if(para->cosim->para->bouCon[modelicaId]==1) {
+          var[TEMPBC][IX(i,j,k)] = value;
+          BINDEX[3][it] = 1; /* Specified temperature*/
+        }
+        else {
+          var[QFLUXBC][IX(i,j,k)] = value;
+          BINDEX[3][it] = 0; /* Specified heat flux*/
+        }
+      }
+    } /* End of for(id=0; id<para->bc->nb_wall; id++)*/
+
+    if(para->outp->version==DEBUG) {
+      sprintf(msg, "assign_thermal_bc(): Updated %d of %d surfaces",
+              nb_dirty, para->bc->nb_wall);
+      ffd_log(msg, FFD_NORMAL);
+    }
   } /* End of if(para->bc->nb_wall>0)*/
   /****************************************************************************
   | No action since there is not a solid surface
@@ -726,12 +1117,15 @@ int assign_thermal_bc(PARA_DATA *para, REAL **var, int **BINDEX) {
                 sensibleHeat);
   ffd_log(msg, FFD_NORMAL);
 
-  FOR_EACH_CELL
-    if (var[FLAGP][IX(i,j,k)]==FLUID){
-       celVol = vol(para, var, i, j, k);
-       var[TEMPS][IX(i,j,k)] = sensibleHeat * celVol / para->geom->volFlu;
-    }
-  END_FOR
+  if(para->bc->assigned==0 || sensibleHeat!=para->bc->sensibleHeat) {
+    para->bc->sensibleHeat = sensibleHeat;
+    FOR_EACH_CELL
+      if (var[FLAGP][IX(i,j,k)]==FLUID){
+         celVol = vol(para, var, i, j, k);
+         var[TEMPS][IX(i,j,k)] = sensibleHeat * celVol / para->geom->volFlu;
+      }
+    END_FOR
+  }
 
   /****************************************************************************
   | Data received, but not used in current version
@@ -762,60 +1156,67 @@ int assign_thermal_bc(PARA_DATA *para, REAL **var, int **BINDEX) {
 		* @return 0 if no error occurred
 		*/
 int assign_port_bc(PARA_DATA *para, REAL **var, int **BINDEX) {
-  int i, j, k, id, it, Xid, Cid;
+  int i, j, k, id, it, n, Xid, Cid, dirty, nb_dirty = 0;
   int imax = para->geom->imax, jmax = para->geom->jmax;
   int kmax = para->geom->kmax;
   int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
+  REAL vel, T, value;
 
   ffd_log("assign_port_bc():", FFD_NORMAL);
 
-  /****************************************************************************
-  | Convert the data from Modelica to FFD for the Inlet
-  ****************************************************************************/
-  for(j=0; j<para->bc->nb_port; j++) {
-    i = para->bc->portId[j];
+  for(id=0; id<para->bc->nb_port; id++) {
+    /**************************************************************************
+    | Convert the data from Modelica to FFD for the Inlet
+    **************************************************************************/
+    i = para->bc->portId[id];
+    dirty = para->bc->assigned==0;
 
     /*-------------------------------------------------------------------------
     | Convert for mass flow rate and temperature
     -------------------------------------------------------------------------*/
-    para->bc->velPort[j] = para->cosim->modelica->mFloRatPor[i]
-                              / (para->prob->rho*para->bc->APort[j]);
-    para->bc->TPort[j] = para->cosim->modelica->TPor[i] - 273.15;
+    vel = para->cosim->modelica->mFloRatPor[i]
+        / (para->prob->rho*para->bc->APort[id]);
+    T = para->cosim->modelica->TPor[i] - 273.15;
+    if(vel!=para->bc->velPort[id] || T!=para->bc->TPort[id]) dirty = 1;
+    para->bc->velPort[id] = vel;
+    para->bc->TPort[id] = T;
     sprintf(msg, "\t%s: vel=%f[m/s], T=%f[degC]",
-          para->bc->portName[j], para->bc->velPort[j],
-          para->bc->TPort[j]);
+          para->bc->portName[id], para->bc->velPort[id],
+          para->bc->TPort[id]);
     ffd_log(msg, FFD_NORMAL);
     /*-------------------------------------------------------------------------
     | Convert nXi types of species
     -------------------------------------------------------------------------*/
     for(Xid=0; Xid<para->cosim->para->nXi; Xid++) {
-      para->bc->XiPort[j][Xid] = para->cosim->modelica->XiPor[i][Xid];
-      sprintf(msg, "\tXi[%d]=%f", Xid, para->bc->XiPort[j][Xid]);
+      value = para->cosim->modelica->XiPor[i][Xid];
+      if(value!=para->bc->XiPort[id][Xid]) dirty = 1;
+      para->bc->XiPort[id][Xid] = value;
+      sprintf(msg, "\tXi[%d]=%f", Xid, para->bc->XiPort[id][Xid]);
       ffd_log(msg, FFD_NORMAL);
     }
     /*-------------------------------------------------------------------------
     | Convert nC types of trace substances
     -------------------------------------------------------------------------*/
     for(Cid=0; Cid<para->cosim->para->nC; Cid++) {
-      para->bc->CPort[j][Cid] = para->cosim->modelica->CPor[i][Cid];
-      sprintf(msg, "\tC[%d]=%f", Cid, para->bc->CPort[j][Cid]);
+      value = para->cosim->modelica->CPor[i][Cid];
+      if(value!=para->bc->CPort[id][Cid]) dirty = 1;
+      para->bc->CPort[id][Cid] = value;
+      sprintf(msg, "\tC[%d]=%f", Cid, para->bc->CPort[id][Cid]);
       ffd_log(msg, FFD_NORMAL);
     }
-  }
 
-  /****************************************************************************
-  | Assign the BC
-  ****************************************************************************/
-  for(it=0; it<para->geom->index; it++) {
-    i = BINDEX[0][it];
-    j = BINDEX[1][it];
-    k = BINDEX[2][it];
-    id = BINDEX[4][it];
+    /**************************************************************************
+    | Assign the BC to the cells of the port if its data changed
+    **************************************************************************/
+    if(dirty==0) continue;
+    nb_dirty++;
+
+    for(n=para->bc->portCellStart[id]; n<para->bc->portCellStart[id+1]; n++) {
+      it = para->bc->portCell[n];
+      i = BINDEX[0][it];
+      j = BINDEX[1][it];
+      k = BINDEX[2][it];
 
-    /*-------------------------------------------------------------------------
-    | Only treat those inlet and outlet boundaries
-    -------------------------------------------------------------------------*/
-    if(var[FLAGP][IX(i,j,k)]==INLET || var[FLAGP][IX(i,j,k)]==OUTLET) {
       /* Set it to inlet if the flow velocity is positive or equal to 0*/
       if(para->bc->velPort[id]>=0) {
         var[FLAGP][IX(i,j,k)] = INLET;
@@ -845,7 +1246,23 @@ int assign_port_bc(PARA_DATA *para, REAL **var, int **BINDEX) {
       else
         var[FLAGP][IX(i,j,k)] = OUTLET;
     }
+  } /* End of for(id=0; id<para->bc->nb_port; id++)*/
+
+  if(para->outp->version==DEBUG) {
+    sprintf(msg, "assign_port_bc(): Updated %d of %d ports",
+            nb_dirty, para->bc->nb_port);
+    ffd_log(msg, FFD_NORMAL);
   }
+
+  /****************************************************************************
+  | Update the boundary faces if a port changed between inlet and outlet
+  ****************************************************************************/
+  if(nb_dirty>0 && update_boundary_face(para, var)!=0) {
+    ffd_log("assign_port_bc(): Could not update the boundary faces.",
+            FFD_ERROR);
+    return 1;
+  }
+
   return 0;
 } /* End of assign_inlet_outlet_bc()*/
 
@@ -861,6 +1278,13 @@ int assign_port_bc(PARA_DATA *para, REAL **var, int **BINDEX) {
 		*   - T:      sum(T*dA)
 		*   - Q_dot:  sum(q_dot*dA)
 		*
+		* The faces of each boundary are contiguous in the boundary face table,
+		* so the sum of each boundary is reduced in one pass over its faces.
+		* Wall cells without a fluid neighbor, such as the cells covered by an
+		* internal block, have no face. The temperature of a wall is therefore
+		* averaged over its faces and then scaled to the whole area
+		* para->bc->AWall, which is divided out again by the caller.
+		*
 		* @param para Pointer to FFD parameters
 		* @param var Pointer to FFD simulation variables
 		* @param BINDEX Pointer to the boundary index
@@ -870,9 +1294,12 @@ int assign_port_bc(PARA_DATA *para, REAL **var, int **BINDEX) {
 int surface_integrate(PARA_DATA *para, REAL **var, int **BINDEX) {
   int imax = para->geom->imax, jmax = para->geom->jmax;
   int kmax = para->geom->kmax;
-  int i, j, k, it, bcid;
+  int i, j, k, n, f, f0, f1, c, bcid;
   int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
-  REAL vel_tmp, A_tmp;
+  int *start = para->geom->face_start;
+  REAL sum_T, sum_vel, sum, sum_A;
+  REAL *psi = NULL;
+  BOUNDARY_FACE *face = para->geom->face;
 
   /****************************************************************************
   | Set the variable to 0
@@ -884,112 +1311,110 @@ int surface_integrate(PARA_DATA *para, REAL **var, int **BINDEX) {
   for(i=0; i<para->bc->nb_wall; i++)
     para->bc->temHeaAve[i] = 0;
 
+  /* Inlets keep 0 since their data is given by Modelica*/
   for(i=0; i<para->bc->nb_port; i++) {
     para->bc->TPortAve[i] = 0;
     para->bc->velPortAve[i] = 0;
-    for(j=0; j<para->bc->nb_Xi; j++)
-      para->bc->XiPortAve[i][j] = 0;
-    for(j=0; j<para->bc->nb_C; j++)
-      para->bc->CPortAve[i][j] = 0;
+    for(n=0; n<para->bc->nb_Xi; n++)
+      para->bc->XiPortAve[i][n] = 0;
+    for(n=0; n<para->bc->nb_C; n++)
+      para->bc->CPortAve[i][n] = 0;
   }
 
   /****************************************************************************
-  | Go through all the boundary cells
+  | Go through the faces of solid walls grouped by the wall ID
   ****************************************************************************/
   if(para->outp->version==DEBUG)
-    ffd_log("surface_integrate(): Start to sum all the cells", FFD_NORMAL);
-
-  for(it=0; it<para->geom->index; it++) {
-    i = BINDEX[0][it];
-    j = BINDEX[1][it];
-    k = BINDEX[2][it];
-    bcid = BINDEX[4][it];
-
-    if(i==0 || i==imax+1) {
-      vel_tmp = var[VX][IX(i,j,k)];
-      A_tmp = area_yz(para, var, i, j, k);
-    }
-    else if(j==0 || j==jmax+1) {
-      vel_tmp = var[VY][IX(i,j,k)];
-      A_tmp = area_zx(para, var, i, j, k);
-    }
-    else if(k==0 || k==kmax+1) {
-      vel_tmp = var[VZ][IX(i,j,k)];
-      A_tmp = area_xy(para, var, i, j, k);
-    }
-
-    /*-------------------------------------------------------------------------
-    | Set the thermal conditions data for Modelica.
-    | In FFD simulation, the BINDEX[3][it] indicates: 1->T, 0->Heat Flux.
-    | Those BINDEX[3][it] will be reset according to the Modelica data
-    | para->comsim->para->bouCon (1->Heat Flux, 2->T).
-    | Here is to give the Modelica the missing data (For instance, if Modelica
-    | send FFD Temperature, FFD should then send Modelica Heat Flux).
-    -------------------------------------------------------------------------*/
-    /*-------------------------------------------------------------------------
-    | Solid Wall
-    --------------------------------------------------------------------------*/
-    if(var[FLAGP][IX(i,j,k)]==SOLID) {
-      switch(BINDEX[3][it]) {
+    ffd_log("surface_integrate(): Start to sum the faces", FFD_NORMAL);
+
+  for(f0=start[SOLID]; f0<start[SOLID+1]; f0=f1) {
+    bcid = face[f0].id;
+    sum = 0;
+    sum_A = 0;
+
+    for(f1=f0; f1<start[SOLID+1] && face[f1].id==bcid; f1++) {
+      i = face[f1].i;
+      j = face[f1].j;
+      k = face[f1].k;
+      /* Internal blocks are not part of the walls seen by Modelica*/
+      if(i!=0 && i!=imax+1 && j!=0 && j!=jmax+1 && k!=0 && k!=kmax+1)
+        continue;
+
+      /*-----------------------------------------------------------------------
+      | Set the thermal conditions data for Modelica.
+      | In FFD simulation, the BINDEX[3][it] indicates: 1->T, 0->Heat Flux.
+      | Those BINDEX[3][it] will be reset according to the Modelica data
+      | para->comsim->para->bouCon (1->Heat Flux, 2->T).
+      | Here is to give the Modelica the missing data (For instance, if
+      | Modelica send FFD Temperature, FFD should then send Modelica Heat Flux).
+      -----------------------------------------------------------------------*/
+      switch(BINDEX[3][face[f1].it]) {
         /* FFD uses heat flux as BC to compute temperature*/
         /* Then send Modelica the temperature*/
         case 0:
-          para->bc->temHeaAve[bcid] += var[TEMP][IX(i,j,k)] * A_tmp;
+          psi = var[TEMP];
           break;
         /* FFD uses temperature as BC to compute heat flux*/
         /* Then send Modelica the heat flux*/
         case 1:
-          para->bc->temHeaAve[bcid] += var[QFLUX][IX(i,j,k)] * A_tmp;
-          /*sprintf(msg, "Cell(%d,%d,%d):\tQFLUX=%f,\tA=%f", i,j,k,var[QFLUX][IX(i,j,k)], A_tmp);*/
-          /*ffd_log(msg, FFD_NORMAL);*/
+          psi = var[QFLUX];
           break;
         default:
-          sprintf(msg, "average_bc_area(): Thermal boundary (%d)"
+          sprintf(msg, "surface_integrate(): Thermal boundary (%d)"
                  "for cell (%d,%d,%d) was not defined",
-                 BINDEX[3][it], i, j, k);
+                 BINDEX[3][face[f1].it], i, j, k);
           ffd_log(msg, FFD_ERROR);
           return 1;
       }
+      sum += psi[IX(i,j,k)] * face[f1].area;
+      sum_A += face[f1].area;
     }
-    /*-------------------------------------------------------------------------
-    | Outlet
-    -------------------------------------------------------------------------*/
-    else if(var[FLAGP][IX(i,j,k)]==OUTLET) {
-      if(para->outp->version==DEBUG) {
-        sprintf(msg, "surface_integrate(): Set the outlet[%d, %d, %d]",
-                i, j, k);
-        ffd_log(msg, FFD_NORMAL);
-      }
 
-      para->bc->TPortAve[bcid] += var[TEMP][IX(i,j,k)] * A_tmp;
-      para->bc->velPortAve[bcid] += vel_tmp * A_tmp;
-      for(j=0; j<para->bc->nb_Xi; j++)
-        para->bc->XiPortAve[bcid][j] += var[Xi1+j][IX(i,j,k)] * A_tmp;
+    /* Mean temperature of the faces times the area of the wall*/
+    if(psi==var[TEMP] && sum_A>0)
+      sum *= para->bc->AWall[bcid] / sum_A;
 
-      for(j=0; j<para->bc->nb_C; j++)
-        para->bc->CPortAve[bcid][j] += var[C1+j][IX(i,j,k)] * A_tmp;
+    para->bc->temHeaAve[bcid] = sum;
+  } /* End of for(f0=start[SOLID]; f0<start[SOLID+1]; f0=f1)*/
 
+  /****************************************************************************
+  | Go through the faces of outlets grouped by the port ID
+  ****************************************************************************/
+  for(f0=start[OUTLET]; f0<start[OUTLET+1]; f0=f1) {
+    bcid = face[f0].id;
+    sum_T = 0;
+    sum_vel = 0;
+
+    for(f1=f0; f1<start[OUTLET+1] && face[f1].id==bcid; f1++) {
+      c = IX(face[f1].i,face[f1].j,face[f1].k);
+      sum_T += var[TEMP][c] * face[f1].area;
+      sum_vel += face_outflow(para, var, &face[f1]);
+    }
+    para->bc->TPortAve[bcid] = sum_T;
+    para->bc->velPortAve[bcid] = sum_vel;
+
+    for(n=0; n<para->bc->nb_Xi; n++) {
+      sum = 0;
+      for(f=f0; f<f1; f++)
+        sum += var[Xi1+n][IX(face[f].i,face[f].j,face[f].k)]
+             * face_outflow(para, var, &face[f]);
+      para->bc->XiPortAve[bcid][n] = sum;
     }
-    /*-------------------------------------------------------------------------
-    | Inlet
-    -------------------------------------------------------------------------*/
-    else if(var[FLAGP][IX(i,j,k)]==INLET) {
-      if(para->outp->version==DEBUG) {
-        sprintf(msg, "surface_integrate(): Set 0 for inlet [%d,%d,%d].",
-                i, j, k);
-        ffd_log(msg, FFD_NORMAL);
-      }
-
-      para->bc->TPortAve[bcid] = 0;
-      para->bc->velPortAve[bcid] = 0;
-      for(j=0; j<para->bc->nb_Xi; j++)
-        para->bc->XiPortAve[bcid][j] = 0;
 
-      for(j=0; j<para->bc->nb_C; j++)
-        para->bc->CPortAve[bcid][j] = 0;
+    for(n=0; n<para->bc->nb_C; n++) {
+      sum = 0;
+      for(f=f0; f<f1; f++)
+        sum += var[C1+n][IX(face[f].i,face[f].j,face[f].k)]
+             * face_outflow(para, var, &face[f]);
+      para->bc->CPortAve[bcid][n] = sum;
     }
 
-  } /* End of for(it=0; it<para->geom->index; it++)*/
+    if(para->outp->version==DEBUG) {
+      sprintf(msg, "surface_integrate(): Set the outlet %d with %d faces",
+              bcid, f1-f0);
+      ffd_log(msg, FFD_NORMAL);
+    }
+  } /* End of for(f0=start[OUTLET]; f0<start[OUTLET+1]; f0=f1)*/
 
   return 0;
 } /* End of surface_integrate()*/
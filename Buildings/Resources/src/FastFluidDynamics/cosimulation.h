@@ -33,9 +33,35 @@
 #include "geometry.h"
 #endif
 
+#ifndef _BOUNDARY_H
+#define _BOUNDARY_H
+#include "boundary.h"
+#endif
+
+#ifndef _FFD_DLL_H
+#define _FFD_DLL_H
+#include "ffd_dll.h"
+#endif
+
+#ifndef _SNAPSHOT_H
+#define _SNAPSHOT_H
+#include "snapshot.h"
+#endif
+
 #ifndef _MSC_VER /*Linux*/
 #define Sleep(x) sleep(x/1000)
 #endif
+
+/* Quantities of the cosimulation messages compared for skipping windows*/
+#define MEMO_T 0 /* Temperature*/
+#define MEMO_Q 1 /* Heat flow rate*/
+#define MEMO_SIGNAL 2 /* Control signal of the shades*/
+#define MEMO_P 3 /* Pressure*/
+#define MEMO_M 4 /* Mass flow rate*/
+#define MEMO_XI 5 /* Mass fraction of the species*/
+#define MEMO_C 6 /* Trace substance*/
+#define MEMO_NB_QUANTITY 7 /* Number of quantities above*/
+#define MEMO_SENSOR 7 /* Sensor, compared with its own magnitude*/
 /*
 	* Read the coupled simulation parameters defined by Modelica
 	*
@@ -68,6 +94,35 @@ int write_cosim_data(PARA_DATA *para, REAL **var);
 	*/
 int read_cosim_data(PARA_DATA *para, REAL **var, int **BINDEX);
 
+/*
+	* Send the outputs of the last computed window again for a skipped window
+	*
+	* @param para Pointer to FFD parameters
+	*
+	* @return 0 if no error occurred
+	*/
+int write_cosim_memo(PARA_DATA *para);
+
+/*
+	* Compare the message from Modelica with the one of the last computed window
+	*
+	* @param para Pointer to FFD parameters
+	* @param slot Pointer to the message from Modelica
+	*
+	* @return 0 if no error occurred
+	*/
+int check_cosim_memo_input(PARA_DATA *para, REAL *slot);
+
+/*
+	* Store the message to Modelica and check if the outputs are steady
+	*
+	* @param para Pointer to FFD parameters
+	* @param slot Pointer to the message to Modelica
+	*
+	* @return 0 if no error occurred
+	*/
+int store_cosim_memo_output(PARA_DATA *para, REAL *slot);
+
 /*
 * Compare the names of boundaries and store the relationship
 *
@@ -88,6 +143,17 @@ int compare_boundary_names(PARA_DATA *para);
 	*/
 int compare_boundary_area(PARA_DATA *para, REAL **var, int **BINDEX);
 
+/*
+	* Group the boundary cells by the wall or the port they belong to
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to the FFD simulation variables
+	* @param BINDEX Pointer to boundary index
+	*
+	* @return 0 if no error occurred
+	*/
+int map_boundary_cells(PARA_DATA *para, REAL **var, int **BINDEX);
+
 /*
 	* Assign the Modelica solid surface thermal boundary condition data to FFD
 	*
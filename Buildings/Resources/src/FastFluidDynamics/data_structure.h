@@ -21,6 +21,7 @@
 #include <windows.h>
 #else
 #include <unistd.h>
+#include <pthread.h>
 #endif
 
 #include <stdio.h>
@@ -70,6 +71,9 @@ Place the stdlib.h line above the glut.h line in the code.
 
 #define PI 3.1415926
 
+#define GS_ITERATION 20 /* Sweeps of the Gauss-Seidel solver*/
+#define GS_P_ITERATION 5 /* Sweeps of the Gauss-Seidel solver for pressure*/
+
 #define X     0
 #define Y     1
 #define Z     2
@@ -125,7 +129,9 @@ Place the stdlib.h line above the glut.h line in the code.
 #define C1S 52
 #define C2S 53
 #define C1BC 54
-#define C2BC 55  /* Last variable*/
+#define C2BC 55
+#define DIST 56 /* Distance from the cell center to the nearest wall*/
+#define NUT  57 /* Turbulent viscosity (last variable)*/
 
 typedef enum{NOSLIP, SLIP, INFLOW, OUTFLOW, PERIODIC, SYMMETRY} BCTYPE;
 
@@ -144,14 +150,32 @@ typedef enum{LAM, CHEN, CONSTANT} TUR_MODEL;
 
 typedef enum{BILINEAR, FSJ, HYBRID} INTERPOLATION;
 
+typedef enum{UNIFORM, FLOW_WEIGHTED} MASS_CORRECTION;
+
 typedef enum{DEMO, DEBUG, RUN} VERSION;
 
-typedef enum{FFD, SCI, TECPLOT} FILE_FORMAT;
+typedef enum{FFD, SCI, TECPLOT, VTK, SERIES} FILE_FORMAT;
 
-typedef enum{FFD_WARNING, FFD_ERROR, FFD_NORMAL, FFD_NEW} FFD_MSG_TYPE;
+typedef enum{FFD_WARNING, FFD_ERROR, FFD_NORMAL, FFD_NEW, FFD_PROGRESS} FFD_MSG_TYPE;
 
 typedef enum{XY, YZ, ZX} PLANETYPE;
 
+typedef enum{BOX, SLICE, SURFACE, PROBE} SELECTOR_TYPE;
+
+/* Face between a boundary cell and its neighbor cell in the domain*/
+typedef struct {
+  int i; /* I-index of the boundary cell*/
+  int j; /* J-index of the boundary cell*/
+  int k; /* K-index of the boundary cell*/
+  int it; /* Position of the boundary cell in BINDEX*/
+  int dir; /* Direction of the neighbor: 0:i-1, 1:i+1, 2:j-1, 3:j+1, 4:k-1, 5:k+1*/
+  int nb; /* Offset of the neighbor: IX(i,j,k)+nb*/
+  int vel; /* Offset of the normal velocity on the face: IX(i,j,k)+vel*/
+  int type; /* Boundary type: INLET, SOLID or OUTLET*/
+  int id; /* Boundary ID to identify which boundary it belongs to*/
+  REAL area; /* Area of the face*/
+} BOUNDARY_FACE;
+
 /* Parameter for geometry and mesh*/
 typedef struct {
   REAL  Lx; /* Domain size in x-direction (meter)*/
@@ -168,8 +192,23 @@ typedef struct {
   REAL  dz; /* Length delta_z of one cell in z-direction for uniform grid only*/
   REAL  volFlu; /* Total volume of fluid cells*/
   int   uniform; /* Only for generating grid by FFD. 1: uniform grid; 0: non-uniform grid*/
+  BOUNDARY_FACE *face; /* Boundary faces sorted by boundary type and ID*/
+  int   nb_face; /* Total number of boundary faces*/
+  int   face_start[4]; /* Faces of type t are from face_start[t] to face_start[t+1]-1*/
+  int   cached; /* 1: Cells and boundaries were loaded from the geometry cache*/
 } GEOM_DATA;
 
+#define MAX_SELECTOR 20 /* Maximum number of output selectors*/
+
+/* Part of the domain written to the result files*/
+typedef struct {
+  SELECTOR_TYPE type; /* BOX, SLICE, SURFACE or PROBE*/
+  PLANETYPE plane; /* Plane of a slice*/
+  REAL p0[3]; /* Corner of a box, point on a slice or start of a probe line*/
+  REAL p1[3]; /* Opposite corner of a box or end of a probe line*/
+  int nb_point; /* Number of points of a probe line*/
+}OUTPUT_SELECTOR;
+
 /* Parameter for the data output control*/
 typedef struct{
   int cal_mean; /* 1: Calculate mean value; 0: False*/
@@ -194,14 +233,36 @@ typedef struct{
   VERSION version; /* DEMO, DEBUG, RUN*/
   int screen; /* Screen for display: 1 velocity; 2: temperature; 3: contaminant*/
   int tstep_display; /* Number of time steps to update the visualization*/
+  int log_level; /* 0: errors only; 1: normal messages; 2: progress of every time step*/
+  FILE_FORMAT format; /* Format of the result files: TECPLOT or VTK*/
+  int nb_field; /* Number of fields selected for the result files; 0: default fields*/
+  OUTPUT_SELECTOR selector[MAX_SELECTOR]; /* Parts of the domain written to the result files*/
+  int nb_selector; /* Number of selectors; 0: whole domain*/
+  int checkpoint_step; /* Number of time steps between two checkpoints; 0: no checkpoint*/
+  int movie_step; /* Number of time steps between two frames of the animation*/
+  int movie_buffer; /* Number of frames buffered for the writer thread*/
+  FILE_FORMAT movie_format; /* Format of the animation: VTK files or a SERIES file*/
+  REAL movie_tolerance; /* Maximum error of the values in a SERIES file; 0: lossless*/
+  int field[NUT+1]; /* field[n]: Variable of the nth selected field*/
 } OUTP_DATA;
 
+/* Text file mapped into memory*/
+typedef struct {
+  const char *data; /* Content of the file; NULL if no file is mapped*/
+  size_t size; /* Number of bytes of the file*/
+  size_t pos; /* Position of the next character to read*/
+}TEXT_DATA;
+
 typedef struct{
   FILE_FORMAT parameter_file_format; /* Format of extra parameter file*/
   char parameter_file_name[1024]; /* Name of extra parameter file*/
   char block_file_name[1024]; /* Name of file stores block information*/
   int read_old_ffd_file; /* 1: Read previous FFD file; 0: False*/
   char old_ffd_file_name[100]; /* Name of previous FFD simulation data file*/
+  TEXT_DATA sci; /* Internal: SCI file from read_sci_max() to read_sci_input()*/
+  char geometry_cache[1024]; /* Directory of the geometry cache; empty: no cache*/
+  char geometry_file[1024+64]; /* Internal: geometry_cache, SHA1 in hex and .geo*/
+  unsigned char geometry_digest[20]; /* Internal: SHA1 of the SCI file and the block file*/
 } INPU_DATA;
 
 typedef struct{
@@ -267,6 +328,12 @@ typedef struct {
   REAL **CPort; /* CPor[nb_port][nb_C]: the trace substances of the inflowing medium*/
   REAL **CPortAve; /* CPortAve[nb_port][nb_C]: Surface averaged value of CPort*/
   REAL **CPortMean; /* CPortMean[nb_port][nb_C]: Time averaged value of CPort*/
+  int *wallCell; /* Positions in BINDEX of the solid boundary cells grouped by wall*/
+  int *wallCellStart; /* wallCellStart[nb_wall+1]: Cells of wall i start at wallCell[wallCellStart[i]]*/
+  int *portCell; /* Positions in BINDEX of the inlet and outlet cells grouped by port*/
+  int *portCellStart; /* portCellStart[nb_port+1]: Cells of port i start at portCell[portCellStart[i]]*/
+  REAL sensibleHeat; /* Convective sensible heat assigned to the fluid cells*/
+  int assigned; /* 1: temHea, sensibleHeat and the port data are assigned to var; 0: assign all*/
 }BC_DATA;
 
 typedef struct {
@@ -279,6 +346,16 @@ typedef struct {
   REAL TRooMean; /* Time averaged value of TRoo;*/
 } SENSOR_DATA;
 
+/* Wall clock time in seconds of the phases of the start*/
+typedef struct {
+  double parameter; /* Reading the parameter file*/
+  double sci; /* Reading the SCI file*/
+  double block; /* Reading the file of the blocks*/
+  double geometry; /* Marking the cells and building the tables of the boundaries*/
+  double warm_start; /* Solving on the coarse grid for the initial values*/
+  double exchange; /* Initial data exchange with Modelica and the first time step*/
+}STARTUP_DATA;
+
 typedef struct {
   double dt; /* FFD simulation time step size*/
   double t; /* Internal: current time*/
@@ -286,8 +363,16 @@ typedef struct {
   int step_total; /* The interval of iteration step to output data*/
   int step_current; /* Internal: current iteration step*/
   int step_mean; /* Internal: steps for time average*/
+  REAL w_mean; /* Internal: sum of the weights of the steps for time average*/
+  double dt_min; /* Minimum time step size of the adaptive time step; 0: no limit*/
+  double dt_max; /* Maximum time step size of the adaptive time step; 0: no limit*/
+  double dt_free; /* Internal: last adaptive time step before it was shortened for the synchronization point; 0: none*/
+  int steady_window; /* Single simulation: time steps of a window for detecting the steady state; 0: no detection*/
+  REAL steady_tolerance; /* Relative change between two windows at which the flow is steady*/
+  int steady_stop; /* 1: End once the steady flow was averaged for a window; 0: run all the steps*/
   double t_start; /* Internal: clock time when simulation starts*/
   double t_end; /* Internal: clock time when simulation ends*/
+  STARTUP_DATA startup; /* Internal: wall clock time of the phases of the start*/
 }TIME_DATA;
 
 typedef struct {
@@ -296,6 +381,15 @@ typedef struct {
   ADVECTION advection_solver; /* Type of advection solver: SEMI, LAX, UPWIND, UPWIND_NEW*/
   INTERPOLATION interpolation; /* Interpolation in semi-Lagrangian method: BILINEAR, FSJ, HYBRID*/
   int cosimulation;  /* 0: single; 1: coupled simulation*/
+  MASS_CORRECTION mass_correction; /* Distribution of mass correction on outlets: UNIFORM, FLOW_WEIGHTED*/
+  REAL memo_tolerance; /* Cosimulation: skip the windows whose inputs and outputs change less relative to their values; 0: never skip*/
+  int snapshot; /* Cosimulation: number of states kept for stepping back; 0: none*/
+  REAL cfl; /* Cosimulation: maximum CFL number of the adaptive time step; 0: fixed time step*/
+  REAL diffusion_number; /* Cosimulation: maximum diffusion number of the adaptive time step; 0: no limit*/
+  REAL real_time; /* Cosimulation: ratio of physical time to wall clock time required for each window; 0: no deadline*/
+  int min_iteration; /* Real time: fewest sweeps of the Gauss-Seidel solver*/
+  int min_iteration_p; /* Real time: fewest sweeps of the Gauss-Seidel solver for pressure*/
+  int max_scalar_interval; /* Real time: most time steps between two updates of temperature and species*/
   int nextstep; /* Internal: 1: yes; 0: no, wait*/
 }SOLV_DATA;
 
@@ -304,8 +398,136 @@ typedef struct {
   REAL u; /* Initial velocity for u*/
   REAL v; /* Initial velocity for v*/
   REAL w; /* Initial velocity for w*/
+  int coarse_step; /* Most time steps on the coarse grid of the warm start; 0: no warm start*/
+  int coarse_ratio; /* Number of cells merged into one coarse cell in each direction*/
+  REAL coarse_tolerance; /* Relative change in a time step at which the coarse grid is steady*/
 }INIT_DATA;
 
+typedef struct {
+  int step; /* Time step on which the cache was built; -1: not built*/
+  int nb_face; /* Number of boundary faces*/
+  REAL *h; /* h[f]: Convective heat transfer coefficient on boundary face f*/
+}COEF_CACHE;
+
+typedef struct {
+  REAL *input; /* input[size]: Message from Modelica of the last computed window*/
+  REAL *output; /* output[size]: Last message to Modelica*/
+  int nb_window; /* Number of computed windows with the same input*/
+  int steady; /* 1: The outputs of the last two windows were the same*/
+  int skip; /* 1: Skip the next window and send the last output again*/
+  int nb_skip; /* Number of skipped windows*/
+}MEMO_DATA;
+
+typedef struct {
+  REAL t; /* Time of the state*/
+  int step; /* Time step of the state*/
+  size_t size; /* Number of bytes of the compressed variables*/
+  size_t capacity; /* Number of bytes allocated for buf*/
+  unsigned char *buf; /* Compressed variables*/
+}SNAPSHOT;
+
+typedef struct {
+  SNAPSHOT *slot; /* slot[nb]: Ring of the states at the synchronization points*/
+  int nb; /* Number of slots*/
+  int head; /* Number of states taken*/
+  int tail; /* Number of states dropped*/
+  unsigned char *tmp; /* Buffer for compressing a state*/
+  int restored; /* 1: The last read of the Modelica data restored a state*/
+  int nb_restore; /* Number of restored states*/
+}SNAP_DATA;
+
+typedef struct {
+  double t_start; /* Wall clock time when FFD started to compute the window*/
+  int it; /* Sweeps of the Gauss-Seidel solver*/
+  int it_p; /* Sweeps of the Gauss-Seidel solver for pressure*/
+  int scalar_interval; /* Time steps between two updates of temperature and species*/
+  int scalar_step; /* Time steps since the last update of temperature and species*/
+  double scalar_dt; /* Time since the last update of temperature and species*/
+  int nb_miss; /* Number of windows that missed the deadline*/
+}REAL_TIME_DATA;
+
+typedef struct {
+  REAL *u[3]; /* u[d][size]: Velocity at the start of the window*/
+  int nb; /* Time steps in the current window*/
+  int nb_window; /* Number of finished windows*/
+  int nb_steady; /* Number of consecutive steady windows*/
+  REAL TRoo; /* Sum of the room temperature in the current window*/
+  REAL vel; /* Sum of the velocity at the center of the room in the current window*/
+  REAL res; /* Sum of the residual of the pressure in the current window*/
+  REAL TRooLast; /* Mean room temperature of the last window*/
+  REAL velLast; /* Mean velocity at the center of the room of the last window*/
+  REAL resLast; /* Mean residual of the pressure of the last window*/
+  REAL residual; /* Residual of the pressure in the last time step*/
+  int stop; /* 1: The steady flow was averaged and the run can end*/
+}STEADY_DATA;
+
+#define SERIES_KEY_INTERVAL 16 /* Frames between two key frames of a time series*/
+
+typedef struct {
+  REAL t; /* Time of the frame*/
+  int step; /* Time step of the frame*/
+  int key; /* 1: Key frame coded without the previous frame*/
+  unsigned long offset; /* Position of the frame in the file*/
+}SERIES_ENTRY;
+
+typedef struct {
+  FILE *file; /* Handle of the file, kept open until the series is closed*/
+  REAL tolerance; /* Maximum error of the values; 0: lossless*/
+  int size; /* Number of values of a field*/
+  int nb_field; /* Number of fields of a frame*/
+  REAL *prev; /* prev[nb_field*size]: Fields of the previous frame as they are read back*/
+  unsigned char *plane; /* plane[8*size]: Bytes of a field grouped by their position in the values*/
+  unsigned char *buf; /* Buffer for a coded group of bytes*/
+  REAL *esc; /* esc[size]: Values of a field that are kept without quantization*/
+  SERIES_ENTRY *index; /* index[capacity]: Frames written*/
+  int nb_frame; /* Number of frames written*/
+  int capacity; /* Number of frames allocated for the index*/
+  unsigned long offset; /* Number of bytes written*/
+}SERIES_DATA;
+
+typedef struct FFD_SYNC_TAG {
+#ifdef _MSC_VER
+  CRITICAL_SECTION mutex;
+  CONDITION_VARIABLE cond;
+#else
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+#endif
+  int count; /* Number of flag changes, to wait for any change*/
+  int shared; /* 1: in memory shared by processes, no condition variable*/
+  struct FFD_SYNC_TAG *peer; /* Also woken up on the changes, NULL if none*/
+}FFD_SYNC; /* Mutex and condition variable protecting the flags*/
+
+#define MOVIE_WAIT_TIMEOUT 1000 /* Maximum milliseconds of a wait for the other thread*/
+
+typedef struct {
+  REAL *data; /* data[nb_field*size]: Copies of the fields*/
+  REAL t; /* Time of the frame*/
+  int step; /* Time step of the frame*/
+}MOVIE_FRAME;
+
+typedef struct {
+  MOVIE_FRAME *frame; /* frame[nb]: Pool of the frames to be written*/
+  int nb; /* Number of frames in the pool*/
+  unsigned long head; /* Number of frames copied by the FFD thread*/
+  unsigned long tail; /* Number of frames written by the writer thread*/
+  int stop; /* 1: The writer thread writes the rest of the pool and ends*/
+  int nb_fail; /* Number of frames that could not be written*/
+  FFD_SYNC sync; /* Protects head, tail, stop and nb_fail and wakes up the threads*/
+  int async; /* 1: A writer thread writes the frames; 0: write them directly*/
+  int field[NUT+1]; /* field[n]: Variable of the nth field of a frame*/
+  int nb_field; /* Number of fields of a frame*/
+  char name[30]; /* Name of the frame files without the time step*/
+  REAL **var; /* Simulation variables for the coordinates of the grid*/
+  int nb_wait; /* Number of frames that waited for a free buffer*/
+  SERIES_DATA series; /* Time series if the format is SERIES*/
+#ifdef _MSC_VER
+  HANDLE thread;
+#else
+  pthread_t thread;
+#endif
+}MOVIE_DATA;
+
 typedef struct {
   GEOM_DATA  *geom;
   INPU_DATA  *inpu;
@@ -317,8 +539,35 @@ typedef struct {
   CosimulationData *cosim;
   SENSOR_DATA *sens;
   INIT_DATA *init;
+  COEF_CACHE *cache;
+  MEMO_DATA *memo;
+  SNAP_DATA *snap;
+  REAL_TIME_DATA *rt;
+  MOVIE_DATA *movie;
+  STEADY_DATA *steady;
 }PARA_DATA;
 
+typedef struct {
+  PARA_DATA para; /* Parameters pointing to the data below*/
+  GEOM_DATA geom;
+  PROB_DATA prob;
+  TIME_DATA mytime;
+  INPU_DATA inpu;
+  OUTP_DATA outp;
+  BC_DATA bc;
+  SOLV_DATA solv;
+  SENSOR_DATA sens;
+  INIT_DATA init;
+  COEF_CACHE cache;
+  MEMO_DATA memo;
+  SNAP_DATA snap;
+  REAL_TIME_DATA rt;
+  MOVIE_DATA movie;
+  STEADY_DATA steady;
+  REAL **var; /* Simulation variables*/
+  int **BINDEX; /* Boundary index*/
+}FFD_CONTEXT; /* Storage of one FFD simulation (one room)*/
+
 typedef struct {
   double number0;
   double number1;
@@ -339,4 +588,41 @@ typedef struct {
   int feedback;
 }ReceivedCommand;
 
-char msg[1000];
+/* Every FFD instance runs in its own thread*/
+#ifdef _MSC_VER
+#define FFD_THREAD_LOCAL __declspec(thread)
+#else
+#define FFD_THREAD_LOCAL __thread
+#endif
+
+/* Order the memory accesses of the threads sharing a queue*/
+#ifdef _MSC_VER
+#define FFD_BARRIER() MemoryBarrier()
+#else
+#define FFD_BARRIER() __sync_synchronize()
+#endif
+
+/* Buffer for the messages of the current thread*/
+extern FFD_THREAD_LOCAL char msg[1000];
+
+#define LOG_BUFFER 65536 /* Bytes of the queue of a log file*/
+#define LOG_FLUSH_INTERVAL 20 /* Milliseconds between two writes of the queue*/
+#define LOG_PROGRESS_INTERVAL 1.0 /* Seconds between two progress messages at log level 1*/
+
+typedef struct {
+  char name[30]; /* Name of the log file*/
+  FILE *file; /* Handle of the log file, kept open until the log is closed*/
+  char *buf; /* buf[LOG_BUFFER]: Queue of the text to be written*/
+  volatile unsigned long head; /* Number of bytes queued by the FFD thread*/
+  volatile unsigned long tail; /* Number of bytes written by the flush thread*/
+  volatile int stop; /* 1: The flush thread writes the rest of the queue and ends*/
+  int async; /* 1: A flush thread writes the queue; 0: write to the file directly*/
+  int level; /* 0: errors only; 1: normal messages; 2: progress of every time step*/
+  double t_progress; /* Wall clock time of the last progress message*/
+#ifdef _MSC_VER
+  HANDLE thread;
+#else
+  pthread_t thread;
+#endif
+}LOG_DATA;
+
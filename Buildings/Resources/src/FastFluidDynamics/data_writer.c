@@ -19,6 +19,46 @@
 
 #include "data_writer.h"
 
+/* Names of the variables in the VTK files*/
+static const char *field_name[NUT+1] = {"X", "Y", "Z", "U", "V", "W",
+  "UM", "VM", "WM", "US", "VS", "WS", "P", "QFLUXBC", "QFLUX", "TMP1", "TMP2",
+  "TMP3", "T", "TS", "TM", "AP", "AN", "AS", "AW", "AE", "AF", "AB", "B", "GX",
+  "GY", "GZ", "AP0", "PP", "FLAGP", "FLAGU", "FLAGV", "FLAGW", "LOCMIN",
+  "LOCMAX", "VXBC", "VYBC", "VZBC", "TEMPBC", "Xi1", "Xi2", "Xi1S", "Xi2S",
+  "Xi1BC", "Xi2BC", "C1", "C2", "C1S", "C2S", "C1BC", "C2BC", "DIST", "NUT"};
+
+/* Default variables of the result files in VTK format*/
+static const int result_field[] = {VX, VY, VZ, TEMP, Xi1, FLAGP, IP};
+static const int unsteady_field[] = {VX, VY, VZ, TEMP, Xi1, IP};
+#define NB_FIELD(f) ((int) (sizeof(f)/sizeof(f[0])))
+
+/*
+	* Write a result file in the binary VTK format
+	*
+	* The variables selected by outp.fields replace the default ones. If
+	* output selectors are defined, only the selected parts are written.
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	* @param name Pointer to the filename without extension
+	* @param field Pointer to the IDs of the default variables
+	* @param nb_field Number of the default variables
+	*
+	* @return 0 if no error occurred
+	*/
+static int write_vtk_result(PARA_DATA *para, REAL **var, char *name,
+                            const int *field, int nb_field) {
+  if(para->outp->nb_field>0) {
+    field = para->outp->field;
+    nb_field = para->outp->nb_field;
+  }
+
+  if(para->outp->nb_selector>0)
+    return write_selected_data(para, var, name, field, nb_field);
+  else
+    return write_vtk_data(para, var, name, field, nb_field);
+} /* End of write_vtk_result()*/
+
 /*
 	* Write standard output data in a format for tecplot
 	*
@@ -40,6 +80,13 @@ int write_tecplot_data(PARA_DATA *para, REAL **var, char *name) {
   char *filename;
   FILE *datafile;
 
+  /* The selected parts of the domain are always written in VTK format*/
+  if(para->outp->format==VTK || para->outp->nb_selector>0) {
+    convert_to_tecplot(para, var);
+    return write_vtk_result(para, var, name, result_field,
+                            NB_FIELD(result_field));
+  }
+
   /****************************************************************************
   | Allocate memory for filename
   | Length of filename should be sizeof(ActualName) + 1
@@ -107,6 +154,14 @@ int write_tecplot_all_data(PARA_DATA *para, REAL **var, char *name) {
   REAL *x = var[X], *y = var[Y], *z =var[Z];
   char *filename;
   FILE *dataFile;
+  int field[NUT+1], n;
+
+  /* Write every variable except the coordinates of the grid*/
+  if(para->outp->format==VTK) {
+    convert_to_tecplot(para, var);
+    for(n=0; n<NUT+1-VX; n++) field[n] = VX + n;
+    return write_vtk_data(para, var, name, field, n);
+  }
 
   /****************************************************************************
   | Allocate memory for filename
@@ -329,6 +384,10 @@ int write_unsteady(PARA_DATA *para, REAL **var, char *name){
   char *filename;
   FILE *datafile;
 
+  if(para->outp->format==VTK || para->outp->nb_selector>0)
+    return write_vtk_result(para, var, name, unsteady_field,
+                            NB_FIELD(unsteady_field));
+
   /****************************************************************************
   | Allocate memory for filename
   | Length of filename should be sizeof(ActualName) + 1
@@ -568,3 +627,520 @@ int write_SCI(PARA_DATA *para, REAL **var, char *name) {
   return 0;
 
 } /* End of write_SCI()*/
+
+	/*
+		* Write a block of the appended data of a VTK file
+		*
+		* The block starts with its size in bytes as UInt64 in the byte order
+		* of the host.
+		*
+		* @param datafile Pointer to the file
+		* @param data Pointer to the data
+		* @param size Size of the data in bytes
+		*
+		* @return 0 if no error occurred
+		*/
+static int write_vtk_block(FILE *datafile, const void *data,
+                           unsigned long size) {
+  unsigned char head[8];
+  unsigned int one = 1;
+  unsigned long n = size;
+  int b;
+
+  for(b=0; b<8; b++) {
+    /* Least significant byte first on a little-endian host*/
+    head[*(unsigned char *) &one==1 ? b : 7-b] = (unsigned char) (n%256);
+    n /= 256;
+  }
+
+  if(fwrite(head, 1, 8, datafile)!=8) return 1;
+  if(fwrite(data, 1, size, datafile)!=size) return 1;
+  return 0;
+} /* End of write_vtk_block()*/
+
+	/*
+		* Write the beginning of a VTK file
+		*
+		* @param datafile Pointer to the file
+		* @param type Type of the data set
+		* @param extent Attributes of the data set
+		* @param t Time of the data
+		*
+		* @return No return needed
+		*/
+static void write_vtk_header(FILE *datafile, const char *type,
+                             const char *extent, REAL t) {
+  unsigned int one = 1;
+
+  fprintf(datafile, "<?xml version=\"1.0\"?>\n");
+  fprintf(datafile, "<VTKFile type=\"%s\" version=\"1.0\" "
+          "byte_order=\"%s\" header_type=\"UInt64\">\n", type,
+          *(unsigned char *) &one==1 ? "LittleEndian" : "BigEndian");
+  fprintf(datafile, "<%s%s>\n", type, extent);
+  fprintf(datafile, "<FieldData>\n<DataArray type=\"Float64\" Name=\"TIME\" "
+          "NumberOfTuples=\"1\" format=\"ascii\">%.17g</DataArray>\n"
+          "</FieldData>\n", t);
+} /* End of write_vtk_header()*/
+
+	/*
+		* Write the descriptions of the fields of a VTK file
+		*
+		* @param datafile Pointer to the file
+		* @param field Pointer to the IDs of the variables of the fields
+		* @param nb_field Number of the fields
+		* @param size Size of a field in bytes
+		*
+		* @return Offset of the appended data after the fields
+		*/
+static unsigned long write_vtk_fields(FILE *datafile, const int *field,
+                                      int nb_field, unsigned long size) {
+  unsigned long offset = 0;
+  int n;
+
+  fprintf(datafile, "<PointData>\n");
+  for(n=0; n<nb_field; n++) {
+    fprintf(datafile, "<DataArray type=\"Float64\" Name=\"%s\" "
+            "format=\"appended\" offset=\"%lu\"/>\n",
+            field_name[field[n]], offset);
+    offset += 8 + size;
+  }
+  fprintf(datafile, "</PointData>\n");
+
+  return offset;
+} /* End of write_vtk_fields()*/
+
+	/*
+		* Write fields on a box of the grid in the binary VTK format
+		*
+		* The file is a VTK XML rectilinear grid with the points of the cells
+		* from lo to hi. Each field is stored as raw binary data in the order of
+		* IX(i,j,k), which is the order of the points of VTK. Nothing is written
+		* to the log.
+		*
+		* @param para Pointer to FFD parameters
+		* @param var Pointer to FFD simulation variables for the coordinates
+		* @param psi Pointer to the fields on the box
+		* @param field Pointer to the IDs of the variables of the fields
+		* @param nb_field Number of the fields
+		* @param t Time of the fields
+		* @param filename Pointer to the name of the file
+		* @param lo Lowest indices i, j and k of the box
+		* @param hi Highest indices i, j and k of the box
+		*
+		* @return 0 if no error occurred
+		*/
+static int write_vtk_box(PARA_DATA *para, REAL **var, REAL **psi,
+                         const int *field, int nb_field, REAL t,
+                         char *filename, const int *lo, const int *hi) {
+  int j, k, n, flag;
+  int imax=para->geom->imax, jmax=para->geom->jmax;
+  int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
+  int ni = hi[0]-lo[0]+1, nj = hi[1]-lo[1]+1, nk = hi[2]-lo[2]+1;
+  unsigned long size = (unsigned long) ni*nj*nk*sizeof(REAL);
+  unsigned long offset;
+  char extent[100];
+  REAL *y, *z;
+  FILE *datafile;
+
+  /****************************************************************************
+  | Get the coordinates of the grid lines
+  ****************************************************************************/
+  y = (REAL *) malloc((nj+nk)*sizeof(REAL));
+  if(y==NULL) return 1;
+  z = y + nj;
+  for(j=0; j<nj; j++) y[j] = var[Y][IX(0,lo[1]+j,0)];
+  for(k=0; k<nk; k++) z[k] = var[Z][IX(0,0,lo[2]+k)];
+
+  /* Open output file*/
+  if((datafile=fopen(filename, "wb"))==NULL) {
+    free(y);
+    return 1;
+  }
+
+  /****************************************************************************
+  | Write the header with the offsets of the appended data
+  ****************************************************************************/
+  sprintf(extent, " WholeExtent=\"%d %d %d %d %d %d\"", lo[0], hi[0], lo[1],
+          hi[1], lo[2], hi[2]);
+  write_vtk_header(datafile, "RectilinearGrid", extent, t);
+  fprintf(datafile, "<Piece Extent=\"%d %d %d %d %d %d\">\n", lo[0], hi[0],
+          lo[1], hi[1], lo[2], hi[2]);
+  offset = write_vtk_fields(datafile, field, nb_field, size);
+  fprintf(datafile, "<Coordinates>\n");
+  fprintf(datafile, "<DataArray type=\"Float64\" Name=\"X\" "
+          "format=\"appended\" offset=\"%lu\"/>\n", offset);
+  offset += 8 + ni*sizeof(REAL);
+  fprintf(datafile, "<DataArray type=\"Float64\" Name=\"Y\" "
+          "format=\"appended\" offset=\"%lu\"/>\n", offset);
+  offset += 8 + nj*sizeof(REAL);
+  fprintf(datafile, "<DataArray type=\"Float64\" Name=\"Z\" "
+          "format=\"appended\" offset=\"%lu\"/>\n", offset);
+  fprintf(datafile, "</Coordinates>\n</Piece>\n</RectilinearGrid>\n");
+  fprintf(datafile, "<AppendedData encoding=\"raw\">\n_");
+
+  /****************************************************************************
+  | Write the fields and the coordinates
+  ****************************************************************************/
+  flag = 0;
+  for(n=0; n<nb_field && flag==0; n++)
+    flag = write_vtk_block(datafile, psi[n], size);
+  if(flag==0)
+    flag = write_vtk_block(datafile, var[X]+lo[0], ni*sizeof(REAL))
+      || write_vtk_block(datafile, y, nj*sizeof(REAL))
+      || write_vtk_block(datafile, z, nk*sizeof(REAL));
+
+  fprintf(datafile, "\n</AppendedData>\n</VTKFile>\n");
+
+  if(fclose(datafile)!=0) flag = 1;
+  free(y);
+  return flag;
+} /* End of write_vtk_box()*/
+
+	/*
+		* Write fields at a set of points in the binary VTK format
+		*
+		* The file is a VTK XML poly data with the points as vertices or as one
+		* line through all of them. Nothing is written to the log.
+		*
+		* @param psi Pointer to the fields at the points
+		* @param field Pointer to the IDs of the variables of the fields
+		* @param nb_field Number of the fields
+		* @param t Time of the fields
+		* @param filename Pointer to the name of the file
+		* @param point Pointer to the coordinates x, y and z of each point
+		* @param nb_point Number of the points
+		* @param line 1: Connect the points by a line; 0: Vertices
+		*
+		* @return 0 if no error occurred
+		*/
+static int write_vtk_points(REAL **psi, const int *field, int nb_field,
+                            REAL t, char *filename, REAL *point, int nb_point,
+                            int line) {
+  unsigned long size = (unsigned long) nb_point*sizeof(REAL);
+  unsigned long offset;
+  int *cell;
+  int n, nb_cell = line==1 ? 1 : nb_point, flag;
+  const char *kind = line==1 ? "Lines" : "Verts";
+  FILE *datafile;
+
+  /* Connectivity of the cells followed by their offsets*/
+  cell = (int *) malloc((nb_point+nb_cell)*sizeof(int));
+  if(cell==NULL) return 1;
+  for(n=0; n<nb_point; n++) cell[n] = n;
+  for(n=0; n<nb_cell; n++) cell[nb_point+n] = line==1 ? nb_point : n+1;
+
+  if((datafile=fopen(filename, "wb"))==NULL) {
+    free(cell);
+    return 1;
+  }
+
+  /****************************************************************************
+  | Write the header with the offsets of the appended data
+  ****************************************************************************/
+  write_vtk_header(datafile, "PolyData", "", t);
+  fprintf(datafile, "<Piece NumberOfPoints=\"%d\" NumberOfVerts=\"%d\" "
+          "NumberOfLines=\"%d\" NumberOfStrips=\"0\" NumberOfPolys=\"0\">\n",
+          nb_point, line==1 ? 0 : nb_cell, line==1 ? nb_cell : 0);
+  offset = write_vtk_fields(datafile, field, nb_field, size);
+  fprintf(datafile, "<Points>\n<DataArray type=\"Float64\" "
+          "NumberOfComponents=\"3\" format=\"appended\" offset=\"%lu\"/>\n"
+          "</Points>\n", offset);
+  offset += 8 + 3*size;
+  fprintf(datafile, "<%s>\n<DataArray type=\"Int%d\" Name=\"connectivity\" "
+          "format=\"appended\" offset=\"%lu\"/>\n", kind,
+          (int) (8*sizeof(int)), offset);
+  offset += 8 + nb_point*sizeof(int);
+  fprintf(datafile, "<DataArray type=\"Int%d\" Name=\"offsets\" "
+          "format=\"appended\" offset=\"%lu\"/>\n</%s>\n",
+          (int) (8*sizeof(int)), offset, kind);
+  fprintf(datafile, "</Piece>\n</PolyData>\n");
+  fprintf(datafile, "<AppendedData encoding=\"raw\">\n_");
+
+  /****************************************************************************
+  | Write the fields, the points and the cells
+  ****************************************************************************/
+  flag = 0;
+  for(n=0; n<nb_field && flag==0; n++)
+    flag = write_vtk_block(datafile, psi[n], size);
+  if(flag==0)
+    flag = write_vtk_block(datafile, point, 3*size)
+      || write_vtk_block(datafile, cell, nb_point*sizeof(int))
+      || write_vtk_block(datafile, cell+nb_point, nb_cell*sizeof(int));
+
+  fprintf(datafile, "\n</AppendedData>\n</VTKFile>\n");
+
+  if(fclose(datafile)!=0) flag = 1;
+  free(cell);
+  return flag;
+} /* End of write_vtk_points()*/
+
+	/*
+		* Write fields to a file in the binary VTK format for ParaView
+		*
+		* The file is a VTK XML rectilinear grid with the points of all the cells
+		* including the boundary. Each field is stored as raw binary data.
+		* Since i is the fastest index of IX(i,j,k) as for the points of VTK,
+		* a field is written at once. Nothing is written to the log, so that
+		* the function can run in other threads than the one of FFD.
+		*
+		* @param para Pointer to FFD parameters
+		* @param var Pointer to FFD simulation variables for the coordinates
+		* @param psi Pointer to the fields
+		* @param field Pointer to the IDs of the variables of the fields
+		* @param nb_field Number of the fields
+		* @param t Time of the fields
+		* @param filename Pointer to the name of the file
+		*
+		* @return 0 if no error occurred
+		*/
+int write_vtk_file(PARA_DATA *para, REAL **var, REAL **psi, const int *field,
+                   int nb_field, REAL t, char *filename) {
+  int lo[3] = {0, 0, 0}, hi[3];
+
+  hi[0] = para->geom->imax + 1;
+  hi[1] = para->geom->jmax + 1;
+  hi[2] = para->geom->kmax + 1;
+
+  return write_vtk_box(para, var, psi, field, nb_field, t, filename, lo, hi);
+} /* End of write_vtk_file()*/
+
+	/*
+		* Write variables in the binary VTK format for ParaView
+		*
+		* @param para Pointer to FFD parameters
+		* @param var Pointer to FFD simulation variables
+		* @param name Pointer to the filename without extension
+		* @param field Pointer to the IDs of the variables
+		* @param nb_field Number of the variables
+		*
+		* @return 0 if no error occurred
+		*/
+int write_vtk_data(PARA_DATA *para, REAL **var, char *name, const int *field,
+                   int nb_field) {
+  REAL *psi[NUT+1];
+  char *filename;
+  int n;
+
+  filename = (char *) malloc((strlen(name)+5)*sizeof(char));
+  if(filename==NULL) {
+    ffd_log("write_vtk_data(): Failed to allocate memory for file name",
+            FFD_ERROR);
+    return 1;
+  }
+
+  strcpy(filename, name);
+  strcat(filename, ".vtr");
+
+  for(n=0; n<nb_field; n++) psi[n] = var[field[n]];
+
+  if(write_vtk_file(para, var, psi, field, nb_field, para->mytime->t,
+                    filename)!=0) {
+    sprintf(msg, "write_vtk_data(): Failed to write file %s.", filename);
+    ffd_log(msg, FFD_ERROR);
+    free(filename);
+    return 1;
+  }
+
+  sprintf(msg, "write_vtk_data(): Wrote file %s.", filename);
+  ffd_log(msg, FFD_NORMAL);
+
+  free(filename);
+  return 0;
+} /* End of write_vtk_data()*/
+
+	/*
+		* Find the variable written with the given name
+		*
+		* @param name Pointer to the name of the variable
+		*
+		* @return ID of the variable; -1 if no variable has the name
+		*/
+int find_field(const char *name) {
+  int n;
+
+  for(n=0; n<NUT+1; n++)
+    if(!strcmp(name, field_name[n])) return n;
+
+  return -1;
+} /* End of find_field()*/
+
+	/*
+		* Find the cell whose center is the nearest to a coordinate
+		*
+		* @param para Pointer to FFD parameters
+		* @param var Pointer to FFD simulation variables
+		* @param d Direction: 0: x; 1: y; 2: z
+		* @param v Coordinate
+		*
+		* @return Index of the cell in the direction
+		*/
+static int nearest_cell(PARA_DATA *para, REAL **var, int d, REAL v) {
+  int imax = para->geom->imax, jmax = para->geom->jmax;
+  int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
+  int n[3], i, best = 0;
+  REAL c;
+
+  n[0] = imax + 2;
+  n[1] = jmax + 2;
+  n[2] = para->geom->kmax + 2;
+
+  for(i=1; i<n[d]; i++) {
+    c = d==0 ? var[X][IX(i,0,0)] : d==1 ? var[Y][IX(0,i,0)]
+                                        : var[Z][IX(0,0,i)];
+    if(fabs(c-v)<fabs((d==0 ? var[X][IX(best,0,0)] : d==1 ?
+                      var[Y][IX(0,best,0)] : var[Z][IX(0,0,best)])-v))
+      best = i;
+  }
+
+  return best;
+} /* End of nearest_cell()*/
+
+	/*
+		* Write the parts of the domain chosen by the output selectors
+		*
+		* Boxes and slices are written as rectilinear grids (.vtr), the cells on
+		* the surfaces of the solid boundaries and the cells on probe lines as
+		* poly data (.vtp). Only the cells of the selected parts are gathered.
+		* The files are named after the selector, for example result_slice2.vtr
+		* for the second selector being a slice.
+		*
+		* @param para Pointer to FFD parameters
+		* @param var Pointer to FFD simulation variables
+		* @param name Pointer to the filename without extension
+		* @param field Pointer to the IDs of the variables
+		* @param nb_field Number of the variables
+		*
+		* @return 0 if no error occurred
+		*/
+int write_selected_data(PARA_DATA *para, REAL **var, char *name,
+                        const int *field, int nb_field) {
+  int i, j, k, n, m, s, d;
+  int imax = para->geom->imax, jmax = para->geom->jmax;
+  int kmax = para->geom->kmax;
+  int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
+  int size = IJMAX*(kmax+2);
+  int lo[3], hi[3], top[3], nb_cell, flag = 0;
+  REAL *flagp = var[FLAGP];
+  REAL *buf, *point, *psi[NUT+1], f;
+  int *cell;
+  OUTPUT_SELECTOR *sel;
+  char *filename;
+
+  top[0] = imax + 1;
+  top[1] = jmax + 1;
+  top[2] = kmax + 1;
+
+  buf = (REAL *) malloc((size_t) (nb_field+3)*size*sizeof(REAL));
+  cell = (int *) malloc(size*sizeof(int));
+  filename = (char *) malloc((strlen(name)+20)*sizeof(char));
+  if(buf==NULL || cell==NULL || filename==NULL) {
+    ffd_log("write_selected_data(): Failed to allocate memory", FFD_ERROR);
+    if(buf!=NULL) free(buf);
+    if(cell!=NULL) free(cell);
+    if(filename!=NULL) free(filename);
+    return 1;
+  }
+  point = buf + (size_t) nb_field*size;
+
+  for(s=0; s<para->outp->nb_selector && flag==0; s++) {
+    sel = &para->outp->selector[s];
+
+    /**************************************************************************
+    | Boxes and slices: gather the rows of the cells in the box
+    **************************************************************************/
+    if(sel->type==BOX || sel->type==SLICE) {
+      for(d=0; d<3; d++) {
+        if(sel->type==BOX) {
+          lo[d] = nearest_cell(para, var, d, sel->p0[d]);
+          hi[d] = nearest_cell(para, var, d, sel->p1[d]);
+          if(lo[d]>hi[d]) {
+            m = lo[d];
+            lo[d] = hi[d];
+            hi[d] = m;
+          }
+        }
+        else if(d==(sel->plane==XY ? 2 : sel->plane==YZ ? 0 : 1))
+          lo[d] = hi[d] = nearest_cell(para, var, d, sel->p0[0]);
+        else {
+          lo[d] = 0;
+          hi[d] = top[d];
+        }
+      }
+
+      nb_cell = (hi[0]-lo[0]+1)*(hi[1]-lo[1]+1)*(hi[2]-lo[2]+1);
+      for(n=0; n<nb_field; n++) {
+        psi[n] = buf + (size_t) n*nb_cell;
+        m = 0;
+        for(k=lo[2]; k<=hi[2]; k++)
+          for(j=lo[1]; j<=hi[1]; j++) {
+            memcpy(psi[n]+m, var[field[n]]+IX(lo[0],j,k),
+                   (hi[0]-lo[0]+1)*sizeof(REAL));
+            m += hi[0] - lo[0] + 1;
+          }
+      }
+
+      sprintf(filename, "%s_%s%d.vtr", name, sel->type==BOX ? "box" : "slice",
+              s+1);
+      flag = write_vtk_box(para, var, psi, field, nb_field, para->mytime->t,
+                           filename, lo, hi);
+    }
+    /**************************************************************************
+    | Surfaces and probe lines: gather the cells one by one
+    **************************************************************************/
+    else {
+      nb_cell = 0;
+      if(sel->type==SURFACE) {
+        /* Cells of the boundaries next to a fluid cell*/
+        FOR_ALL_CELL
+          if(flagp[IX(i,j,k)]>=0
+             && ((i>0 && flagp[IX(i-1,j,k)]==FLUID)
+                 || (i<imax+1 && flagp[IX(i+1,j,k)]==FLUID)
+                 || (j>0 && flagp[IX(i,j-1,k)]==FLUID)
+                 || (j<jmax+1 && flagp[IX(i,j+1,k)]==FLUID)
+                 || (k>0 && flagp[IX(i,j,k-1)]==FLUID)
+                 || (k<kmax+1 && flagp[IX(i,j,k+1)]==FLUID)))
+            cell[nb_cell++] = IX(i,j,k);
+        END_FOR
+      }
+      else {
+        /* Cells nearest to the points evenly spaced along the line*/
+        nb_cell = sel->nb_point<size ? sel->nb_point : size;
+        for(m=0; m<nb_cell; m++) {
+          f = (REAL) m / (nb_cell-1);
+          i = nearest_cell(para, var, 0, sel->p0[0]+f*(sel->p1[0]-sel->p0[0]));
+          j = nearest_cell(para, var, 1, sel->p0[1]+f*(sel->p1[1]-sel->p0[1]));
+          k = nearest_cell(para, var, 2, sel->p0[2]+f*(sel->p1[2]-sel->p0[2]));
+          cell[m] = IX(i,j,k);
+        }
+      }
+
+      for(n=0; n<nb_field; n++) {
+        psi[n] = buf + (size_t) n*nb_cell;
+        for(m=0; m<nb_cell; m++) psi[n][m] = var[field[n]][cell[m]];
+      }
+      for(m=0; m<nb_cell; m++) {
+        point[3*m] = var[X][cell[m]];
+        point[3*m+1] = var[Y][cell[m]];
+        point[3*m+2] = var[Z][cell[m]];
+      }
+
+      sprintf(filename, "%s_%s%d.vtp", name,
+              sel->type==SURFACE ? "surface" : "probe", s+1);
+      flag = write_vtk_points(psi, field, nb_field, para->mytime->t, filename,
+                              point, nb_cell, sel->type==PROBE);
+    }
+
+    if(flag!=0)
+      sprintf(msg, "write_selected_data(): Failed to write file %s.",
+              filename);
+    else
+      sprintf(msg, "write_selected_data(): Wrote file %s with %d of %d cells.",
+              filename, nb_cell, size);
+    ffd_log(msg, flag==0 ? FFD_NORMAL : FFD_ERROR);
+  }
+
+  free(buf);
+  free(cell);
+  free(filename);
+  return flag;
+} /* End of write_selected_data()*/
@@ -30,8 +30,6 @@
 #include "utility.h"
 #endif
 
-FILE *file1;
-
 /*
 	* Write standard output data in a format for tecplot
 	*
@@ -102,3 +100,68 @@ int write_unsteady(PARA_DATA *para, REAL **var, char *name);
 	* @return 0 if no error occurred
 	*/
 int write_SCI(PARA_DATA *para, REAL **var, char *name);
+
+/*
+	* Write fields to a file in the binary VTK format for ParaView
+	*
+	* The file is a VTK XML rectilinear grid with the points of all the cells
+	* including the boundary. Each field is stored as raw binary data.
+	* Nothing is written to the log, so that the function can run in other
+	* threads than the one of FFD.
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables for the coordinates
+	* @param psi Pointer to the fields
+	* @param field Pointer to the IDs of the variables of the fields
+	* @param nb_field Number of the fields
+	* @param t Time of the fields
+	* @param filename Pointer to the name of the file
+	*
+	* @return 0 if no error occurred
+	*/
+int write_vtk_file(PARA_DATA *para, REAL **var, REAL **psi, const int *field,
+                   int nb_field, REAL t, char *filename);
+
+/*
+	* Write variables in the binary VTK format for ParaView
+	*
+	* The file is a VTK XML rectilinear grid with the points of all the cells
+	* including the boundary. Each variable is stored as raw binary data.
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	* @param name Pointer to the filename without extension
+	* @param field Pointer to the IDs of the variables
+	* @param nb_field Number of the variables
+	*
+	* @return 0 if no error occurred
+	*/
+int write_vtk_data(PARA_DATA *para, REAL **var, char *name, const int *field,
+                   int nb_field);
+
+/*
+	* Write the parts of the domain chosen by the output selectors
+	*
+	* Boxes and slices are written as rectilinear grids (.vtr), the cells on
+	* the surfaces of the solid boundaries and the cells on probe lines as
+	* poly data (.vtp). Only the cells of the selected parts are gathered.
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	* @param name Pointer to the filename without extension
+	* @param field Pointer to the IDs of the variables
+	* @param nb_field Number of the variables
+	*
+	* @return 0 if no error occurred
+	*/
+int write_selected_data(PARA_DATA *para, REAL **var, char *name,
+                        const int *field, int nb_field);
+
+/*
+	* Find the variable written with the given name
+	*
+	* @param name Pointer to the name of the variable
+	*
+	* @return ID of the variable; -1 if no variable has the name
+	*/
+int find_field(const char *name);
@@ -156,7 +156,7 @@ int coef_diff(PARA_DATA *para, REAL **var, REAL *psi, REAL *psi0,
         Dz =  gz[IX(i,j,k)] -     gz[IX(i,j,k-1)];
 
         if(para->prob->tur_model==CHEN)
-          kapa = nu_t_chen_zero_equ(para, var, i, j, k);
+          kapa = var[NUT][IX(i,j,k)];
 
         aw[IX(i,j,k)] = kapa*Dy*Dz/dxw;
         ae[IX(i,j,k)] = kapa*Dy*Dz/dxe;
@@ -198,7 +198,7 @@ int coef_diff(PARA_DATA *para, REAL **var, REAL *psi, REAL *psi0,
         Dz = gz[IX(i,j,k)] - gz[IX(i,j,k-1)];
 
         if(para->prob->tur_model==CHEN)
-          kapa = nu_t_chen_zero_equ(para, var, i, j, k);
+          kapa = var[NUT][IX(i,j,k)];
 
         aw[IX(i,j,k)] = kapa*Dy*Dz/dxw;
         ae[IX(i,j,k)] = kapa*Dy*Dz/dxe;
@@ -240,7 +240,7 @@ int coef_diff(PARA_DATA *para, REAL **var, REAL *psi, REAL *psi0,
         Dz = z[IX(i,j,k+1)] - z[IX(i,j,k)];
 
         if(para->prob->tur_model==CHEN)
-          kapa = nu_t_chen_zero_equ(para, var, i, j, k);
+          kapa = var[NUT][IX(i,j,k)];
 
         aw[IX(i,j,k)] = kapa*Dy*Dz/dxw;
         ae[IX(i,j,k)] = kapa*Dy*Dz/dxe;
@@ -287,7 +287,7 @@ int coef_diff(PARA_DATA *para, REAL **var, REAL *psi, REAL *psi0,
         Dz = gz[IX(i,j,k)] - gz[IX(i,j,k-1)];
 
         if(para->prob->tur_model==CHEN)
-          kapa = nu_t_chen_zero_equ(para, var, i, j, k);
+          kapa = var[NUT][IX(i,j,k)];
 
         aw[IX(i,j,k)] = kapa*Dy*Dz/dxw;
         ae[IX(i,j,k)] = kapa*Dy*Dz/dxe;
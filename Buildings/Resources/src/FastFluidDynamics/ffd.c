@@ -17,40 +17,25 @@
 
 #include "ffd.h"
 
-/* global variables */
-REAL **var;
-int  **BINDEX;
-REAL *locmin,*locmax;
-static PARA_DATA para;
-static GEOM_DATA geom;
-static PROB_DATA prob;
-static TIME_DATA mytime;
-static INPU_DATA inpu;
-static OUTP_DATA outp1;
-static BC_DATA bc;
-static SOLV_DATA solv;
-static SENSOR_DATA sens;
-static INIT_DATA init;
-
-clock_t start, end;
-
 /*
 	* Allcoate memory for variables
 	*
-	* @param para Pointer to FFD parameters
+	* @param ctx Pointer to the FFD context
 	*
 	* @return No return needed
 	*/
-int allocate_memory (PARA_DATA *para) {
-
+int allocate_memory (FFD_CONTEXT *ctx) {
+  REAL **var;
+  int **BINDEX;
   int nb_var, i;
-  int size = (geom.imax+2) * (geom.jmax+2) * (geom.kmax+2);
+  int size = (ctx->geom.imax+2) * (ctx->geom.jmax+2) * (ctx->geom.kmax+2);
 
   /****************************************************************************
   | Allocate memory for variables
   ****************************************************************************/
-  nb_var = C2BC+1;
-  var       = (REAL **) malloc ( nb_var*sizeof(REAL*) );
+  nb_var = NUT+1;
+  var       = (REAL **) calloc(nb_var, sizeof(REAL*));
+  ctx->var = var;
   if(var==NULL) {
     ffd_log("allocate_memory(): Could not allocate memory for var.",
             FFD_ERROR);
@@ -75,7 +60,8 @@ int allocate_memory (PARA_DATA *para) {
   | BINDEX[3]: Fixed temperature or fixed heat flux
   | BINDEX[4]: Boundary ID to identify which boundary it belongs to
   ****************************************************************************/
-  BINDEX = (int **)malloc(5*sizeof(int*));
+  BINDEX = (int **) calloc(5, sizeof(int*));
+  ctx->BINDEX = BINDEX;
   if(BINDEX==NULL) {
     ffd_log("allocate_memory(): Could not allocate memory for BINDEX.",
             FFD_ERROR);
@@ -94,6 +80,40 @@ int allocate_memory (PARA_DATA *para) {
   return 0;
 } /* End of allocate_memory()*/
 
+/*
+	* Free the memory of an FFD context
+	*
+	* The context itself is not freed.
+	*
+	* @param ctx Pointer to the FFD context
+	*
+	* @return No return needed
+	*/
+void free_context(FFD_CONTEXT *ctx) {
+  free_data(ctx->var);
+  ctx->var = NULL;
+  free_index(ctx->BINDEX);
+  ctx->BINDEX = NULL;
+  if(ctx->cache.h!=NULL) free(ctx->cache.h);
+  ctx->cache.h = NULL;
+  if(ctx->geom.face!=NULL) free(ctx->geom.face);
+  ctx->geom.face = NULL;
+  if(ctx->memo.input!=NULL) free(ctx->memo.input);
+  ctx->memo.input = NULL;
+  if(ctx->memo.output!=NULL) free(ctx->memo.output);
+  ctx->memo.output = NULL;
+  free_snapshot(&ctx->para);
+  free_steady_state(&ctx->para);
+  if(ctx->bc.wallCell!=NULL) free(ctx->bc.wallCell);
+  ctx->bc.wallCell = NULL;
+  if(ctx->bc.wallCellStart!=NULL) free(ctx->bc.wallCellStart);
+  ctx->bc.wallCellStart = NULL;
+  if(ctx->bc.portCell!=NULL) free(ctx->bc.portCell);
+  ctx->bc.portCell = NULL;
+  if(ctx->bc.portCellStart!=NULL) free(ctx->bc.portCellStart);
+  ctx->bc.portCellStart = NULL;
+} /* End of free_context()*/
+
 
 	/*
 		* Assign the parameter for coupled simulation
@@ -103,11 +123,24 @@ int allocate_memory (PARA_DATA *para) {
 		* @return 0 if no error occurred
 		*/
 int ffd_cosimulation(CosimulationData *cosim) {
-  para.cosim = (CosimulationData *) malloc(sizeof(CosimulationData));
-  para.cosim = cosim;
+  FFD_CONTEXT *ctx;
+  int flag;
 
-  if(ffd(1)!=0) {
-    cosim->para->ffdError = 1;
+  /* Each room has its own storage so that several rooms can run at a time*/
+  ctx = (FFD_CONTEXT *) calloc(1, sizeof(FFD_CONTEXT));
+  if(ctx==NULL) {
+    ffd_log("ffd_cosimulation(): Could not allocate memory for FFD.",
+            FFD_ERROR);
+    ffd_set_flag(cosim, &cosim->para->ffdError, 1);
+    return 1;
+  }
+  ctx->para.cosim = cosim;
+
+  flag = ffd(ctx, 1);
+  free(ctx);
+
+  if(flag!=0) {
+    ffd_set_flag(cosim, &cosim->para->ffdError, 1);
     return 1;
   }
   else
@@ -115,61 +148,74 @@ int ffd_cosimulation(CosimulationData *cosim) {
 } /* End of ffd_cosimulation()*/
 
 	/*
-		* Main routine of FFD
+		* Run the simulation of an FFD context
 		*
-		* @para coupled simulation Integer to identify the simulation type
+		* The memory of the context is freed by the caller, also if an error
+		* occurred.
+		*
+		* @param ctx Pointer to the FFD context with the parameters assigned
 		*
 		* @return 0 if no error occurred
 		*/
-int ffd(int cosimulation) {
-/*#ifndef _MSC_VER //Linux*/
-/*  //Initialize glut library*/
-/*  char fakeParam[] = "fake";*/
-/*  char *fakeargv[] = { fakeParam, NULL };*/
-/*  int fakeargc = 1;*/
-/*  glutInit( &fakeargc, fakeargv );*/
-/*#endif*/
-
-  /* Initialize the parameters*/
-  para.geom = &geom;
-  para.inpu = &inpu;
-  para.outp = &outp1;
-  para.prob = &prob;
-  para.mytime = &mytime;
-  para.bc     = &bc;
-  para.solv   = &solv;
-  para.sens   = &sens;
-  para.init   = &init;
-  /* Stand alone simulation: 0; Cosimulaiton: 1*/
-  para.solv->cosimulation = cosimulation;
+static int run_ffd(FFD_CONTEXT *ctx) {
+  PARA_DATA *para = &ctx->para;
+  STARTUP_DATA *startup = &ctx->mytime.startup;
+  REAL **var;
+  int **BINDEX;
+  char name[30];
+  double t_start = wall_time(), t0;
 
-  if(initialize(&para)!=0) {
+  if(initialize(para)!=0) {
     ffd_log("ffd(): Could not initialize simulation parameters.", FFD_ERROR);
     return 1;
   }
+  startup->parameter = wall_time() - t_start;
 
   /* Overwrite the mesh and simulation data using SCI generated file*/
-  if(para.inpu->parameter_file_format == SCI) {
-    if(read_sci_max(&para, var)!=0) {
+  if(para->inpu->parameter_file_format == SCI) {
+    t0 = wall_time();
+    if(read_sci_max(para, ctx->var)!=0) {
       ffd_log("ffd(): Could not read SCI data.", FFD_ERROR);
       return 1;
     }
+    startup->sci += wall_time() - t0;
   }
 
   /* Allocate memory for the variables*/
-  if(allocate_memory(&para)!=0) {
+  if(allocate_memory(ctx)!=0) {
     ffd_log("ffd(): Could not allocate memory for the simulation.", FFD_ERROR);
     return 1;
   }
+  var = ctx->var;
+  BINDEX = ctx->BINDEX;
 
   /* Set the initial values for the simulation data*/
-  if(set_initial_data(&para, var, BINDEX)) {
+  if(set_initial_data(para, var, BINDEX)) {
     ffd_log("ffd(): Could not set initial data.", FFD_ERROR);
     return 1;
   }
 
   /* Read previous simulation data as initial values*/
-  if(para.inpu->read_old_ffd_file==1) read_ffd_data(&para, var);
+  if(para->inpu->read_old_ffd_file==1 && read_ffd_data(para, var)!=0) {
+    ffd_log("ffd(): Could not read previous simulation data.", FFD_ERROR);
+    return 1;
+  }
+
+  /* Keep the initial state for Modelica stepping back to the start*/
+  if(para->solv->cosimulation==1 && take_snapshot(para, var)!=0) {
+    ffd_log("ffd(): Could not keep the initial state.", FFD_ERROR);
+    return 1;
+  }
+
+  t0 = wall_time() - t_start;
+  sprintf(msg, "ffd(): Started in %.3f[s]: parameter file %.3f[s], SCI file "
+          "%.3f[s], block file %.3f[s], cells and boundaries %.3f[s], "
+          "coarse grid %.3f[s], exchange with Modelica %.3f[s], other "
+          "%.3f[s].", t0, startup->parameter, startup->sci, startup->block,
+          startup->geometry, startup->warm_start, startup->exchange,
+          t0 - startup->parameter - startup->sci - startup->block
+          - startup->geometry - startup->warm_start - startup->exchange);
+  ffd_log(msg, FFD_NORMAL);
 
   ffd_log("ffd.c: Start FFD solver.", FFD_NORMAL);
   /*write_tecplot_data(&para, var, "initial");*/
@@ -180,42 +226,111 @@ int ffd(int cosimulation) {
   /*  glutMainLoop();*/
   /*}*/
   /*else*/
-  if(FFD_solver(&para, var, BINDEX)!=0) {
+  if(FFD_solver(para, var, BINDEX)!=0) {
+    /* The writer thread must end before the storage is freed*/
+    close_movie(para);
     ffd_log("ffd(): FFD solver failed.", FFD_ERROR);
     return 1;
   }
 
+  /* Write the rest of the frames before the data is converted for output*/
+  if(close_movie(para)!=0) {
+    ffd_log("ffd(): Could not write the animation.", FFD_ERROR);
+    return 1;
+  }
+
+  /* The checkpoint keeps the sums of the time average, which are divided below*/
+  if(para->outp->checkpoint_step>0) {
+    instance_file_name(para, "checkpoint", name);
+    if(write_checkpoint(para, var, name)!=0) {
+      ffd_log("ffd(): Could not write the checkpoint.", FFD_ERROR);
+      return 1;
+    }
+  }
+
   /*---------------------------------------------------------------------------
   | Post Process
   ---------------------------------------------------------------------------*/
   /* Calculate mean value*/
-  if(para.outp->cal_mean == 1)
-    average_time(&para, var);
+  if(para->outp->cal_mean == 1)
+    average_time(para, var);
 
-  if(write_unsteady(&para, var, "unsteady")!=0) {
+  instance_file_name(para, "unsteady", name);
+  if(write_unsteady(para, var, name)!=0) {
     ffd_log("FFD_solver(): Could not write the file unsteady.plt.", FFD_ERROR);
     return 1;
   }
 
-  if(write_tecplot_data(&para, var, "result")!=0) {
+  instance_file_name(para, "result", name);
+  if(write_tecplot_data(para, var, name)!=0) {
     ffd_log("FFD_solver(): Could not write the file result.plt.", FFD_ERROR);
     return 1;
   }
 
-  if(para.outp->version == DEBUG)
-    write_tecplot_all_data(&para, var, "result_all");
+  if(para->outp->version == DEBUG) {
+    instance_file_name(para, "result_all", name);
+    write_tecplot_all_data(para, var, name);
+  }
 
   /* Write the data in SCI format*/
-  write_SCI(&para, var, "output");
+  instance_file_name(para, "output", name);
+  write_SCI(para, var, name);
+
+  return 0;
+} /* End of run_ffd()*/
+
+	/*
+		* Main routine of FFD
+		*
+		* @param ctx Pointer to the FFD context
+		* @para coupled simulation Integer to identify the simulation type
+		*
+		* @return 0 if no error occurred
+		*/
+int ffd(FFD_CONTEXT *ctx, int cosimulation) {
+  PARA_DATA *para = &ctx->para;
+  int flag;
+
+/*#ifndef _MSC_VER //Linux*/
+/*  //Initialize glut library*/
+/*  char fakeParam[] = "fake";*/
+/*  char *fakeargv[] = { fakeParam, NULL };*/
+/*  int fakeargc = 1;*/
+/*  glutInit( &fakeargc, fakeargv );*/
+/*#endif*/
+
+  /* Initialize the parameters*/
+  para->geom = &ctx->geom;
+  para->inpu = &ctx->inpu;
+  para->outp = &ctx->outp;
+  para->prob = &ctx->prob;
+  para->mytime = &ctx->mytime;
+  para->bc     = &ctx->bc;
+  para->solv   = &ctx->solv;
+  para->sens   = &ctx->sens;
+  para->init   = &ctx->init;
+  para->cache  = &ctx->cache;
+  para->memo   = &ctx->memo;
+  para->snap   = &ctx->snap;
+  para->rt     = &ctx->rt;
+  para->movie  = &ctx->movie;
+  para->steady = &ctx->steady;
+  /* Stand alone simulation: 0; Cosimulaiton: 1*/
+  para->solv->cosimulation = cosimulation;
+
+  flag = run_ffd(ctx);
 
-  /* Free the memory*/
-  free_data(var);
-  free_index(BINDEX);
+  /* Free the memory on every exit, the caller frees the context itself*/
+  free_context(ctx);
+  if(flag!=0)
+    return flag;
 
   /* Inform Modelica the stopping command has been received*/
-  if(para.solv->cosimulation==1) {
-    para.cosim->para->flag = 2;
+  if(para->solv->cosimulation==1) {
     ffd_log("ffd(): Sent stopping signal to Modelica", FFD_NORMAL);
+    /* Modelica may end the process once it has the signal*/
+    ffd_log_flush();
+    ffd_set_flag(para->cosim, &para->cosim->para->flag, 2);
   }
 
   return 0;
@@ -224,24 +339,24 @@ int ffd(int cosimulation) {
 	/*
 		* Write error message to Modelica
 		*
+		* @para cosim Pointer to the coupled simulation data
 		* @para msg Pointer to message to be written.
 		*
 		* @return no return
 		*/
-void modelicaError(char *msg) {
-	/*Allocate memory for cosim->ffd->msg*/
-	para.cosim->ffd->msg = (char *) malloc(400*sizeof(char));
-  if (para.cosim->ffd->msg == NULL){
+void modelicaError(CosimulationData *cosim, char *msg) {
+	/* Modelica reads the message after the error, so the buffer is kept*/
+  if(cosim->ffd->msg == NULL)
+	  cosim->ffd->msg = (char *) malloc(400*sizeof(char));
+  if (cosim->ffd->msg == NULL){
 		ffd_log("ffd(): Failed to allocate memory for cosim->ffd->msg", FFD_ERROR);
   }
-	
-  strcpy(para.cosim->ffd->msg, msg);
+  else {
+    strncpy(cosim->ffd->msg, msg, 399);
+    cosim->ffd->msg[399] = '\0';
+  }
   /* Write the command to stop the cosimulation*/
-  para.cosim->para->flag = 2;
+  ffd_set_flag(cosim, &cosim->para->flag, 2);
   /* Indicate there is an error*/
-  para.cosim->para->ffdError = 1;
-
-	/*Free memory for cosim->ffd->msg*/	
-	free(para.cosim->ffd->msg);
-	
+  ffd_set_flag(cosim, &cosim->para->ffdError, 1);
 } /* End of modelicaError*/
@@ -65,26 +65,37 @@ int ffd_cosimulation(CosimulationData *cosim);
 /*
 	* Main routine of FFD
 	*
+	* @param ctx Pointer to the FFD context
 	* @para coupled simulation Integer to identify the simulation type
 	*
 	* @return 0 if no error occurred
 	*/
-int ffd(int cosimulation);
+int ffd(FFD_CONTEXT *ctx, int cosimulation);
 
 /*
 	* Allocate memory for variables
 	*
-	* @param para Pointer to FFD parameters
+	* @param ctx Pointer to the FFD context
 	*
 	* @return No return needed
 	*/
-int allocate_memory (PARA_DATA *para);
+int allocate_memory (FFD_CONTEXT *ctx);
+
+/*
+	* Free the memory of an FFD context
+	*
+	* @param ctx Pointer to the FFD context
+	*
+	* @return No return needed
+	*/
+void free_context(FFD_CONTEXT *ctx);
 
 /*
 	* Write error message to Modelica
 	*
+	* @para cosim Pointer to the coupled simulation data
 	* @para msg Pointer to message to be written.
 	*
 	* @return no return
 	*/
-void modelicaError(char *msg);
+void modelicaError(CosimulationData *cosim, char *msg);
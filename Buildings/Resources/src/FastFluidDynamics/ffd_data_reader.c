@@ -20,6 +20,8 @@
 /*
 	* Read the previous FFD simulation data in a format of standard output
 	*
+	* A binary checkpoint written by write_checkpoint() is also accepted.
+	*
 	* @param para Pointer to FFD parameters
 	* @param var Pointer to FFD simulation variables
 	*
@@ -32,6 +34,10 @@ int read_ffd_data(PARA_DATA *para, REAL **var) {
   int kmax = para->geom->kmax;
   int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
   char string[400];
+  FILE *file_old_ffd;
+
+  if(is_checkpoint(para->inpu->old_ffd_file_name))
+    return read_checkpoint(para, var, para->inpu->old_ffd_file_name);
 
   if((file_old_ffd=fopen(para->inpu->old_ffd_file_name,"r"))==NULL) {
     sprintf(msg, "ffd_data_reader.c: Can not open file \"%s\".",
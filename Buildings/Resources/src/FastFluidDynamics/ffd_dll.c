@@ -16,7 +16,45 @@
 *
 */
 
+/* Needed for clock_gettime(), robust mutexes and futexes with -std=c89*/
+#ifndef _MSC_VER
+#define _GNU_SOURCE
+#endif
+
 #include "ffd_dll.h"
+
+#ifndef _FFD_SERVER_H
+#define _FFD_SERVER_H
+#include "ffd_server.h"
+#endif
+
+#ifndef _TIMING_H
+#define _TIMING_H
+#include "timing.h"
+#endif
+
+#ifndef _MSC_VER
+#include <errno.h>
+#endif
+
+#ifdef __linux__
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+/* Maximum number of FFD instances (rooms) running at a time*/
+#define FFD_MAX_INSTANCE 64
+
+/* Interval in milliseconds for polling a flag without the signalling object*/
+#define FFD_POLL_INTERVAL 1
+
+/* Coupled simulation data of the FFD instances, NULL if the index is free*/
+static CosimulationData *instance[FFD_MAX_INSTANCE];
+
+/* Connections to the FFD server, NULL if the instance runs in this process*/
+static void *client[FFD_MAX_INSTANCE];
+
 /******************************************************************************
 | DLL interface to launch a separated thread for FFD.
 | Called by the other program
@@ -29,16 +67,33 @@ void *ffd_dll(CosimulationData *cosim) {
 /*  Linux*/
 #else
     pthread_t thread1[1];
+    void * (*foo) (void *);
 #endif
 
   /*printf("ffd_dll():Start to launch FFD\n");*/
+  ffd_add_instance(cosim);
+
+  if(ffd_init_sync(cosim)!=0)
+    printf("ffd_dll(): Could not create the signalling object; "
+           "use polling for the data exchange\n");
+
+#ifndef _MSC_VER
+  /* Run the room in the FFD server if one is named*/
+  if(getenv(FFD_SERVER_ENV)!=NULL && cosim->sync!=NULL
+     && cosim->id<FFD_MAX_INSTANCE) {
+    client[cosim->id] = ffd_server_connect(cosim, getenv(FFD_SERVER_ENV));
+    if(client[cosim->id]!=NULL)
+      return client[cosim->id];
+    printf("ffd_dll(): Could not connect to FFD server \"%s\"; "
+           "run FFD in this process\n", getenv(FFD_SERVER_ENV));
+  }
+#endif
 
 /* Windows*/
 #ifdef _MSC_VER
   workerThreadHandle[0] = CreateThread(NULL, 0, ffd_thread, (void *)cosim, 0, &dummy);
 /* Linux*/
 #else
-  void * (*foo) (void *);
   foo=&ffd_thread;
   pthread_create(&thread1[0], NULL, foo, (void *)cosim);
 #endif
@@ -68,6 +123,9 @@ void *ffd_thread(void* p){
 int pthread_ret = 0;
   CosimulationData *cosim = (CosimulationData *) p;
 
+  /* Log and report errors of this instance in this thread*/
+  set_log_instance(cosim);
+
 #ifdef _MSC_VER /*Windows*/
   sprintf(msg, "Start Fast Fluid Dynamics Simulation with Thread ID %lu", workerID);
 #else /*Linux*/
@@ -77,17 +135,403 @@ int pthread_ret = 0;
   printf("%s\n", msg);
   ffd_log(msg, FFD_NEW);
 
-  sprintf(msg, "fileName=\"%s\"", cosim->para->fileName);
+  sprintf(msg, "fileName=\"%.900s\"", cosim->para->fileName);
   ffd_log(msg, FFD_NORMAL);
 
   if(ffd_cosimulation(cosim)!=0) {
     ffd_log("ffd_thread(): Cosimulation failed", FFD_ERROR);
+    ffd_log_close();
 		#ifdef _MSC_VER
 			return 1;
 		#endif
   }
   else {
     ffd_log("Successfully exit FFD.", FFD_NORMAL);
+    ffd_log_close();
 		return 0;
   }
 } /* End of ffd_thread()*/
+
+/*
+* Assign the index of an FFD instance
+*
+* The smallest free index is taken so that the first room keeps the names
+* of the output files.
+*
+* @param cosim Pointer to the coupled simulation data
+*
+* @return No return needed
+*/
+void ffd_add_instance(CosimulationData *cosim) {
+  for(cosim->id=0; cosim->id<FFD_MAX_INSTANCE; cosim->id++)
+    if(instance[cosim->id]==NULL) break;
+  if(cosim->id<FFD_MAX_INSTANCE)
+    instance[cosim->id] = cosim;
+  else
+    printf("ffd_dll(): More than %d FFD instances; "
+           "the output files will be overwritten\n", FFD_MAX_INSTANCE);
+} /* End of ffd_add_instance()*/
+
+/*
+* Release the index of an FFD instance
+*
+* @param cosim Pointer to the coupled simulation data
+*
+* @return No return needed
+*/
+void ffd_remove_instance(CosimulationData *cosim) {
+  if(cosim->id>=0 && cosim->id<FFD_MAX_INSTANCE
+     && instance[cosim->id]==cosim)
+    instance[cosim->id] = NULL;
+} /* End of ffd_remove_instance()*/
+
+/*
+* Initialize a signalling object
+*
+* Processes do not share a condition variable since a process that dies
+* while waiting would block the other one. The waiting thread of a shared
+* object waits on the number of changes with a futex instead.
+*
+* @param sync Pointer to the signalling object
+* @param shared 1: the object is in memory shared by several processes
+*
+* @return 0 if no error occurred
+*/
+int ffd_init_sync_object(FFD_SYNC *sync, int shared) {
+#ifndef _MSC_VER
+  pthread_mutexattr_t attr;
+  int flag = 0;
+#endif
+
+  sync->count = 0;
+  sync->shared = shared;
+  sync->peer = NULL;
+
+#ifdef _MSC_VER
+  if(shared) return 1;
+  InitializeCriticalSection(&sync->mutex);
+  InitializeConditionVariable(&sync->cond);
+#else
+#ifndef __linux__
+  if(shared) return 1;
+#endif
+  pthread_mutexattr_init(&attr);
+  /* A process that dies holding the mutex must not block the other one*/
+  if(shared)
+    flag = pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED)
+           || pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+  if(flag==0)
+    flag = pthread_mutex_init(&sync->mutex, &attr);
+  pthread_mutexattr_destroy(&attr);
+  if(flag!=0) return 1;
+
+  if(!shared && pthread_cond_init(&sync->cond, NULL)!=0) {
+    pthread_mutex_destroy(&sync->mutex);
+    return 1;
+  }
+#endif
+
+  return 0;
+} /* End of ffd_init_sync_object()*/
+
+/*
+* Free a signalling object that is not in shared memory
+*
+* No thread may wait on the object.
+*
+* @param sync Pointer to the signalling object
+*
+* @return No return needed
+*/
+void ffd_free_sync_object(FFD_SYNC *sync) {
+#ifdef _MSC_VER
+  DeleteCriticalSection(&sync->mutex);
+#else
+  pthread_mutex_destroy(&sync->mutex);
+  pthread_cond_destroy(&sync->cond);
+#endif
+} /* End of ffd_free_sync_object()*/
+
+/*
+* Lock the mutex of a signalling object
+*
+* @param sync Pointer to the signalling object
+*
+* @return No return needed
+*/
+void ffd_lock_sync(FFD_SYNC *sync) {
+#ifdef _MSC_VER
+  EnterCriticalSection(&sync->mutex);
+#else
+  /* The other process died holding the mutex: the flags are still valid*/
+  if(pthread_mutex_lock(&sync->mutex)==EOWNERDEAD)
+    pthread_mutex_consistent(&sync->mutex);
+#endif
+} /* End of ffd_lock_sync()*/
+
+/*
+* Unlock the mutex of a signalling object
+*
+* @param sync Pointer to the signalling object
+*
+* @return No return needed
+*/
+void ffd_unlock_sync(FFD_SYNC *sync) {
+#ifdef _MSC_VER
+  LeaveCriticalSection(&sync->mutex);
+#else
+  pthread_mutex_unlock(&sync->mutex);
+#endif
+} /* End of ffd_unlock_sync()*/
+
+/*
+* Count a change and wake up all the waiting threads
+*
+* The mutex must be locked by the caller.
+*
+* @param sync Pointer to the signalling object
+*
+* @return No return needed
+*/
+void ffd_notify_sync(FFD_SYNC *sync) {
+  sync->count++;
+#ifdef _MSC_VER
+  WakeAllConditionVariable(&sync->cond);
+#else
+#ifdef __linux__
+  if(sync->shared) {
+    syscall(SYS_futex, &sync->count, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+    return;
+  }
+#endif
+  pthread_cond_broadcast(&sync->cond);
+#endif
+} /* End of ffd_notify_sync()*/
+
+/*
+* Wait until the number of changes differs from a value
+*
+* The mutex must be locked by the caller and is locked again on return.
+*
+* @param sync Pointer to the signalling object
+* @param count Number of changes seen by the caller
+* @param timeout Maximum waiting time in milliseconds
+*
+* @return No return needed
+*/
+void ffd_wait_sync(FFD_SYNC *sync, int count, int timeout) {
+#ifndef _MSC_VER
+  struct timespec abstime;
+#endif
+
+  if(sync->count!=count) return;
+
+#ifdef _MSC_VER
+  SleepConditionVariableCS(&sync->cond, &sync->mutex, (DWORD) timeout);
+#else
+#ifdef __linux__
+  if(sync->shared) {
+    /* Relative time out; the kernel returns at once if count has changed*/
+    abstime.tv_sec = timeout/1000;
+    abstime.tv_nsec = (long) (timeout%1000) * 1000000L;
+    ffd_unlock_sync(sync);
+    syscall(SYS_futex, &sync->count, FUTEX_WAIT, count, &abstime, NULL, 0);
+    ffd_lock_sync(sync);
+    return;
+  }
+#endif
+  clock_gettime(CLOCK_REALTIME, &abstime);
+  abstime.tv_sec += timeout/1000;
+  abstime.tv_nsec += (long) (timeout%1000) * 1000000L;
+  if(abstime.tv_nsec>=1000000000L) {
+    abstime.tv_sec++;
+    abstime.tv_nsec -= 1000000000L;
+  }
+  pthread_cond_timedwait(&sync->cond, &sync->mutex, &abstime);
+#endif
+} /* End of ffd_wait_sync()*/
+
+/*
+* Create the signalling object for the flags of the cosimulation
+*
+* @param cosim Pointer to the coupled simulation data
+*
+* @return 0 if no error occurred
+*/
+int ffd_init_sync(CosimulationData *cosim) {
+  FFD_SYNC *sync = (FFD_SYNC *) malloc(sizeof(FFD_SYNC));
+
+  if(sync==NULL || ffd_init_sync_object(sync, 0)!=0) {
+    free(sync);
+    cosim->sync = NULL;
+    return 1;
+  }
+
+  cosim->sync = (void *) sync;
+  return 0;
+} /* End of ffd_init_sync()*/
+
+/*
+* Free the signalling object for the flags of the cosimulation and release
+* the index of the FFD instance
+*
+* Must only be called when neither Modelica nor FFD waits for a flag.
+*
+* @param cosim Pointer to the coupled simulation data
+*
+* @return No return needed
+*/
+void ffd_free_sync(CosimulationData *cosim) {
+  FFD_SYNC *sync = (FFD_SYNC *) cosim->sync;
+
+#ifndef _MSC_VER
+  if(cosim->id>=0 && cosim->id<FFD_MAX_INSTANCE
+     && instance[cosim->id]==cosim && client[cosim->id]!=NULL) {
+    ffd_server_disconnect(client[cosim->id]);
+    client[cosim->id] = NULL;
+  }
+#endif
+  ffd_remove_instance(cosim);
+
+  if(sync==NULL) return;
+
+  ffd_free_sync_object(sync);
+  free(sync);
+  cosim->sync = NULL;
+} /* End of ffd_free_sync()*/
+
+/*
+* Set a flag of the cosimulation and wake up the waiting side
+*
+* @param cosim Pointer to the coupled simulation data
+* @param flag Pointer to the flag
+* @param value New value of the flag
+*
+* @return No return needed
+*/
+void ffd_set_flag(CosimulationData *cosim, int *flag, int value) {
+  FFD_SYNC *sync = (FFD_SYNC *) cosim->sync;
+  FFD_SYNC *peer;
+
+  if(sync==NULL) {
+    *flag = value;
+    return;
+  }
+
+  ffd_lock_sync(sync);
+  *flag = value;
+  ffd_notify_sync(sync);
+  peer = sync->peer;
+  ffd_unlock_sync(sync);
+
+  /* Wake up the side waiting for any change, such as the server connection*/
+  if(peer!=NULL) {
+    ffd_lock_sync(peer);
+    ffd_notify_sync(peer);
+    ffd_unlock_sync(peer);
+  }
+} /* End of ffd_set_flag()*/
+
+/*
+* Wait until a flag of the cosimulation is (or is not) equal to a value
+*
+* The function blocks until the condition is met, another flag is set or
+* the time out is reached, so that the caller can check for errors and stop
+* commands between the waits.
+*
+* @param cosim Pointer to the coupled simulation data
+* @param flag Pointer to the flag
+* @param value Value to compare with
+* @param equal 1: wait until *flag==value; 0: wait until *flag!=value
+* @param timeout Maximum waiting time in milliseconds
+*
+* @return 0 if the condition is met, 1 otherwise
+*/
+int ffd_wait_flag(CosimulationData *cosim, int *flag, int value, int equal,
+                  int timeout) {
+  FFD_SYNC *sync = (FFD_SYNC *) cosim->sync;
+  int met, waited;
+
+  /* Poll with short sleeps if the signalling object could not be created*/
+  if(sync==NULL) {
+    for(waited=0; (*flag==value)!=equal && waited<timeout;
+        waited+=FFD_POLL_INTERVAL)
+      ffd_sleep(FFD_POLL_INTERVAL);
+    return (*flag==value)==equal ? 0 : 1;
+  }
+
+  ffd_lock_sync(sync);
+  met = (*flag==value)==equal;
+  if(!met) {
+    ffd_wait_sync(sync, sync->count, timeout);
+    met = (*flag==value)==equal;
+  }
+  ffd_unlock_sync(sync);
+
+  return met ? 0 : 1;
+} /* End of ffd_wait_flag()*/
+
+/*
+* Get the free slot of a message ring for the producer
+*
+* @param cosim Pointer to the coupled simulation data
+* @param ring Pointer to the message ring
+* @param timeout Maximum waiting time in milliseconds if the ring is full
+*
+* @return Pointer to the slot, NULL if the ring is still full
+*/
+REAL *ffd_ring_reserve(CosimulationData *cosim, MessageRing *ring,
+                       int timeout) {
+  /* Only the producer changes the head*/
+  int head = ring->head;
+
+  if(ffd_wait_flag(cosim, &ring->tail, head-FFD_RING_SIZE, 0, timeout)!=0)
+    return NULL;
+
+  return (REAL *) ((char *) ring + ring->offset)
+         + (head%FFD_RING_SIZE)*ring->stride;
+} /* End of ffd_ring_reserve()*/
+
+/*
+* Publish the message written in the reserved slot to the consumer
+*
+* @param cosim Pointer to the coupled simulation data
+* @param ring Pointer to the message ring
+*
+* @return No return needed
+*/
+void ffd_ring_commit(CosimulationData *cosim, MessageRing *ring) {
+  ffd_set_flag(cosim, &ring->head, ring->head+1);
+} /* End of ffd_ring_commit()*/
+
+/*
+* Get the oldest message of a message ring for the consumer
+*
+* @param cosim Pointer to the coupled simulation data
+* @param ring Pointer to the message ring
+* @param timeout Maximum waiting time in milliseconds if the ring is empty
+*
+* @return Pointer to the slot, NULL if the ring is still empty
+*/
+REAL *ffd_ring_peek(CosimulationData *cosim, MessageRing *ring, int timeout) {
+  /* Only the consumer changes the tail*/
+  int tail = ring->tail;
+
+  if(ffd_wait_flag(cosim, &ring->head, tail, 0, timeout)!=0)
+    return NULL;
+
+  return (REAL *) ((char *) ring + ring->offset)
+         + (tail%FFD_RING_SIZE)*ring->stride;
+} /* End of ffd_ring_peek()*/
+
+/*
+* Return the slot of the oldest message to the producer
+*
+* @param cosim Pointer to the coupled simulation data
+* @param ring Pointer to the message ring
+*
+* @return No return needed
+*/
+void ffd_ring_release(CosimulationData *cosim, MessageRing *ring) {
+  ffd_set_flag(cosim, &ring->tail, ring->tail+1);
+} /* End of ffd_ring_release()*/
@@ -31,12 +31,191 @@
 #ifdef _MSC_VER
 __declspec(dllexport)
 extern void *ffd_dll(CosimulationData *cosim);
+__declspec(dllexport)
+extern void ffd_free_sync(CosimulationData *cosim);
+__declspec(dllexport)
+extern void ffd_set_flag(CosimulationData *cosim, int *flag, int value);
+__declspec(dllexport)
+extern int ffd_wait_flag(CosimulationData *cosim, int *flag, int value,
+                         int equal, int timeout);
+__declspec(dllexport)
+extern REAL *ffd_ring_reserve(CosimulationData *cosim, MessageRing *ring,
+                              int timeout);
+__declspec(dllexport)
+extern void ffd_ring_commit(CosimulationData *cosim, MessageRing *ring);
+__declspec(dllexport)
+extern REAL *ffd_ring_peek(CosimulationData *cosim, MessageRing *ring,
+                           int timeout);
+__declspec(dllexport)
+extern void ffd_ring_release(CosimulationData *cosim, MessageRing *ring);
 /* Linux*/
 #else
 #include <pthread.h>
 void *ffd_dll(CosimulationData *cosim);
+
+/*
+	* Free the signalling object for the flags of the cosimulation and release
+	* the index of the FFD instance
+	*
+	* @param cosim Pointer to the coupled simulation data
+	*
+	* @return No return needed
+	*/
+void ffd_free_sync(CosimulationData *cosim);
+
+/*
+	* Set a flag of the cosimulation and wake up the waiting side
+	*
+	* @param cosim Pointer to the coupled simulation data
+	* @param flag Pointer to the flag
+	* @param value New value of the flag
+	*
+	* @return No return needed
+	*/
+void ffd_set_flag(CosimulationData *cosim, int *flag, int value);
+
+/*
+	* Wait until a flag of the cosimulation is (or is not) equal to a value
+	*
+	* @param cosim Pointer to the coupled simulation data
+	* @param flag Pointer to the flag
+	* @param value Value to compare with
+	* @param equal 1: wait until *flag==value; 0: wait until *flag!=value
+	* @param timeout Maximum waiting time in milliseconds
+	*
+	* @return 0 if the condition is met, 1 otherwise
+	*/
+int ffd_wait_flag(CosimulationData *cosim, int *flag, int value, int equal,
+                  int timeout);
+
+/*
+	* Get the free slot of a message ring for the producer
+	*
+	* @param cosim Pointer to the coupled simulation data
+	* @param ring Pointer to the message ring
+	* @param timeout Maximum waiting time in milliseconds if the ring is full
+	*
+	* @return Pointer to the slot, NULL if the ring is still full
+	*/
+REAL *ffd_ring_reserve(CosimulationData *cosim, MessageRing *ring,
+                       int timeout);
+
+/*
+	* Publish the message written in the reserved slot to the consumer
+	*
+	* @param cosim Pointer to the coupled simulation data
+	* @param ring Pointer to the message ring
+	*
+	* @return No return needed
+	*/
+void ffd_ring_commit(CosimulationData *cosim, MessageRing *ring);
+
+/*
+	* Get the oldest message of a message ring for the consumer
+	*
+	* @param cosim Pointer to the coupled simulation data
+	* @param ring Pointer to the message ring
+	* @param timeout Maximum waiting time in milliseconds if the ring is empty
+	*
+	* @return Pointer to the slot, NULL if the ring is still empty
+	*/
+REAL *ffd_ring_peek(CosimulationData *cosim, MessageRing *ring, int timeout);
+
+/*
+	* Return the slot of the oldest message to the producer
+	*
+	* @param cosim Pointer to the coupled simulation data
+	* @param ring Pointer to the message ring
+	*
+	* @return No return needed
+	*/
+void ffd_ring_release(CosimulationData *cosim, MessageRing *ring);
 #endif
 
+/*
+	* Create the signalling object for the flags of the cosimulation
+	*
+	* @param cosim Pointer to the coupled simulation data
+	*
+	* @return 0 if no error occurred
+	*/
+int ffd_init_sync(CosimulationData *cosim);
+
+/*
+	* Initialize a signalling object
+	*
+	* @param sync Pointer to the signalling object
+	* @param shared 1: the object is in memory shared by several processes
+	*
+	* @return 0 if no error occurred
+	*/
+int ffd_init_sync_object(FFD_SYNC *sync, int shared);
+
+/*
+	* Free a signalling object that is not in shared memory
+	*
+	* @param sync Pointer to the signalling object
+	*
+	* @return No return needed
+	*/
+void ffd_free_sync_object(FFD_SYNC *sync);
+
+/*
+	* Lock the mutex of a signalling object
+	*
+	* @param sync Pointer to the signalling object
+	*
+	* @return No return needed
+	*/
+void ffd_lock_sync(FFD_SYNC *sync);
+
+/*
+	* Unlock the mutex of a signalling object
+	*
+	* @param sync Pointer to the signalling object
+	*
+	* @return No return needed
+	*/
+void ffd_unlock_sync(FFD_SYNC *sync);
+
+/*
+	* Count a change and wake up all the waiting threads
+	*
+	* @param sync Pointer to the signalling object
+	*
+	* @return No return needed
+	*/
+void ffd_notify_sync(FFD_SYNC *sync);
+
+/*
+	* Wait until the number of changes differs from a value
+	*
+	* @param sync Pointer to the signalling object
+	* @param count Number of changes seen by the caller
+	* @param timeout Maximum waiting time in milliseconds
+	*
+	* @return No return needed
+	*/
+void ffd_wait_sync(FFD_SYNC *sync, int count, int timeout);
+
+/*
+	* Assign the index of an FFD instance
+	*
+	* @param cosim Pointer to the coupled simulation data
+	*
+	* @return No return needed
+	*/
+void ffd_add_instance(CosimulationData *cosim);
+
+/*
+	* Release the index of an FFD instance
+	*
+	* @param cosim Pointer to the coupled simulation data
+	*
+	* @return No return needed
+	*/
+void ffd_remove_instance(CosimulationData *cosim);
+
 
 /*
 	* Launch the FFD simulation through a thread
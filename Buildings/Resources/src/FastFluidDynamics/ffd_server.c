@@ -0,0 +1,685 @@
+/*
+	*
+	* @file   ffd_server.c
+	*
+	* @brief  Run the FFD simulation of Modelica rooms in a server process
+	*
+	* @author Xu Han
+	*         University of Colorado Boulder
+	*         xuha3556@colorado.edu
+	*
+	* @date   10/18/2026
+	*
+	* Modelica side: ffd_server_connect() copies the parameters of the room
+	* into shared memory and queues the room to the server. A thread of the
+	* Modelica process then passes the messages and the flags between the
+	* rings of Modelica and the rings in the shared memory. It reports an error
+	* to Modelica if the server dies.
+	*
+	* Server side: ffd_server() creates the queue of rooms and starts the
+	* workers. Each worker takes a room from the queue and runs FFD with the
+	* rings in the shared memory as if it was a thread of Modelica. The server
+	* stops a room if its Modelica process died.
+	*
+	*/
+
+/* Needed for shm_open(), kill() and pthread_setaffinity_np() with -std=c89*/
+#ifndef _MSC_VER
+#define _GNU_SOURCE
+#endif
+
+#include "ffd_server.h"
+
+#ifndef _FFD_DLL_H
+#define _FFD_DLL_H
+#include "ffd_dll.h"
+#endif
+
+#ifndef _MSC_VER
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+typedef struct {
+  CosimulationData *local; /* Data exchanged with Modelica*/
+  CosimulationData remote; /* Data exchanged with the server*/
+  FFD_ROOM *room; /* Shared memory of the room*/
+  char name[FFD_SERVER_NAME]; /* Name of the shared memory of the room*/
+}FFD_CLIENT; /* Connection of a Modelica room to the server*/
+
+typedef struct {
+  FFD_SERVER_DATA *server; /* Shared memory of the server*/
+  int index; /* Index of the worker*/
+  int pin; /* 1: bind the worker to a processor core*/
+  FFD_ROOM *room; /* Room simulated by the worker, NULL if idle*/
+  CosimulationData cosim; /* Data of the room seen by FFD*/
+}FFD_WORKER; /* Worker thread of the server*/
+
+/* Set by SIGINT and SIGTERM to stop the server*/
+static volatile sig_atomic_t server_stop = 0;
+
+/* Protect the rooms of the workers and the indexes of the FFD instances*/
+static pthread_mutex_t server_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+	* Round up a size to the next cache line
+	*
+	* @param size Size in bytes
+	*
+	* @return Rounded size in bytes
+	*/
+static size_t align_cache_line(size_t size) {
+  return ((size+FFD_CACHE_LINE-1)/FFD_CACHE_LINE)*FFD_CACHE_LINE;
+} /* End of align_cache_line()*/
+
+/*
+	* Check if a process has died
+	*
+	* @param pid Process ID
+	*
+	* @return 1 if the process does not exist anymore, 0 otherwise
+	*/
+static int process_died(long pid) {
+  return kill((pid_t) pid, 0)!=0 && errno==ESRCH;
+} /* End of process_died()*/
+
+/*
+	* Create a ring in the shared memory of a room
+	*
+	* @param room Pointer to the shared memory of the room
+	* @param offset Offset of the ring in the shared memory
+	* @param model Ring of Modelica with the same size
+	*
+	* @return Pointer to the ring
+	*/
+static MessageRing *init_room_ring(FFD_ROOM *room, size_t offset,
+                                   MessageRing *model) {
+  MessageRing *ring = (MessageRing *) ((char *) room + offset);
+
+  ring->head = 0;
+  ring->tail = 0;
+  ring->size = model->size;
+  ring->stride = model->stride;
+  ring->offset = (int) FFD_RING_OFFSET;
+  ring->mem = NULL;
+
+  return ring;
+} /* End of init_room_ring()*/
+
+/*
+	* Copy the messages from a ring to another
+	*
+	* @param from Pointer to the coupled simulation data of the source
+	* @param ring_from Pointer to the source ring
+	* @param to Pointer to the coupled simulation data of the destination
+	* @param ring_to Pointer to the destination ring
+	*
+	* @return No return needed
+	*/
+static void pass_messages(CosimulationData *from, MessageRing *ring_from,
+                          CosimulationData *to, MessageRing *ring_to) {
+  REAL *src, *dst;
+
+  while((src=ffd_ring_peek(from, ring_from, 0))!=NULL
+        && (dst=ffd_ring_reserve(to, ring_to, 0))!=NULL) {
+    memcpy(dst, src, ring_from->size*sizeof(REAL));
+    ffd_ring_commit(to, ring_to);
+    ffd_ring_release(from, ring_from);
+  }
+} /* End of pass_messages()*/
+
+/*
+	* Pass the messages and flags between Modelica and the server
+	*
+	* @param p Pointer to the connection
+	*
+	* @return No return needed
+	*/
+static void *client_thread(void *p) {
+  FFD_CLIENT *client = (FFD_CLIENT *) p;
+  CosimulationData *local = client->local;
+  CosimulationData *remote = &client->remote;
+  FFD_ROOM *room = client->room;
+  int count, error = 0;
+
+  for(;;) {
+    /* Every change of the flags of Modelica or the server increases count*/
+    count = room->sync.count;
+
+    pass_messages(local, local->input, remote, remote->input);
+    pass_messages(remote, remote->output, local, local->output);
+
+    if(local->para->flag==0 && room->para.flag==1)
+      ffd_set_flag(remote, &room->para.flag, 0);
+
+    if(room->para.ffdError==1) {
+      error = 1;
+      break;
+    }
+    if(room->para.flag==2)
+      break;
+    if(process_died(room->server)) {
+      shm_unlink(client->name);
+      sprintf(room->msg, "ERROR in FFD: The FFD server terminated "
+              "unexpectedly\n");
+      error = 1;
+      break;
+    }
+
+    ffd_wait_flag(remote, &room->sync.count, count, 0, 1000);
+  }
+
+  /* Modelica releases the connection once the flag is set*/
+  ((FFD_SYNC *) local->sync)->peer = NULL;
+
+  if(error) {
+    if(local->ffd->msg==NULL)
+      local->ffd->msg = (char *) malloc(FFD_SERVER_MSG*sizeof(char));
+    if(local->ffd->msg!=NULL) {
+      strncpy(local->ffd->msg, room->msg, FFD_SERVER_MSG-1);
+      local->ffd->msg[FFD_SERVER_MSG-1] = '\0';
+    }
+    ffd_set_flag(local, &local->para->flag, 2);
+    ffd_set_flag(local, &local->para->ffdError, 1);
+  }
+  else
+    ffd_set_flag(local, &local->para->flag, 2);
+
+  return NULL;
+} /* End of client_thread()*/
+
+/*
+	* Run the FFD simulation of a room in the FFD server
+	*
+	* @param cosim Pointer to the coupled simulation data
+	* @param name Name of the shared memory of the server
+	*
+	* @return Pointer to the connection, NULL if an error occurred
+	*/
+void *ffd_server_connect(CosimulationData *cosim, const char *name) {
+  ParameterSharedData *para = cosim->para;
+  FFD_SERVER_DATA *server;
+  FFD_CLIENT *client;
+  FFD_ROOM *room;
+  pthread_t thread;
+  pthread_attr_t attr;
+  size_t size, text_size;
+  char *text;
+  int fd, i, flag;
+
+  /****************************************************************************
+  | Open the shared memory of the server
+  ****************************************************************************/
+  fd = shm_open(name, O_RDWR, 0);
+  if(fd<0) return NULL;
+  server = (FFD_SERVER_DATA *) mmap(NULL, sizeof(FFD_SERVER_DATA),
+                                    PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if(server==MAP_FAILED) return NULL;
+  if(server->magic!=FFD_SERVER_MAGIC || process_died(server->pid)) {
+    munmap(server, sizeof(FFD_SERVER_DATA));
+    return NULL;
+  }
+
+  client = (FFD_CLIENT *) calloc(1, sizeof(FFD_CLIENT));
+  if(client==NULL) {
+    munmap(server, sizeof(FFD_SERVER_DATA));
+    return NULL;
+  }
+  client->local = cosim;
+
+  /****************************************************************************
+  | Layout of the room: header, names, areas, tilts, boundary conditions and
+  | the rings with the same sizes as the rings of Modelica
+  ****************************************************************************/
+  text_size = strlen(para->fileName) + 1;
+  for(i=0; i<para->nSur; i++) text_size += strlen(para->name[i]) + 1;
+  for(i=0; i<para->nPorts; i++) text_size += strlen(para->portName[i]) + 1;
+  for(i=0; i<para->nSen; i++) text_size += strlen(para->sensorName[i]) + 1;
+
+  size = align_cache_line(sizeof(FFD_ROOM));
+  size += align_cache_line(text_size);
+  size += 2*align_cache_line(para->nSur*sizeof(REAL));
+  size += align_cache_line(para->nSur*sizeof(int));
+  size += FFD_RING_OFFSET + FFD_RING_SIZE*cosim->input->stride*sizeof(REAL);
+  size += FFD_RING_OFFSET + FFD_RING_SIZE*cosim->output->stride*sizeof(REAL);
+
+  /****************************************************************************
+  | Create the shared memory of the room
+  ****************************************************************************/
+  sprintf(client->name, "/ffd_%ld_%d", (long) getpid(), cosim->id);
+  shm_unlink(client->name);
+  fd = shm_open(client->name, O_CREAT|O_EXCL|O_RDWR, S_IRUSR|S_IWUSR);
+  if(fd<0) {
+    munmap(server, sizeof(FFD_SERVER_DATA));
+    free(client);
+    return NULL;
+  }
+  if(ftruncate(fd, (off_t) size)!=0)
+    room = (FFD_ROOM *) MAP_FAILED;
+  else
+    room = (FFD_ROOM *) mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_SHARED,
+                             fd, 0);
+  close(fd);
+  if(room==MAP_FAILED || ffd_init_sync_object(&room->sync, 1)!=0) {
+    if(room!=MAP_FAILED) munmap(room, size);
+    shm_unlink(client->name);
+    munmap(server, sizeof(FFD_SERVER_DATA));
+    free(client);
+    return NULL;
+  }
+  client->room = room;
+
+  room->state = ROOM_WAITING;
+  room->client = (long) getpid();
+  room->server = server->pid;
+  room->size = size;
+  room->para = *para;
+
+  room->text = align_cache_line(sizeof(FFD_ROOM));
+  room->are = room->text + align_cache_line(text_size);
+  room->til = room->are + align_cache_line(para->nSur*sizeof(REAL));
+  room->bouCon = room->til + align_cache_line(para->nSur*sizeof(REAL));
+  room->input = room->bouCon + align_cache_line(para->nSur*sizeof(int));
+  room->output = room->input + FFD_RING_OFFSET
+               + FFD_RING_SIZE*cosim->input->stride*sizeof(REAL);
+
+  text = (char *) room + room->text;
+  strcpy(text, para->fileName);
+  text += strlen(text) + 1;
+  for(i=0; i<para->nSur; i++) {
+    strcpy(text, para->name[i]);
+    text += strlen(text) + 1;
+  }
+  for(i=0; i<para->nPorts; i++) {
+    strcpy(text, para->portName[i]);
+    text += strlen(text) + 1;
+  }
+  for(i=0; i<para->nSen; i++) {
+    strcpy(text, para->sensorName[i]);
+    text += strlen(text) + 1;
+  }
+  for(i=0; i<para->nSur; i++) {
+    ((REAL *) ((char *) room + room->are))[i] = para->are[i];
+    ((REAL *) ((char *) room + room->til))[i] = para->til[i];
+    ((int *) ((char *) room + room->bouCon))[i] = para->bouCon[i];
+  }
+
+  client->remote.para = &room->para;
+  client->remote.input = init_room_ring(room, room->input, cosim->input);
+  client->remote.output = init_room_ring(room, room->output, cosim->output);
+  client->remote.id = cosim->id;
+  client->remote.sync = (void *) &room->sync;
+  room->magic = FFD_SERVER_MAGIC;
+
+  /****************************************************************************
+  | Queue the room and start passing the data
+  ****************************************************************************/
+  ffd_lock_sync(&server->sync);
+  flag = server->head-server->tail<FFD_SERVER_QUEUE;
+  if(flag) {
+    strcpy(server->room[server->head%FFD_SERVER_QUEUE], client->name);
+    server->head++;
+    ffd_notify_sync(&server->sync);
+  }
+  ffd_unlock_sync(&server->sync);
+  munmap(server, sizeof(FFD_SERVER_DATA));
+
+  /* Wake up the thread passing the data when Modelica changes a flag*/
+  ((FFD_SYNC *) cosim->sync)->peer = &room->sync;
+
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  if(flag)
+    flag = pthread_create(&thread, &attr, client_thread, (void *) client)==0;
+  pthread_attr_destroy(&attr);
+
+  if(!flag) {
+    ((FFD_SYNC *) cosim->sync)->peer = NULL;
+    /* Stop the room in case a worker has already taken it*/
+    ffd_set_flag(&client->remote, &room->para.flag, 0);
+    ffd_server_disconnect(client);
+    return NULL;
+  }
+
+  return client;
+} /* End of ffd_server_connect()*/
+
+/*
+	* Release the connection to the FFD server after FFD stopped
+	*
+	* @param p Pointer to the connection
+	*
+	* @return No return needed
+	*/
+void ffd_server_disconnect(void *p) {
+  FFD_CLIENT *client = (FFD_CLIENT *) p;
+
+  shm_unlink(client->name);
+  munmap(client->room, client->room->size);
+  free(client);
+} /* End of ffd_server_disconnect()*/
+
+/*
+	* Run FFD for a room taken from the queue
+	*
+	* @param worker Pointer to the worker
+	* @param name Name of the shared memory of the room
+	*
+	* @return 0 if no error occurred
+	*/
+static int host_room(FFD_WORKER *worker, const char *name) {
+  CosimulationData *cosim = &worker->cosim;
+  ParameterSharedData *para;
+  FFD_ROOM *room;
+  struct stat info;
+  char *text;
+  int fd, i;
+
+  fd = shm_open(name, O_RDWR, 0);
+  if(fd<0) {
+    printf("ffd_server(): Room %s does not exist anymore\n", name);
+    return 1;
+  }
+  if(fstat(fd, &info)!=0 || (size_t) info.st_size<sizeof(FFD_ROOM))
+    room = (FFD_ROOM *) MAP_FAILED;
+  else
+    room = (FFD_ROOM *) mmap(NULL, (size_t) info.st_size,
+                             PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if(room==MAP_FAILED) {
+    printf("ffd_server(): Could not open room %s\n", name);
+    return 1;
+  }
+  if(room->magic!=FFD_SERVER_MAGIC || room->size!=(size_t) info.st_size) {
+    printf("ffd_server(): Room %s is not valid\n", name);
+    munmap(room, (size_t) info.st_size);
+    return 1;
+  }
+
+  /****************************************************************************
+  | Point the parameters to the data in the shared memory
+  ****************************************************************************/
+  para = &room->para;
+  memset(cosim, 0, sizeof(CosimulationData));
+  cosim->para = para;
+  cosim->sync = (void *) &room->sync;
+  cosim->modelica = (ModelicaSharedData *) calloc(1, sizeof(ModelicaSharedData));
+  cosim->ffd = (ffdSharedData *) calloc(1, sizeof(ffdSharedData));
+  para->name = (char **) calloc(para->nSur+1, sizeof(char *));
+  para->portName = (char **) calloc(para->nPorts+1, sizeof(char *));
+  para->sensorName = (char **) calloc(para->nSen+1, sizeof(char *));
+  if(cosim->modelica!=NULL && cosim->ffd!=NULL) {
+    cosim->modelica->XiPor = (REAL **) calloc(para->nPorts+1, sizeof(REAL *));
+    cosim->modelica->CPor = (REAL **) calloc(para->nPorts+1, sizeof(REAL *));
+    cosim->ffd->XiPor = (REAL **) calloc(para->nPorts+1, sizeof(REAL *));
+    cosim->ffd->CPor = (REAL **) calloc(para->nPorts+1, sizeof(REAL *));
+  }
+
+  if(cosim->modelica==NULL || cosim->ffd==NULL || para->name==NULL
+     || para->portName==NULL || para->sensorName==NULL
+     || cosim->modelica->XiPor==NULL || cosim->modelica->CPor==NULL
+     || cosim->ffd->XiPor==NULL || cosim->ffd->CPor==NULL) {
+    strcpy(room->msg, "ERROR in FFD: Could not allocate memory in the "
+           "FFD server\n");
+    ffd_set_flag(cosim, &para->ffdError, 1);
+  }
+  else {
+    text = (char *) room + room->text;
+    para->fileName = text;
+    text += strlen(text) + 1;
+    for(i=0; i<para->nSur; i++) {
+      para->name[i] = text;
+      text += strlen(text) + 1;
+    }
+    for(i=0; i<para->nPorts; i++) {
+      para->portName[i] = text;
+      text += strlen(text) + 1;
+    }
+    for(i=0; i<para->nSen; i++) {
+      para->sensorName[i] = text;
+      text += strlen(text) + 1;
+    }
+    para->are = (REAL *) ((char *) room + room->are);
+    para->til = (REAL *) ((char *) room + room->til);
+    para->bouCon = (int *) ((char *) room + room->bouCon);
+
+    cosim->ffd->msg = room->msg;
+    cosim->input = (MessageRing *) ((char *) room + room->input);
+    cosim->output = (MessageRing *) ((char *) room + room->output);
+
+    pthread_mutex_lock(&server_lock);
+    ffd_add_instance(cosim);
+    worker->room = room;
+    pthread_mutex_unlock(&server_lock);
+
+    /**************************************************************************
+    | Run FFD unless Modelica already stopped
+    **************************************************************************/
+    if(para->flag==1) {
+      printf("ffd_server(): Worker %d runs room %s\n", worker->index, name);
+      ffd_set_flag(cosim, &room->state, ROOM_RUNNING);
+      ffd_thread((void *) cosim);
+      set_log_instance(NULL);
+    }
+    else
+      ffd_set_flag(cosim, &para->flag, 2);
+
+    pthread_mutex_lock(&server_lock);
+    worker->room = NULL;
+    ffd_remove_instance(cosim);
+    pthread_mutex_unlock(&server_lock);
+  }
+
+  ffd_set_flag(cosim, &room->state, ROOM_DONE);
+
+  if(cosim->modelica!=NULL) {
+    free(cosim->modelica->XiPor);
+    free(cosim->modelica->CPor);
+    free(cosim->modelica);
+  }
+  if(cosim->ffd!=NULL) {
+    free(cosim->ffd->XiPor);
+    free(cosim->ffd->CPor);
+    free(cosim->ffd);
+  }
+  free(para->name);
+  free(para->portName);
+  free(para->sensorName);
+
+  /* Modelica may have died, so the server also removes the room*/
+  shm_unlink(name);
+  munmap(room, (size_t) info.st_size);
+
+  return 0;
+} /* End of host_room()*/
+
+/*
+	* Take the rooms from the queue and run them
+	*
+	* @param p Pointer to the worker
+	*
+	* @return No return needed
+	*/
+static void *worker_thread(void *p) {
+  FFD_WORKER *worker = (FFD_WORKER *) p;
+  FFD_SERVER_DATA *server = worker->server;
+  char name[FFD_SERVER_NAME];
+#ifdef __linux__
+  cpu_set_t cpus;
+
+  if(worker->pin) {
+    CPU_ZERO(&cpus);
+    CPU_SET(worker->index%sysconf(_SC_NPROCESSORS_ONLN), &cpus);
+    if(pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus)!=0)
+      printf("ffd_server(): Could not bind worker %d to a core\n",
+             worker->index);
+  }
+#endif
+
+  for(;;) {
+    ffd_lock_sync(&server->sync);
+    while(server->head==server->tail)
+      ffd_wait_sync(&server->sync, server->sync.count, 1000);
+    strncpy(name, server->room[server->tail%FFD_SERVER_QUEUE],
+            FFD_SERVER_NAME-1);
+    name[FFD_SERVER_NAME-1] = '\0';
+    server->tail++;
+    ffd_unlock_sync(&server->sync);
+
+    host_room(worker, name);
+  }
+
+  return NULL;
+} /* End of worker_thread()*/
+
+/*
+	* Stop the server at the next check
+	*
+	* @param sig Signal number
+	*
+	* @return No return needed
+	*/
+static void stop_server(int sig) {
+  server_stop = 1;
+} /* End of stop_server()*/
+
+/*
+	* Create the shared memory of the server
+	*
+	* An existing server with the same name is replaced only if it has died.
+	*
+	* @param name Name of the shared memory of the server
+	*
+	* @return Pointer to the shared memory, NULL if an error occurred
+	*/
+static FFD_SERVER_DATA *create_server(const char *name) {
+  FFD_SERVER_DATA *server;
+  int fd;
+
+  fd = shm_open(name, O_CREAT|O_EXCL|O_RDWR, S_IRUSR|S_IWUSR);
+  if(fd<0 && errno==EEXIST) {
+    fd = shm_open(name, O_RDWR, 0);
+    if(fd>=0) {
+      server = (FFD_SERVER_DATA *) mmap(NULL, sizeof(FFD_SERVER_DATA),
+                                        PROT_READ, MAP_SHARED, fd, 0);
+      close(fd);
+      if(server!=MAP_FAILED) {
+        fd = server->magic==FFD_SERVER_MAGIC && !process_died(server->pid);
+        munmap(server, sizeof(FFD_SERVER_DATA));
+        if(fd) {
+          printf("ffd_server(): Server %s is already running\n", name);
+          return NULL;
+        }
+      }
+    }
+    shm_unlink(name);
+    fd = shm_open(name, O_CREAT|O_EXCL|O_RDWR, S_IRUSR|S_IWUSR);
+  }
+  if(fd<0) {
+    printf("ffd_server(): Could not create shared memory %s\n", name);
+    return NULL;
+  }
+
+  if(ftruncate(fd, (off_t) sizeof(FFD_SERVER_DATA))!=0)
+    server = (FFD_SERVER_DATA *) MAP_FAILED;
+  else
+    server = (FFD_SERVER_DATA *) mmap(NULL, sizeof(FFD_SERVER_DATA),
+                                      PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if(server==MAP_FAILED || ffd_init_sync_object(&server->sync, 1)!=0) {
+    printf("ffd_server(): Could not map shared memory %s\n", name);
+    if(server!=MAP_FAILED) munmap(server, sizeof(FFD_SERVER_DATA));
+    shm_unlink(name);
+    return NULL;
+  }
+
+  return server;
+} /* End of create_server()*/
+
+/*
+	* Run the FFD server until it receives SIGINT or SIGTERM
+	*
+	* @param name Name of the shared memory of the server
+	* @param nb_worker Number of worker threads
+	* @param pin 1: bind the worker threads to the processor cores
+	*
+	* @return 0 if no error occurred
+	*/
+int ffd_server(const char *name, int nb_worker, int pin) {
+  FFD_SERVER_DATA *server;
+  FFD_WORKER *worker;
+  pthread_t thread;
+  pthread_attr_t attr;
+  FFD_ROOM *room;
+  int i;
+
+  if(strlen(name)>=FFD_SERVER_NAME || nb_worker<1) {
+    printf("ffd_server(): Invalid name or number of workers\n");
+    return 1;
+  }
+
+  worker = (FFD_WORKER *) calloc(nb_worker, sizeof(FFD_WORKER));
+  if(worker==NULL) {
+    printf("ffd_server(): Could not allocate memory for the workers\n");
+    return 1;
+  }
+
+  server = create_server(name);
+  if(server==NULL) {
+    free(worker);
+    return 1;
+  }
+  server->pid = (long) getpid();
+  server->nb_worker = nb_worker;
+  server->magic = FFD_SERVER_MAGIC;
+
+  signal(SIGINT, stop_server);
+  signal(SIGTERM, stop_server);
+
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  for(i=0; i<nb_worker; i++) {
+    worker[i].server = server;
+    worker[i].index = i;
+    worker[i].pin = pin;
+    if(pthread_create(&thread, &attr, worker_thread, (void *) &worker[i])!=0) {
+      printf("ffd_server(): Could not start worker %d\n", i);
+      break;
+    }
+  }
+  pthread_attr_destroy(&attr);
+  if(i<nb_worker) {
+    shm_unlink(name);
+    return 1;
+  }
+
+  printf("ffd_server(): Server %s runs with %d workers\n", name, nb_worker);
+
+  /****************************************************************************
+  | Stop the rooms whose Modelica process died
+  ****************************************************************************/
+  while(!server_stop) {
+    sleep(1);
+    pthread_mutex_lock(&server_lock);
+    for(i=0; i<nb_worker; i++) {
+      room = worker[i].room;
+      if(room!=NULL && room->para.flag==1 && process_died(room->client)) {
+        printf("ffd_server(): Modelica of room %d died; stop the room\n",
+               worker[i].cosim.id);
+        ffd_set_flag(&worker[i].cosim, &room->para.flag, 0);
+      }
+    }
+    pthread_mutex_unlock(&server_lock);
+  }
+
+  /* The rooms still running will find that the server has died*/
+  printf("ffd_server(): Server %s stopped\n", name);
+  shm_unlink(name);
+
+  return 0;
+} /* End of ffd_server()*/
+#endif
@@ -0,0 +1,106 @@
+/*
+	*
+	* @file   ffd_server.h
+	*
+	* @brief  Run the FFD simulation of Modelica rooms in a server process
+	*
+	* @author Xu Han
+	*         University of Colorado Boulder
+	*         xuha3556@colorado.edu
+	*
+	* @date   10/18/2026
+	*
+	* The server hosts the rooms of several Modelica simulations on one
+	* computer with a fixed number of worker threads. Each room exchanges the
+	* data with Modelica through a segment of POSIX shared memory, so that a
+	* crash of FFD does not terminate the Modelica simulation.
+	*
+	* Modelica uses the server if the environment variable FFD_SERVER names
+	* it, such as FFD_SERVER=/ffd_server. Otherwise FFD runs in a thread of the
+	* Modelica process. The server is only available on Linux.
+	*
+	*/
+#ifndef _FFD_SERVER_H
+#define _FFD_SERVER_H
+#endif
+
+#ifndef _DATA_STRUCTURE_H
+#define _DATA_STRUCTURE_H
+#include "data_structure.h"
+#endif
+
+/* Environment variable with the name of the FFD server*/
+#define FFD_SERVER_ENV "FFD_SERVER"
+/* Maximum number of rooms waiting for a worker*/
+#define FFD_SERVER_QUEUE 64
+/* Maximum length of the names of the shared memory*/
+#define FFD_SERVER_NAME 64
+/* Length of the error message passed to Modelica*/
+#define FFD_SERVER_MSG 400
+/* Identify the shared memory created by FFD*/
+#define FFD_SERVER_MAGIC 0x46464431
+
+#ifndef _MSC_VER
+typedef struct {
+  FFD_SYNC sync; /* Protect the queue of rooms*/
+  int magic; /* FFD_SERVER_MAGIC*/
+  long pid; /* Process ID of the server*/
+  int nb_worker; /* Number of worker threads*/
+  int head; /* Number of rooms sent by Modelica*/
+  int tail; /* Number of rooms taken by the workers*/
+  char room[FFD_SERVER_QUEUE][FFD_SERVER_NAME]; /* Rooms waiting for a worker*/
+}FFD_SERVER_DATA; /* Shared memory of the server*/
+
+typedef enum{ROOM_WAITING, ROOM_RUNNING, ROOM_DONE} FFD_ROOM_STATE;
+
+typedef struct {
+  FFD_SYNC sync; /* Protect the flags and the rings of the room*/
+  int magic; /* FFD_SERVER_MAGIC*/
+  int state; /* FFD_ROOM_STATE, set by the server*/
+  long client; /* Process ID of Modelica*/
+  long server; /* Process ID of the server*/
+  size_t size; /* Size of the shared memory in bytes*/
+  ParameterSharedData para; /* The pointers are only valid in the server*/
+  char msg[FFD_SERVER_MSG]; /* Error message of FFD*/
+  size_t text; /* Offset of the file name, surface, port and sensor names*/
+  size_t are; /* Offset of the areas of the surfaces*/
+  size_t til; /* Offset of the tilts of the surfaces*/
+  size_t bouCon; /* Offset of the thermal boundary conditions*/
+  size_t input; /* Offset of the ring from Modelica to FFD*/
+  size_t output; /* Offset of the ring from FFD to Modelica*/
+}FFD_ROOM; /* Shared memory of a room, followed by the data at the offsets*/
+
+/*
+	* Run the FFD simulation of a room in the FFD server
+	*
+	* Copy the parameters and create the rings of the room in shared memory,
+	* queue the room to the server and start a thread that passes the messages
+	* and the flags between Modelica and the server.
+	*
+	* @param cosim Pointer to the coupled simulation data
+	* @param name Name of the shared memory of the server
+	*
+	* @return Pointer to the connection, NULL if an error occurred
+	*/
+void *ffd_server_connect(CosimulationData *cosim, const char *name);
+
+/*
+	* Release the connection to the FFD server after FFD stopped
+	*
+	* @param p Pointer to the connection
+	*
+	* @return No return needed
+	*/
+void ffd_server_disconnect(void *p);
+
+/*
+	* Run the FFD server until it receives SIGINT or SIGTERM
+	*
+	* @param name Name of the shared memory of the server
+	* @param nb_worker Number of worker threads
+	* @param pin 1: bind the worker threads to the processor cores
+	*
+	* @return 0 if no error occurred
+	*/
+int ffd_server(const char *name, int nb_worker, int pin);
+#endif
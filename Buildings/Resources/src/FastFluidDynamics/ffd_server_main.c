@@ -0,0 +1,45 @@
+/*
+	*
+	* @file   ffd_server_main.c
+	*
+	* @brief  Command line of the FFD server
+	*
+	* @author Xu Han
+	*         University of Colorado Boulder
+	*         xuha3556@colorado.edu
+	*
+	* @date   10/18/2026
+	*
+	* Usage: ffd_server [-w workers] [-p] [name]
+	*   -w  Number of worker threads, default is the number of processor cores
+	*   -p  Bind each worker thread to a processor core
+	*   name  Name of the shared memory, default is /ffd_server
+	*
+	* Set FFD_SERVER to the same name in the environment of the Modelica
+	* simulations to run their rooms in the server.
+	*
+	*/
+
+#include "ffd_server.h"
+
+int main(int argc, char **argv) {
+  const char *name = "/ffd_server";
+  int nb_worker = (int) sysconf(_SC_NPROCESSORS_ONLN);
+  int pin = 0;
+  int i;
+
+  for(i=1; i<argc; i++) {
+    if(strcmp(argv[i], "-w")==0 && i+1<argc)
+      nb_worker = atoi(argv[++i]);
+    else if(strcmp(argv[i], "-p")==0)
+      pin = 1;
+    else if(argv[i][0]=='/')
+      name = argv[i];
+    else {
+      printf("Usage: %s [-w workers] [-p] [name]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  return ffd_server(name, nb_worker, pin);
+} /* End of main()*/
@@ -193,10 +193,15 @@ int bounary_area(PARA_DATA *para, REAL **var, int **BINDEX) {
   REAL *AWall = para->bc->AWall;
   REAL *APort = para->bc->APort;
 
-  if(para->bc->nb_wall>0)
-    for(id=0; id<para->bc->nb_wall; id++) AWall[id] = 0;
-  if(para->bc->nb_port>0)
-    for(id=0; id<para->bc->nb_port; id++) APort[id] = 0;
+  /* The areas of a cached geometry were loaded with the cells*/
+  if(para->geom->cached==1)
+    index = 0;
+  else {
+    if(para->bc->nb_wall>0)
+      for(id=0; id<para->bc->nb_wall; id++) AWall[id] = 0;
+    if(para->bc->nb_port>0)
+      for(id=0; id<para->bc->nb_port; id++) APort[id] = 0;
+  }
 
   for(it=0; it<index; it++) {
     i = BINDEX[0][it];
@@ -295,3 +300,182 @@ int bounary_area(PARA_DATA *para, REAL **var, int **BINDEX) {
   }
   return 0;
 } /* End of bounary_area()*/
+
+	/*
+		* Compare two boundary faces by boundary type, boundary ID and position
+		*
+		* @param a Pointer to the first boundary face
+		* @param b Pointer to the second boundary face
+		*
+		* @return Negative, zero or positive value for qsort()
+		*/
+int compare_boundary_face(const void *a, const void *b) {
+  const BOUNDARY_FACE *fa = (const BOUNDARY_FACE *) a;
+  const BOUNDARY_FACE *fb = (const BOUNDARY_FACE *) b;
+
+  if(fa->type!=fb->type) return fa->type - fb->type;
+  if(fa->id!=fb->id) return fa->id - fb->id;
+  if(fa->it!=fb->it) return fa->it - fb->it;
+  return fa->dir - fb->dir;
+} /* End of compare_boundary_face()*/
+
+	/*
+		* Build the table of boundary faces
+		*
+		* Each inlet and outlet cell has one face toward the domain. Each solid
+		* cell has one face for every fluid neighbor. The face stores the
+		* direction, the offset of the neighbor and the area, so that the
+		* boundary routines do not need to recompute them. The faces are sorted
+		* by boundary type and boundary ID, and the faces of type t are
+		* para->geom->face[face_start[t]] to para->geom->face[face_start[t+1]-1].
+		*
+		* @param para Pointer to FFD parameters
+		* @param var Pointer to FFD simulation variables
+		* @param BINDEX Pointer to boundary index
+		*
+		* @return 0 if no error occurred
+		*/
+int boundary_face(PARA_DATA *para, REAL **var, int **BINDEX) {
+  int i, j, k, it, n, t, nb_face;
+  int index = para->geom->index, imax = para->geom->imax,
+      jmax = para->geom->jmax, kmax = para->geom->kmax;
+  int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
+  int ii, jj, kk;
+  int di[6] = {-1, 1, 0, 0, 0, 0};
+  int dj[6] = {0, 0, -1, 1, 0, 0};
+  int dk[6] = {0, 0, 0, 0, -1, 1};
+  REAL *flagp = var[FLAGP];
+  BOUNDARY_FACE *face;
+
+  /****************************************************************************
+  | Allocate memory for the faces: at most 6 faces for each boundary cell
+  ****************************************************************************/
+  if(para->geom->face!=NULL) free(para->geom->face);
+  para->geom->face = (BOUNDARY_FACE *) malloc((6*index+1)*sizeof(BOUNDARY_FACE));
+  if(para->geom->face==NULL) {
+    ffd_log("boundary_face(): Could not allocate memory for the boundary "
+            "faces.", FFD_ERROR);
+    return 1;
+  }
+  face = para->geom->face;
+
+  /****************************************************************************
+  | Find the faces of all the boundary cells
+  ****************************************************************************/
+  nb_face = 0;
+  for(it=0; it<index; it++) {
+    i = BINDEX[0][it];
+    j = BINDEX[1][it];
+    k = BINDEX[2][it];
+    t = (int) flagp[IX(i,j,k)];
+
+    for(n=0; n<6; n++) {
+      ii = i + di[n];
+      jj = j + dj[n];
+      kk = k + dk[n];
+      if(ii<0 || ii>imax+1 || jj<0 || jj>jmax+1 || kk<0 || kk>kmax+1)
+        continue;
+
+      /* Inlet and outlet face the domain from where they are located*/
+      if(t==INLET || t==OUTLET) {
+        if(!(  (n==1 && i==0) || (n==0 && i==imax+1)
+            || (n==3 && j==0) || (n==2 && j==jmax+1)
+            || (n==5 && k==0) || (n==4 && k==kmax+1)))
+          continue;
+      }
+      /* Solid cell faces each of its fluid neighbors*/
+      else if(t==SOLID) {
+        if(flagp[IX(ii,jj,kk)]!=FLUID) continue;
+      }
+      else
+        continue;
+
+      face[nb_face].i = i;
+      face[nb_face].j = j;
+      face[nb_face].k = k;
+      face[nb_face].it = it;
+      face[nb_face].dir = n;
+      face[nb_face].nb = IX(ii,jj,kk) - IX(i,j,k);
+      /* Staggered velocity is stored on the face at the positive side*/
+      face[nb_face].vel = n%2==1 ? 0 : face[nb_face].nb;
+      face[nb_face].type = t;
+      face[nb_face].id = BINDEX[4][it];
+      if(n<2)
+        face[nb_face].area = area_yz(para, var, i, j, k);
+      else if(n<4)
+        face[nb_face].area = area_zx(para, var, i, j, k);
+      else
+        face[nb_face].area = area_xy(para, var, i, j, k);
+      nb_face++;
+    }
+  } /* End of for(it=0; it<index; it++)*/
+
+  /****************************************************************************
+  | Sort the faces and find the range of each boundary type
+  ****************************************************************************/
+  qsort(face, nb_face, sizeof(BOUNDARY_FACE), compare_boundary_face);
+  para->geom->nb_face = nb_face;
+
+  for(t=0, n=0; t<4; t++) {
+    while(n<nb_face && face[n].type<t) n++;
+    para->geom->face_start[t] = n;
+  }
+
+  sprintf(msg, "boundary_face(): Found %d faces for %d boundary cells "
+          "(inlet: %d, solid: %d, outlet: %d).", nb_face, index,
+          para->geom->face_start[SOLID]-para->geom->face_start[INLET],
+          para->geom->face_start[OUTLET]-para->geom->face_start[SOLID],
+          para->geom->face_start[OUTLET+1]-para->geom->face_start[OUTLET]);
+  ffd_log(msg, FFD_NORMAL);
+
+  return 0;
+} /* End of boundary_face()*/
+
+	/*
+		* Update the type of inlet and outlet faces
+		*
+		* A port can change between inlet and outlet during the cosimulation.
+		* The faces are sorted again if any port changed its type.
+		*
+		* @param para Pointer to FFD parameters
+		* @param var Pointer to FFD simulation variables
+		*
+		* @return 0 if no error occurred
+		*/
+int update_boundary_face(PARA_DATA *para, REAL **var) {
+  int f, t, changed = 0;
+  int imax = para->geom->imax, jmax = para->geom->jmax;
+  int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
+  int nb_face = para->geom->nb_face;
+  REAL *flagp = var[FLAGP];
+  BOUNDARY_FACE *face = para->geom->face;
+
+  for(f=0; f<nb_face; f++) {
+    if(face[f].type==SOLID) continue;
+    t = (int) flagp[IX(face[f].i,face[f].j,face[f].k)];
+    if(t!=face[f].type) {
+      face[f].type = t;
+      changed = 1;
+    }
+  }
+
+  if(changed==0) return 0;
+
+  qsort(face, nb_face, sizeof(BOUNDARY_FACE), compare_boundary_face);
+  for(t=0, f=0; t<4; t++) {
+    while(f<nb_face && face[f].type<t) f++;
+    para->geom->face_start[t] = f;
+  }
+
+  /* The cached coefficients are indexed by face and have to be rebuilt*/
+  if(para->cache->h!=NULL) {
+    free(para->cache->h);
+    para->cache->h = NULL;
+  }
+  para->cache->step = -1;
+
+  ffd_log("update_boundary_face(): Sorted the boundary faces again after "
+          "ports changed between inlet and outlet.", FFD_NORMAL);
+
+  return 0;
+} /* End of update_boundary_face()*/
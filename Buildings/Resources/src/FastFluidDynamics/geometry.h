@@ -138,3 +138,34 @@ REAL length_z(PARA_DATA *para, REAL **var, int i, int j, int k);
 	* @return 0 if no error occurred
 	*/
 int bounary_area(PARA_DATA *para, REAL **var, int **BINDEX);
+
+/*
+	* Compare two boundary faces by boundary type, boundary ID and position
+	*
+	* @param a Pointer to the first boundary face
+	* @param b Pointer to the second boundary face
+	*
+	* @return Negative, zero or positive value for qsort()
+	*/
+int compare_boundary_face(const void *a, const void *b);
+
+/*
+	* Build the table of boundary faces
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	* @param BINDEX Pointer to boundary index
+	*
+	* @return 0 if no error occurred
+	*/
+int boundary_face(PARA_DATA *para, REAL **var, int **BINDEX);
+
+/*
+	* Update the type of inlet and outlet faces
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	*
+	* @return 0 if no error occurred
+	*/
+int update_boundary_face(PARA_DATA *para, REAL **var);
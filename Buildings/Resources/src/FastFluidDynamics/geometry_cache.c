@@ -0,0 +1,353 @@
+/*
+	*
+	* \file   geometry_cache.c
+	*
+	* \brief  Store the preprocessed geometry in a cache shared by the runs
+	*
+	* \author Xu Han
+	*         University of Colorado Boulder
+	*         xuha3556@colorado.edu
+	*
+	* \date   10/18/2026
+	*
+	* A cached geometry is written to a temporary file and renamed, so that
+	* runs started at the same time never read an incomplete file.
+	*
+	*/
+
+#include "geometry_cache.h"
+
+#ifndef _MSC_VER
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+/* Variables of the cells set by the SCI file, the block file and mark_cell()*/
+static const int geometry_cache_var[] = {GX, GY, GZ, X, Y, Z, FLAGP, FLAGU,
+  FLAGV, FLAGW, VXBC, VYBC, VZBC, TEMPBC, QFLUXBC, Xi1BC};
+#define NB_GEOMETRY_CACHE_VAR \
+  ((int) (sizeof(geometry_cache_var)/sizeof(int)))
+
+/*
+	* Add bytes to a SHA1 hash
+	*
+	* @param ctx Pointer to the SHA1 context
+	* @param data Pointer to the bytes
+	* @param n Number of bytes
+	*
+	* @return No return needed
+	*/
+static void hash_bytes(SHA1_CTX *ctx, const void *data, size_t n) {
+  const unsigned char *c = (const unsigned char *) data;
+  size_t len;
+
+  /* SHA1Update() takes at most 2^32-1 bytes*/
+  while(n>0) {
+    len = n<0x40000000UL ? n : 0x40000000UL;
+    SHA1Update(ctx, c, (uint32_t) len);
+    c += len;
+    n -= len;
+  }
+} /* End of hash_bytes()*/
+
+/*
+	* Get the number of bytes of a cached geometry
+	*
+	* @param para Pointer to FFD parameters
+	* @param head Pointer to the header
+	*
+	* @return Number of bytes
+	*/
+static size_t geometry_cache_size(PARA_DATA *para,
+                                  const GEOMETRY_CACHE_HEADER *head) {
+  size_t nb_cell = (size_t) (para->geom->imax+2)*(para->geom->jmax+2)
+                 * (para->geom->kmax+2);
+
+  return sizeof(GEOMETRY_CACHE_HEADER)
+       + (size_t) head->nb_var*nb_cell*sizeof(REAL)
+       + (size_t) 5*head->index*sizeof(int)
+       + (size_t) head->nb_face*sizeof(BOUNDARY_FACE)
+       + (size_t) (head->nb_wall+head->nb_port)*sizeof(REAL);
+} /* End of geometry_cache_size()*/
+
+	/*
+		* Look for the geometry of the SCI file in the cache
+		*
+		* The function has to be called after read_sci_max(). If the cache has
+		* the geometry, para->geom->cached is set to 1 and read_sci_input() only
+		* reads the boundaries without setting the cells.
+		*
+		* @param para Pointer to FFD parameters
+		*
+		* @return 0 if no error occurred
+		*/
+int find_geometry_cache(PARA_DATA *para) {
+  GEOMETRY_CACHE_HEADER head;
+  SHA1_CTX ctx;
+  unsigned char *digest = para->inpu->geometry_digest;
+  const unsigned char *block;
+  char tag[100], *name = para->inpu->geometry_file;
+  size_t size;
+  int i, flag;
+  FILE *file;
+
+  para->geom->cached = 0;
+  name[0] = '\0';
+  if(para->inpu->geometry_cache[0]=='\0' || para->inpu->sci.data==NULL)
+    return 0;
+
+  /* A missing block file is reported by read_sci_zeroone()*/
+  block = map_file(para->inpu->block_file_name, &size);
+  if(block==NULL) return 0;
+
+  /****************************************************************************
+  | Name the cached geometry after the SHA1 of both files
+  ****************************************************************************/
+  sprintf(tag, "FFD geometry cache %d %d %lu", GEOMETRY_CACHE_VERSION,
+          (int) sizeof(REAL), (unsigned long) para->inpu->sci.size);
+  SHA1Init(&ctx);
+  hash_bytes(&ctx, tag, strlen(tag)+1);
+  hash_bytes(&ctx, para->inpu->sci.data, para->inpu->sci.size);
+  hash_bytes(&ctx, block, size);
+  SHA1Final(digest, &ctx);
+  unmap_file(block, size);
+
+  sprintf(name, "%s/", para->inpu->geometry_cache);
+  for(i=0; i<20; i++) sprintf(name+strlen(name), "%02x", digest[i]);
+  strcat(name, ".geo");
+
+  /****************************************************************************
+  | Check the header of the cached geometry
+  ****************************************************************************/
+  if((file=fopen(name, "rb"))==NULL) {
+    sprintf(msg, "find_geometry_cache(): The geometry is not in the cache "
+            "yet. It will be stored in %.800s.", name);
+    ffd_log(msg, FFD_NORMAL);
+    return 0;
+  }
+  flag = fread(&head, sizeof(GEOMETRY_CACHE_HEADER), 1, file)==1;
+  /* A truncated file is found here, since read_sci_input() does not set*/
+  /* the cells of a cached geometry*/
+  if(flag==1 && fseek(file, 0, SEEK_END)==0) size = (size_t) ftell(file);
+  else flag = 0;
+  fclose(file);
+
+  if(flag==0 || memcmp(head.magic, GEOMETRY_CACHE_MAGIC, 8)!=0
+     || head.version!=GEOMETRY_CACHE_VERSION
+     || head.byte_order!=GEOMETRY_CACHE_BYTE_ORDER
+     || head.real_size!=(int) sizeof(REAL)
+     || head.face_size!=(int) sizeof(BOUNDARY_FACE)
+     || memcmp(head.digest, digest, 20)!=0
+     || head.imax!=para->geom->imax || head.jmax!=para->geom->jmax
+     || head.kmax!=para->geom->kmax
+     || head.nb_var!=NB_GEOMETRY_CACHE_VAR
+     || head.index<0 || head.nb_face<0 || head.nb_wall<0 || head.nb_port<0
+     || size!=geometry_cache_size(para, &head)) {
+    sprintf(msg, "find_geometry_cache(): Warning: File %.800s is not a valid "
+            "geometry for the SCI file and will be replaced.", name);
+    ffd_log(msg, FFD_NORMAL);
+    return 0;
+  }
+
+  para->geom->cached = 1;
+  sprintf(msg, "find_geometry_cache(): Found the geometry in %.800s.", name);
+  ffd_log(msg, FFD_NORMAL);
+
+  return 0;
+} /* End of find_geometry_cache()*/
+
+	/*
+		* Load the cells and boundaries from the cache
+		*
+		* The function has to be called after read_sci_input().
+		*
+		* @param para Pointer to FFD parameters
+		* @param var Pointer to FFD simulation variables
+		* @param BINDEX Pointer to boundary index
+		*
+		* @return 0 if no error occurred
+		*/
+int read_geometry_cache(PARA_DATA *para, REAL **var, int **BINDEX) {
+  GEOMETRY_CACHE_HEADER head;
+  const unsigned char *data, *p;
+  const char *name = para->inpu->geometry_file;
+  size_t size, nb_cell = (size_t) (para->geom->imax+2)*(para->geom->jmax+2)
+                       * (para->geom->kmax+2);
+  int n;
+
+  data = map_file(name, &size);
+  if(data==NULL) {
+    sprintf(msg, "read_geometry_cache(): Could not map file %.800s.", name);
+    ffd_log(msg, FFD_ERROR);
+    return 1;
+  }
+
+  if(size>=sizeof(GEOMETRY_CACHE_HEADER))
+    memcpy(&head, data, sizeof(GEOMETRY_CACHE_HEADER));
+  if(size<sizeof(GEOMETRY_CACHE_HEADER)
+     || memcmp(head.digest, para->inpu->geometry_digest, 20)!=0
+     || head.nb_var!=NB_GEOMETRY_CACHE_VAR
+     || head.index<0 || (size_t) head.index>nb_cell
+     || head.nb_face<0 || head.nb_face>6*head.index
+     || head.nb_wall!=para->bc->nb_wall || head.nb_port!=para->bc->nb_port
+     || size!=geometry_cache_size(para, &head)) {
+    sprintf(msg, "read_geometry_cache(): File %.800s does not fit the "
+            "boundaries of the SCI file.", name);
+    ffd_log(msg, FFD_ERROR);
+    unmap_file(data, size);
+    return 1;
+  }
+  p = data + sizeof(GEOMETRY_CACHE_HEADER);
+
+  /****************************************************************************
+  | Copy the variables and the boundary index
+  ****************************************************************************/
+  for(n=0; n<NB_GEOMETRY_CACHE_VAR; n++, p+=nb_cell*sizeof(REAL))
+    memcpy(var[geometry_cache_var[n]], p, nb_cell*sizeof(REAL));
+
+  para->geom->index = head.index;
+  if(compact_index(para, BINDEX)!=0) {
+    unmap_file(data, size);
+    return 1;
+  }
+  for(n=0; n<5; n++, p+=head.index*sizeof(int))
+    memcpy(BINDEX[n], p, head.index*sizeof(int));
+
+  /****************************************************************************
+  | Copy the boundary faces and the boundary areas
+  ****************************************************************************/
+  if(para->geom->face!=NULL) free(para->geom->face);
+  para->geom->face = (BOUNDARY_FACE *)
+                     malloc((head.nb_face+1)*sizeof(BOUNDARY_FACE));
+  if(para->geom->face==NULL) {
+    ffd_log("read_geometry_cache(): Could not allocate memory for the "
+            "boundary faces.", FFD_ERROR);
+    unmap_file(data, size);
+    return 1;
+  }
+  memcpy(para->geom->face, p, head.nb_face*sizeof(BOUNDARY_FACE));
+  p += head.nb_face*sizeof(BOUNDARY_FACE);
+  para->geom->nb_face = head.nb_face;
+  for(n=0; n<4; n++) para->geom->face_start[n] = head.face_start[n];
+
+  if(head.nb_wall>0) memcpy(para->bc->AWall, p, head.nb_wall*sizeof(REAL));
+  p += head.nb_wall*sizeof(REAL);
+  if(head.nb_port>0) memcpy(para->bc->APort, p, head.nb_port*sizeof(REAL));
+
+  para->geom->volFlu = head.volFlu;
+
+  sprintf(msg, "read_geometry_cache(): Loaded %d boundary cells and %d "
+          "boundary faces from %.800s.", head.index, head.nb_face, name);
+  ffd_log(msg, FFD_NORMAL);
+
+  unmap_file(data, size);
+  return 0;
+} /* End of read_geometry_cache()*/
+
+	/*
+		* Store the cells and boundaries in the cache
+		*
+		* A failure only gives a warning, since the simulation does not need
+		* the cache.
+		*
+		* @param para Pointer to FFD parameters
+		* @param var Pointer to FFD simulation variables
+		* @param BINDEX Pointer to boundary index
+		*
+		* @return 0 if no error occurred
+		*/
+int write_geometry_cache(PARA_DATA *para, REAL **var, int **BINDEX) {
+  GEOMETRY_CACHE_HEADER head;
+  const char *name = para->inpu->geometry_file;
+  char tmp[sizeof(para->inpu->geometry_file)+64];
+  size_t nb_cell = (size_t) (para->geom->imax+2)*(para->geom->jmax+2)
+                 * (para->geom->kmax+2);
+  unsigned long pid;
+  int n, flag = 0;
+  FILE *file;
+
+  if(name[0]=='\0' || para->geom->cached==1) return 0;
+
+  /* Runs and instances writing the same geometry use their own files*/
+#ifdef _MSC_VER
+  CreateDirectoryA(para->inpu->geometry_cache, NULL);
+  pid = (unsigned long) GetCurrentProcessId();
+#else
+  mkdir(para->inpu->geometry_cache, 0777);
+  pid = (unsigned long) getpid();
+#endif
+  sprintf(tmp, "%s.%lu.%d.tmp", name, pid,
+          para->solv->cosimulation==1 ? para->cosim->id : 0);
+
+  /****************************************************************************
+  | Get the header from the file name and the geometry
+  ****************************************************************************/
+  memset(&head, 0, sizeof(GEOMETRY_CACHE_HEADER));
+  memcpy(head.magic, GEOMETRY_CACHE_MAGIC, 8);
+  head.version = GEOMETRY_CACHE_VERSION;
+  head.byte_order = GEOMETRY_CACHE_BYTE_ORDER;
+  head.real_size = (int) sizeof(REAL);
+  head.face_size = (int) sizeof(BOUNDARY_FACE);
+  memcpy(head.digest, para->inpu->geometry_digest, 20);
+  head.imax = para->geom->imax;
+  head.jmax = para->geom->jmax;
+  head.kmax = para->geom->kmax;
+  head.nb_var = NB_GEOMETRY_CACHE_VAR;
+  head.index = para->geom->index;
+  head.nb_face = para->geom->nb_face;
+  for(n=0; n<4; n++) head.face_start[n] = para->geom->face_start[n];
+  head.nb_wall = para->bc->nb_wall;
+  head.nb_port = para->bc->nb_port;
+  head.volFlu = para->geom->volFlu;
+
+  /****************************************************************************
+  | Write the temporary file and rename it
+  ****************************************************************************/
+  if((file=fopen(tmp, "wb"))==NULL) {
+    sprintf(msg, "write_geometry_cache(): Warning: Could not open file %.800s. "
+            "The geometry is not cached.", tmp);
+    ffd_log(msg, FFD_NORMAL);
+    return 0;
+  }
+
+  if(fwrite(&head, sizeof(GEOMETRY_CACHE_HEADER), 1, file)!=1) flag = 1;
+  for(n=0; n<NB_GEOMETRY_CACHE_VAR && flag==0; n++)
+    if(fwrite(var[geometry_cache_var[n]], sizeof(REAL), nb_cell, file)
+       !=nb_cell)
+      flag = 1;
+  for(n=0; n<5 && flag==0; n++)
+    if(fwrite(BINDEX[n], sizeof(int), head.index, file)!=(size_t) head.index)
+      flag = 1;
+  if(flag==0
+     && (fwrite(para->geom->face, sizeof(BOUNDARY_FACE), head.nb_face, file)
+         !=(size_t) head.nb_face
+      || (head.nb_wall>0
+          && fwrite(para->bc->AWall, sizeof(REAL), head.nb_wall, file)
+             !=(size_t) head.nb_wall)
+      || (head.nb_port>0
+          && fwrite(para->bc->APort, sizeof(REAL), head.nb_port, file)
+             !=(size_t) head.nb_port)))
+    flag = 1;
+  if(fclose(file)!=0) flag = 1;
+
+  /* Another run may have stored the same geometry in the meantime*/
+  if(flag==0 && rename(tmp, name)!=0) {
+    remove(tmp);
+    if((file=fopen(name, "rb"))!=NULL) fclose(file);
+    else flag = 1;
+  }
+  else if(flag!=0)
+    remove(tmp);
+
+  if(flag!=0) {
+    sprintf(msg, "write_geometry_cache(): Warning: Could not store the "
+            "geometry in %.800s.", name);
+    ffd_log(msg, FFD_NORMAL);
+  }
+  else {
+    sprintf(msg, "write_geometry_cache(): Stored the geometry in %.800s.", name);
+    ffd_log(msg, FFD_NORMAL);
+  }
+
+  return 0;
+} /* End of write_geometry_cache()*/
@@ -0,0 +1,108 @@
+/*
+	*
+	* @file   geometry_cache.h
+	*
+	* @brief  Store the preprocessed geometry in a cache shared by the runs
+	*
+	* @author Xu Han
+	*         University of Colorado Boulder
+	*         xuha3556@colorado.edu
+	*
+	* @date   10/18/2026
+	*
+	* If inpu.geometry_cache names a directory, the cells and boundaries
+	* derived from the SCI file and the block file are stored in that
+	* directory under the SHA1 of both files. A later run with the same
+	* files loads the coordinates, the flags and boundary values of the
+	* cells, the boundary index, the boundary faces and the boundary areas
+	* from the cache instead of computing them again. The names and the
+	* values of the boundaries are still read from the SCI file.
+	*
+	* The numbers are stored in the byte order of the host:
+	*
+	* Header:    GEOMETRY_CACHE_HEADER
+	* Variables: values of each variable in geometry_cache_var
+	* Index:     the 5 rows of the boundary index
+	* Faces:     the boundary faces
+	* Areas:     the areas of the walls, followed by the areas of the ports
+	*
+	*/
+#ifndef _GEOMETRY_CACHE_H
+#define _GEOMETRY_CACHE_H
+#endif
+
+#ifndef _DATA_STRUCTURE_H
+#define _DATA_STRUCTURE_H
+#include "data_structure.h"
+#endif
+
+#ifndef _UTILITY_H
+#define _UTILITY_H
+#include "utility.h"
+#endif
+
+#include "../../C-Sources/cryptographicsHash.h"
+
+#define GEOMETRY_CACHE_MAGIC "FFDGEOMC" /* First 8 bytes of a cached geometry*/
+#define GEOMETRY_CACHE_VERSION 1 /* Version of the format of the cache*/
+#define GEOMETRY_CACHE_BYTE_ORDER 0x01020304 /* Detects another byte order*/
+
+/* Header of a cached geometry*/
+typedef struct {
+  char magic[8]; /* GEOMETRY_CACHE_MAGIC without the ending 0*/
+  int version; /* GEOMETRY_CACHE_VERSION*/
+  int byte_order; /* GEOMETRY_CACHE_BYTE_ORDER*/
+  int real_size; /* Number of bytes of a REAL*/
+  int face_size; /* Number of bytes of a BOUNDARY_FACE*/
+  unsigned char digest[20]; /* SHA1 of the SCI file and the block file*/
+  int imax; /* Number of interior cells in x-direction*/
+  int jmax; /* Number of interior cells in y-direction*/
+  int kmax; /* Number of interior cells in z-direction*/
+  int nb_var; /* Number of variables*/
+  int index; /* Number of boundary cells*/
+  int nb_face; /* Number of boundary faces*/
+  int face_start[4]; /* First face of each boundary type*/
+  int nb_wall; /* Number of walls*/
+  int nb_port; /* Number of inlets and outlets*/
+  REAL volFlu; /* Total volume of fluid cells*/
+}GEOMETRY_CACHE_HEADER;
+
+/*
+	* Look for the geometry of the SCI file in the cache
+	*
+	* The function has to be called after read_sci_max(). If the cache has
+	* the geometry, para->geom->cached is set to 1 and read_sci_input() only
+	* reads the boundaries without setting the cells.
+	*
+	* @param para Pointer to FFD parameters
+	*
+	* @return 0 if no error occurred
+	*/
+int find_geometry_cache(PARA_DATA *para);
+
+/*
+	* Load the cells and boundaries from the cache
+	*
+	* The function has to be called after read_sci_input().
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	* @param BINDEX Pointer to boundary index
+	*
+	* @return 0 if no error occurred
+	*/
+int read_geometry_cache(PARA_DATA *para, REAL **var, int **BINDEX);
+
+/*
+	* Store the cells and boundaries in the cache
+	*
+	* A failure only gives a warning, since the simulation does not need
+	* the cache.
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	* @param BINDEX Pointer to boundary index
+	*
+	* @return 0 if no error occurred
+	*/
+int write_geometry_cache(PARA_DATA *para, REAL **var, int **BINDEX);
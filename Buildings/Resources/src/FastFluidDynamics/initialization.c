@@ -33,6 +33,7 @@ int initialize(PARA_DATA *para) {
     ffd_log("initialize(): Failed to read parameter file.", FFD_ERROR);
     return 1;
   }
+  set_log_level(para->outp->log_level);
 
   /*---------------------------------------------------------------------------
   | Output the help information
@@ -82,9 +83,31 @@ void set_default_parameter(PARA_DATA *para) {
   para->solv->check_residual = 0;
   para->solv->solver = GS; /* Gauss-Seidel Solver*/
   para->solv->interpolation = BILINEAR; /* Bilinear interpolation*/
+  para->solv->mass_correction = UNIFORM; /* Same velocity correction on outlets*/
+  para->solv->memo_tolerance = 0; /* Compute every cosimulation window*/
+  para->solv->snapshot = 0; /* Do not keep the states for stepping back*/
+  para->solv->cfl = 0; /* Fixed time step*/
+  para->solv->diffusion_number = 0; /* Time step not limited by diffusion*/
+  para->solv->real_time = 0; /* No deadline*/
+  para->solv->min_iteration = 5;
+  para->solv->min_iteration_p = 2;
+  para->solv->max_scalar_interval = 4;
+  para->mytime->dt_min = 0; /* Adaptive time step not limited*/
+  para->mytime->dt_max = 0;
+  para->mytime->dt_free = 0;
+  para->mytime->steady_window = 0; /* Run all the time steps*/
+  para->mytime->steady_tolerance = (REAL) 1e-3;
+  para->mytime->steady_stop = 1; /* End once the steady flow was averaged*/
 
   /* Default values for Input*/
   para->inpu->read_old_ffd_file = 0; /* Do not read the old FFD data as initial value*/
+  para->inpu->geometry_cache[0] = '\0'; /* Do not cache the geometry*/
+  para->inpu->geometry_file[0] = '\0';
+
+  /* Default values for the warm start*/
+  para->init->coarse_step = 0; /* Start from the initial values*/
+  para->init->coarse_ratio = 2; /* Merge 2x2x2 cells into one coarse cell*/
+  para->init->coarse_tolerance = (REAL) 1e-4;
 
   /* Default values for Output*/
   para->outp->Temp_ref   = 0;/*35.5f;//10.25f;*/
@@ -99,12 +122,30 @@ void set_default_parameter(PARA_DATA *para) {
   para->outp->j_N        = 1;
   para->outp->k_N        = 1;
   para->outp->tstep_display = 10; /* Update the display for every 10 time steps*/
+  para->outp->log_level  = 1; /* Normal messages with progress every second*/
+  para->outp->format     = TECPLOT; /* Text files for Tecplot*/
+  para->outp->nb_field   = 0; /* Default fields of each result file*/
+  para->outp->nb_selector = 0; /* Write the whole domain*/
+  para->outp->checkpoint_step = 0; /* Do not write checkpoints*/
+  para->outp->movie_step = 10; /* A frame of the animation every 10 time steps*/
+  para->outp->movie_buffer = 2; /* Copy a frame while the previous one is written*/
+  para->outp->movie_format = VTK; /* A VTK file for each frame*/
+  para->outp->movie_tolerance = 0; /* Lossless time series*/
   para->outp->screen     = 1; /* Draw velocity*/
   para->geom->plane      = ZX; /* Draw ZX plane*/
   para->bc->nb_port = 0;
   para->bc->nb_Xi = 0;
   para->bc->nb_C = 0;
   para->sens->nb_sensor = 0; /* Number of sensors*/
+  para->cache->step = -1; /* Coefficient cache has not been built*/
+  para->cache->nb_face = 0;
+  para->cache->h = NULL;
+  para->rt->it = GS_ITERATION; /* Full accuracy until a deadline is missed*/
+  para->rt->it_p = GS_P_ITERATION;
+  para->rt->scalar_interval = 1;
+  para->geom->face = NULL; /* Boundary faces have not been built*/
+  para->geom->nb_face = 0;
+  para->geom->cached = 0;
 } /* End of set_default_parameter*/
 
 	/*
@@ -117,9 +158,11 @@ void set_default_parameter(PARA_DATA *para) {
 		* @return 0 if no error occurred
 		*/
 int set_initial_data(PARA_DATA *para, REAL **var, int **BINDEX) {
+  STARTUP_DATA *startup = &para->mytime->startup;
   int i, j;
   int size = (para->geom->imax+2)*(para->geom->jmax+2)*(para->geom->kmax+2);
   int flag = 0;
+  double t0;
 
   para->mytime->t = 0.0;
   para->mytime->step_current = 0;
@@ -180,6 +223,8 @@ int set_initial_data(PARA_DATA *para, REAL **var, int **BINDEX) {
     var[C2S][i]     = 0.0;
     var[C1BC][i]    = 0.0;
     var[C2BC][i]    = 0.0;
+    var[DIST][i]    = 0.0;
+    var[NUT][i]     = 0.0;
   }
 
   /* Calculate the thermal diffusivity*/
@@ -189,20 +234,45 @@ int set_initial_data(PARA_DATA *para, REAL **var, int **BINDEX) {
   | Read the configurations defined by SCI
   ****************************************************************************/
   if(para->inpu->parameter_file_format == SCI) {
+    t0 = wall_time();
+    flag = find_geometry_cache(para);
+    if(flag != 0) return flag;
+
     flag = read_sci_input(para, var, BINDEX);
     if(flag != 0) {
-      sprintf(msg, "set_inital_data(): Could not read file %s",
+      sprintf(msg, "set_inital_data(): Could not read file %.900s",
               para->inpu->parameter_file_name);
       ffd_log(msg, FFD_ERROR);
       return flag;
     }
-    flag = read_sci_zeroone(para, var, BINDEX);
-    if(flag != 0) {
-      ffd_log("set_inital_data(): Could not read block information file",
-               FFD_ERROR);
-      return flag;
+    startup->sci += wall_time() - t0;
+
+    /* The cells and boundaries of the cached geometry replace the block
+       file and the marking of the cells*/
+    if(para->geom->cached==1) {
+      t0 = wall_time();
+      flag = read_geometry_cache(para, var, BINDEX);
+      if(flag != 0) {
+        ffd_log("set_inital_data(): Could not load the cached geometry",
+                FFD_ERROR);
+        return flag;
+      }
+      startup->geometry += wall_time() - t0;
+    }
+    else {
+      t0 = wall_time();
+      flag = read_sci_zeroone(para, var, BINDEX);
+      if(flag != 0) {
+        ffd_log("set_inital_data(): Could not read block information file",
+                 FFD_ERROR);
+        return flag;
+      }
+      startup->block += wall_time() - t0;
+
+      t0 = wall_time();
+      mark_cell(para, var);
+      startup->geometry += wall_time() - t0;
     }
-    mark_cell(para, var);
   }
 
   /****************************************************************************
@@ -308,9 +378,59 @@ int set_initial_data(PARA_DATA *para, REAL **var, int **BINDEX) {
   /****************************************************************************
   | Pre-calculate data needed but not change in the simulation
   ****************************************************************************/
-  para->geom->volFlu = fluid_volume(para, var);
+  t0 = wall_time();
   para->geom->pindex     = (int) para->geom->jmax/2;
 
+  if(para->geom->cached==0) {
+    para->geom->volFlu = fluid_volume(para, var);
+
+    flag = compact_index(para, BINDEX);
+    if(flag != 0) {
+      ffd_log("set_initial_data(): Could not compact the boundary index.",
+              FFD_ERROR);
+      return flag;
+    }
+    flag = boundary_face(para, var, BINDEX);
+    if(flag != 0) {
+      ffd_log("set_initial_data(): Could not build the boundary faces.",
+              FFD_ERROR);
+      return flag;
+    }
+  }
+
+  /* The areas are stored with the geometry, so they are computed for
+     the cache even without cosimulation*/
+  if(para->solv->cosimulation==1 || para->inpu->geometry_file[0]!='\0') {
+    flag = bounary_area(para, var, BINDEX);
+    if(flag != 0) {
+      ffd_log("set_initial_data(): Could not get the boundary area.",
+              FFD_ERROR);
+      return flag;
+    }
+  }
+
+  flag = write_geometry_cache(para, var, BINDEX);
+  if(flag != 0) return flag;
+  startup->geometry += wall_time() - t0;
+
+  /****************************************************************************
+  | Compute the wall distance and initial turbulent viscosity for Chen's model
+  ****************************************************************************/
+  if(para->prob->tur_model==CHEN) {
+    flag = wall_distance(para, var);
+    if(flag != 0) {
+      ffd_log("set_initial_data(): Could not compute the wall distance.",
+              FFD_ERROR);
+      return flag;
+    }
+    flag = nu_t_chen_zero_equ_field(para, var);
+    if(flag != 0) {
+      ffd_log("set_initial_data(): Could not compute the turbulent viscosity.",
+              FFD_ERROR);
+      return flag;
+    }
+  }
+
   /****************************************************************************
   | Set all the averaged data to 0
   ****************************************************************************/
@@ -322,18 +442,24 @@ int set_initial_data(PARA_DATA *para, REAL **var, int **BINDEX) {
   }
 
   /****************************************************************************
-  | Conduct the data exchange at the initial state of cosimulation
+  | Start from the solution on a coarse grid
   ****************************************************************************/
-  if(para->solv->cosimulation==1) {
-    /*------------------------------------------------------------------------
-    | Calculate the area of boundary
-    ------------------------------------------------------------------------*/
-    flag = bounary_area(para, var, BINDEX);
+  if(para->solv->cosimulation==0) {
+    t0 = wall_time();
+    flag = warm_start(para, var, BINDEX);
     if(flag != 0) {
-      ffd_log("set_initial_data(): Could not get the boundary area.",
+      ffd_log("set_initial_data(): Could not start from the coarse grid.",
               FFD_ERROR);
       return flag;
     }
+    startup->warm_start += wall_time() - t0;
+  }
+
+  /****************************************************************************
+  | Conduct the data exchange at the initial state of cosimulation
+  ****************************************************************************/
+  if(para->solv->cosimulation==1) {
+    t0 = wall_time();
     /*------------------------------------------------------------------------
     | Read the cosimulation parameter data (Only need once)
     ------------------------------------------------------------------------*/
@@ -352,6 +478,18 @@ int set_initial_data(PARA_DATA *para, REAL **var, int **BINDEX) {
                "cosimulaiton.", FFD_ERROR);
       return flag;
     }
+    startup->exchange += wall_time() - t0;
+
+    /* The coarse grid uses the boundary conditions from Modelica*/
+    t0 = wall_time();
+    flag = warm_start(para, var, BINDEX);
+    if(flag != 0) {
+      ffd_log("set_initial_data(): Could not start from the coarse grid.",
+              FFD_ERROR);
+      return flag;
+    }
+    startup->warm_start += wall_time() - t0;
+    t0 = wall_time();
 
     /*------------------------------------------------------------------------
     | Perform the simulation for one step to update the FFD initial condition
@@ -420,6 +558,7 @@ int set_initial_data(PARA_DATA *para, REAL **var, int **BINDEX) {
               "cosimulaiton.", FFD_ERROR);
       return flag;
     }
+    startup->exchange += wall_time() - t0;
   }
 
   return flag;
@@ -53,6 +53,21 @@
 #include "geometry.h"
 #endif
 
+#ifndef _CHEN_ZERO_EQU_MODEL_H
+#define _CHEN_ZERO_EQU_MODEL_H
+#include "chen_zero_equ_model.h"
+#endif
+
+#ifndef _GEOMETRY_CACHE_H
+#define _GEOMETRY_CACHE_H
+#include "geometry_cache.h"
+#endif
+
+#ifndef _WARM_START_H
+#define _WARM_START_H
+#include "warm_start.h"
+#endif
+
 /*
 	* Initialize the parameters
 	*
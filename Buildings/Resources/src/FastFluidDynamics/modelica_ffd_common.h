@@ -12,6 +12,36 @@
 	*
 	*/
 #define REAL double
+
+/* Number of message slots in each ring*/
+#define FFD_RING_SIZE 4
+/* Size of a cache line in bytes*/
+#define FFD_CACHE_LINE 64
+
+/*
+	* Single producer/single consumer ring of messages
+	*
+	* Each slot holds the time, the synchronization time step and the packed
+	* data in the same order as the inputs or outputs of the Modelica model.
+	* The slots start at a cache line and head and tail are on separate cache
+	* lines, so that producer and consumer do not share a cache line.
+	* The slots are located relative to the ring, so that a ring can also be
+	* placed in memory shared by two processes.
+	*/
+typedef struct {
+  int head; /* Number of messages written by the producer*/
+  char pad1[FFD_CACHE_LINE-sizeof(int)];
+  int tail; /* Number of messages read by the consumer*/
+  char pad2[FFD_CACHE_LINE-sizeof(int)];
+  int size; /* Number of REAL in a message: t, dt and the packed data*/
+  int stride; /* Distance between two slots in number of REAL*/
+  int offset; /* Distance in bytes from the ring to the first slot*/
+  void *mem; /* Memory allocated for the ring, NULL if owned by the FFD library*/
+} MessageRing;
+
+/* Distance in bytes from a ring aligned to cache line to its first slot*/
+#define FFD_RING_OFFSET \
+  (((sizeof(MessageRing)+FFD_CACHE_LINE-1)/FFD_CACHE_LINE)*FFD_CACHE_LINE)
 typedef struct {
   int flag; /* Flag for coupled simulation: 0-> Stop; 1->Continue*/
   int ffdError; /* 0: FFD had no error;*/
@@ -38,7 +68,7 @@ typedef struct {
 typedef struct {
   REAL t; /* Current time of integration*/
 	REAL lt; /* Last time of integration*/
-  int flag; /* To control the data exchange. 0: old data, 1: new data; -1: Stop coupled simulation*/
+  REAL *last; /* Messages of the last exchange: to FFD followed by from FFD*/
   REAL dt; /* Time step size for next synchronization*/
   REAL *temHea; /* temHea[nSur]: Temperature or heat flow rate depending on surBou.bouCon*/
   REAL sensibleHeat; /* Convective sensible heat input into the room*/
@@ -54,11 +84,10 @@ typedef struct {
   REAL **XiPor; /* XiPor[nPorts][Medium.nXi]: species concentration of inflowing medium at the port*/
              /* First Medium.nXi elements are for port 1*/
   REAL **CPor; /* CPor[nPorts][Medium.nC]: the trace substances of the inflowing medium*/
-}ModelicaSharedData;
+}ModelicaSharedData; /* Arrays point to the message being read by FFD*/
 
 typedef struct {
   REAL t; /* Current time of integration*/
-  int flag; /* To control the data exchange. 0: old data, 1: new data*/
   REAL *temHea; /* temHea[nSur]: Temperature or heat flow rate depending on surBou.bouCon*/
                  /* 1: Return heat flow; 2: Return temperature*/
   REAL TRoo; /* Averaged room air temperature*/
@@ -69,10 +98,14 @@ typedef struct {
   REAL **CPor; /* CPor[nPorts][medium.nC]: the trace substances of medium at the port*/
   REAL *senVal; /* senVal[nSen]: value of sensor data*/
   char *msg; /* Message to be passed to Modelica*/
-}ffdSharedData;
+}ffdSharedData; /* Arrays point to the message being written by FFD*/
 
 typedef struct{
   ParameterSharedData *para;
   ffdSharedData *ffd;
   ModelicaSharedData *modelica;
+  MessageRing *input; /* Messages from Modelica to FFD*/
+  MessageRing *output; /* Messages from FFD to Modelica*/
+  int id; /* Index of the FFD instance, set by the FFD library*/
+  void *sync; /* Signalling object for the flags, owned by the FFD library*/
 } CosimulationData;
@@ -0,0 +1,314 @@
+/*
+	*
+	* \file   movie.c
+	*
+	* \brief  Write the frames of the animation in a background thread
+	*
+	* \author Xu Han
+	*         University of Colorado Boulder
+	*         xuha3556@colorado.edu
+	*
+	* \date   10/18/2026
+	*
+	* The buffers form a ring. The FFD thread only moves head and the writer
+	* thread only moves tail. Both move them under the lock of movie->sync and
+	* wake up the other thread, which sleeps on it while the ring is empty or
+	* full.
+	*
+	*/
+
+#include "movie.h"
+
+#ifndef _FFD_DLL_H
+#define _FFD_DLL_H
+#include "ffd_dll.h"
+#endif
+
+/* Default fields of a frame*/
+static const int movie_field[] = {VX, VY, VZ, TEMP, Xi1, IP};
+
+/*
+	* Write a frame to its file
+	*
+	* Nothing is written to the log, since the function runs in the writer
+	* thread.
+	*
+	* @param para Pointer to FFD parameters
+	* @param frame Pointer to the frame
+	*
+	* @return 0 if no error occurred
+	*/
+static int write_movie_frame(PARA_DATA *para, MOVIE_FRAME *frame) {
+  MOVIE_DATA *movie = para->movie;
+  size_t size = (size_t) (para->geom->imax+2)*(para->geom->jmax+2)
+              * (para->geom->kmax+2);
+  REAL *psi[NUT+1];
+  char filename[50];
+  int n;
+
+  for(n=0; n<movie->nb_field; n++) psi[n] = frame->data + n*size;
+
+  if(movie->series.file!=NULL)
+    return write_series_frame(&movie->series, psi, frame->t, frame->step);
+
+  sprintf(filename, "%s_%06d.vtr", movie->name, frame->step);
+
+  return write_vtk_file(para, movie->var, psi, movie->field, movie->nb_field,
+                        frame->t, filename);
+} /* End of write_movie_frame()*/
+
+	/*
+		* Write the buffered frames until the animation is closed
+		*
+		* @param p Pointer to FFD parameters
+		*
+		* @return No return needed
+		*/
+#ifdef _MSC_VER
+static DWORD WINAPI movie_thread(void *p) {
+#else
+static void *movie_thread(void *p) {
+#endif
+  PARA_DATA *para = (PARA_DATA *) p;
+  MOVIE_DATA *movie = para->movie;
+  MOVIE_FRAME *frame;
+  int flag;
+
+  ffd_lock_sync(&movie->sync);
+  for(;;) {
+    if(movie->head!=movie->tail) {
+      /* The FFD thread does not touch the frame until tail has moved*/
+      frame = &movie->frame[movie->tail%movie->nb];
+      ffd_unlock_sync(&movie->sync);
+      flag = write_movie_frame(para, frame);
+      ffd_lock_sync(&movie->sync);
+      if(flag!=0) movie->nb_fail++;
+      movie->tail++;
+      ffd_notify_sync(&movie->sync);
+    }
+    else if(movie->stop)
+      break;
+    else
+      ffd_wait_sync(&movie->sync, movie->sync.count, MOVIE_WAIT_TIMEOUT);
+  }
+  ffd_unlock_sync(&movie->sync);
+
+  return 0;
+} /* End of movie_thread()*/
+
+	/*
+		* Allocate the buffers of the frames and start the writer thread
+		*
+		* @param para Pointer to FFD parameters
+		* @param var Pointer to FFD simulation variables
+		*
+		* @return 0 if no error occurred
+		*/
+static int open_movie(PARA_DATA *para, REAL **var) {
+  MOVIE_DATA *movie = para->movie;
+  size_t size = (size_t) (para->geom->imax+2)*(para->geom->jmax+2)
+              * (para->geom->kmax+2);
+  char filename[50];
+  int n;
+
+  /* The fields selected for the result files or the default ones*/
+  if(para->outp->nb_field>0) {
+    movie->nb_field = para->outp->nb_field;
+    for(n=0; n<movie->nb_field; n++) movie->field[n] = para->outp->field[n];
+  }
+  else {
+    movie->nb_field = (int) (sizeof(movie_field)/sizeof(movie_field[0]));
+    for(n=0; n<movie->nb_field; n++) movie->field[n] = movie_field[n];
+  }
+
+  instance_file_name(para, "movie", movie->name);
+  movie->var = var;
+  movie->head = 0;
+  movie->tail = 0;
+  movie->stop = 0;
+  movie->nb_fail = 0;
+  movie->nb_wait = 0;
+
+  movie->nb = para->outp->movie_buffer>1 ? para->outp->movie_buffer : 1;
+  movie->frame = (MOVIE_FRAME *) calloc(movie->nb, sizeof(MOVIE_FRAME));
+  if(movie->frame==NULL) {
+    ffd_log("open_movie(): Could not allocate memory for the frames.",
+            FFD_ERROR);
+    return 1;
+  }
+  for(n=0; n<movie->nb; n++) {
+    movie->frame[n].data = (REAL *) malloc(movie->nb_field*size*sizeof(REAL));
+    if(movie->frame[n].data==NULL) {
+      ffd_log("open_movie(): Could not allocate memory for the frames.",
+              FFD_ERROR);
+      return 1;
+    }
+  }
+
+  if(para->outp->movie_format==SERIES) {
+    sprintf(filename, "%s.series", movie->name);
+    if(open_series(para, var, &movie->series, movie->field, movie->nb_field,
+                   filename)!=0)
+      return 1;
+  }
+
+  /* Without the thread, the frames are written directly*/
+  movie->async = 0;
+  if(ffd_init_sync_object(&movie->sync, 0)==0) {
+#ifdef _MSC_VER
+    movie->thread = CreateThread(NULL, 0, movie_thread, (void *) para, 0,
+                                 NULL);
+    movie->async = movie->thread!=NULL;
+#else
+    movie->async = pthread_create(&movie->thread, NULL, movie_thread,
+                                  (void *) para)==0;
+#endif
+    if(movie->async==0) ffd_free_sync_object(&movie->sync);
+  }
+
+  sprintf(msg, "open_movie(): Take a frame every %d time steps with %d "
+          "buffers%s.", para->outp->movie_step, movie->nb,
+          movie->async==1 ? "" : " (written without the writer thread)");
+  ffd_log(msg, FFD_NORMAL);
+
+  return 0;
+} /* End of open_movie()*/
+
+	/*
+		* Take a frame of the animation at the current time step
+		*
+		* The fields of the frame are copied to a free buffer for the writer
+		* thread. Nothing is done if no frame is due at the current time step.
+		*
+		* @param para Pointer to FFD parameters
+		* @param var Pointer to FFD simulation variables
+		*
+		* @return 0 if no error occurred
+		*/
+int take_movie_frame(PARA_DATA *para, REAL **var) {
+  MOVIE_DATA *movie = para->movie;
+  MOVIE_FRAME *frame;
+  size_t size = (size_t) (para->geom->imax+2)*(para->geom->jmax+2)
+              * (para->geom->kmax+2);
+  int n;
+
+  if(para->prob->movie!=1 || para->outp->movie_step<1
+     || para->mytime->step_current%para->outp->movie_step!=0)
+    return 0;
+
+  if(movie->frame==NULL && open_movie(para, var)!=0) return 1;
+
+  /****************************************************************************
+  | Wait for the writer thread if every buffer is in use
+  ****************************************************************************/
+  if(movie->async==1) {
+    ffd_lock_sync(&movie->sync);
+    if(movie->head-movie->tail==(unsigned long) movie->nb) {
+      movie->nb_wait++;
+      while(movie->head-movie->tail==(unsigned long) movie->nb)
+        ffd_wait_sync(&movie->sync, movie->sync.count, MOVIE_WAIT_TIMEOUT);
+    }
+    n = movie->nb_fail;
+    ffd_unlock_sync(&movie->sync);
+
+    if(n>0) {
+      sprintf(msg, "take_movie_frame(): Could not write %d frames of the "
+              "animation.", n);
+      ffd_log(msg, FFD_ERROR);
+      return 1;
+    }
+  }
+
+  /****************************************************************************
+  | Copy the fields to the buffer
+  ****************************************************************************/
+  frame = &movie->frame[movie->head%movie->nb];
+  for(n=0; n<movie->nb_field; n++)
+    memcpy(frame->data+n*size, var[movie->field[n]], size*sizeof(REAL));
+  frame->t = para->mytime->t;
+  frame->step = para->mytime->step_current;
+
+  if(movie->async==0) {
+    if(write_movie_frame(para, frame)!=0) {
+      sprintf(msg, "take_movie_frame(): Could not write the frame at "
+              "t=%f[s].", frame->t);
+      ffd_log(msg, FFD_ERROR);
+      return 1;
+    }
+    movie->tail++;
+    movie->head++;
+  }
+  else {
+    ffd_lock_sync(&movie->sync);
+    movie->head++;
+    ffd_notify_sync(&movie->sync);
+    ffd_unlock_sync(&movie->sync);
+  }
+
+  return 0;
+} /* End of take_movie_frame()*/
+
+	/*
+		* Write the buffered frames, stop the writer thread and free the buffers
+		*
+		* @param para Pointer to FFD parameters
+		*
+		* @return 0 if no error occurred
+		*/
+int close_movie(PARA_DATA *para) {
+  MOVIE_DATA *movie = para->movie;
+  double size;
+  int n;
+
+  if(movie->frame==NULL) return 0;
+
+  if(movie->async==1) {
+    ffd_lock_sync(&movie->sync);
+    movie->stop = 1;
+    ffd_notify_sync(&movie->sync);
+    ffd_unlock_sync(&movie->sync);
+#ifdef _MSC_VER
+    WaitForSingleObject(movie->thread, INFINITE);
+    CloseHandle(movie->thread);
+#else
+    pthread_join(movie->thread, NULL);
+#endif
+    ffd_free_sync_object(&movie->sync);
+    movie->async = 0;
+  }
+
+  for(n=0; n<movie->nb; n++)
+    if(movie->frame[n].data!=NULL) free(movie->frame[n].data);
+  free(movie->frame);
+  movie->frame = NULL;
+
+  if(movie->series.file!=NULL) {
+    size = (double) movie->series.nb_frame * movie->nb_field
+         * movie->series.size * sizeof(REAL);
+    sprintf(msg, "close_movie(): The time series has %d frames in %lu bytes "
+            "(%.1f%% of the fields).", movie->series.nb_frame,
+            movie->series.offset, size>0 ? 100*movie->series.offset/size : 0);
+    if(close_series(&movie->series)!=0) {
+      ffd_log("close_movie(): Could not write the index of the time series.",
+              FFD_ERROR);
+      return 1;
+    }
+    ffd_log(msg, FFD_NORMAL);
+  }
+  else
+    close_series(&movie->series);
+
+  if(movie->nb_fail>0) {
+    sprintf(msg, "close_movie(): Could not write %d frames of the animation.",
+            movie->nb_fail);
+    ffd_log(msg, FFD_ERROR);
+    return 1;
+  }
+
+  sprintf(msg, "close_movie(): Wrote %lu frames of the animation. The solver "
+          "waited for a free buffer before %d frames.", movie->head,
+          movie->nb_wait);
+  ffd_log(msg, FFD_NORMAL);
+
+  return 0;
+} /* End of close_movie()*/
@@ -0,0 +1,70 @@
+/*
+	*
+	* @file   movie.h
+	*
+	* @brief  Write the frames of the animation in a background thread
+	*
+	* @author Xu Han
+	*         University of Colorado Boulder
+	*         xuha3556@colorado.edu
+	*
+	* @date   10/18/2026
+	*
+	* If prob.movie is 1, FFD takes a frame every outp.movie_step time steps.
+	* The solver only copies the fields of the frame into one of the
+	* outp.movie_buffer buffers and continues. A writer thread writes the
+	* buffered frames to the files movie_<step>.vtr, or to the compressed time
+	* series movie.series if outp.movie_format is SERIES. If every buffer is
+	* in use, the solver waits for the writer thread.
+	*
+	*/
+#ifndef _MOVIE_H
+#define _MOVIE_H
+#endif
+
+#ifndef _DATA_STRUCTURE_H
+#define _DATA_STRUCTURE_H
+#include "data_structure.h"
+#endif
+
+#ifndef _DATA_WRITER_H
+#define _DATA_WRITER_H
+#include "data_writer.h"
+#endif
+
+#ifndef _SERIES_H
+#define _SERIES_H
+#include "series.h"
+#endif
+
+#ifndef _TIMING_H
+#define _TIMING_H
+#include "timing.h"
+#endif
+
+#ifndef _UTILITY_H
+#define _UTILITY_H
+#include "utility.h"
+#endif
+
+/*
+	* Take a frame of the animation at the current time step
+	*
+	* The fields of the frame are copied to a free buffer for the writer
+	* thread. Nothing is done if no frame is due at the current time step.
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	*
+	* @return 0 if no error occurred
+	*/
+int take_movie_frame(PARA_DATA *para, REAL **var);
+
+/*
+	* Write the buffered frames, stop the writer thread and free the buffers
+	*
+	* @param para Pointer to FFD parameters
+	*
+	* @return 0 if no error occurred
+	*/
+int close_movie(PARA_DATA *para);
@@ -29,6 +29,8 @@ int assign_parameter(PARA_DATA *para, char *string) {
   /* when the input for tmp2 is empty*/
   char tmp2[100] = "";
   int senId = -1;
+  int n, id;
+  OUTPUT_SELECTOR *sel;
 
 
   /****************************************************************************
@@ -101,6 +103,92 @@ int assign_parameter(PARA_DATA *para, char *string) {
     sprintf(msg, "assign_parameter(): %s=%d", tmp, para->outp->cal_mean);
     ffd_log(msg, FFD_NORMAL);
   }
+  else if(!strcmp(tmp, "outp.log_level")) {
+    sscanf(string, "%s%d", tmp, &para->outp->log_level);
+    sprintf(msg, "assign_parameter(): %s=%d", tmp, para->outp->log_level);
+    ffd_log(msg, FFD_NORMAL);
+  }
+  /* Selectors such as "outp.box x0 y0 z0 x1 y1 z1", "outp.slice XY z",
+     "outp.surface" and "outp.probe x0 y0 z0 x1 y1 z1 n"*/
+  else if(!strcmp(tmp, "outp.box") || !strcmp(tmp, "outp.slice")
+          || !strcmp(tmp, "outp.surface") || !strcmp(tmp, "outp.probe")) {
+    if(para->outp->nb_selector==MAX_SELECTOR) {
+      sprintf(msg, "assign_parameter(): More than %d output selectors are "
+              "defined.", MAX_SELECTOR);
+      ffd_log(msg, FFD_ERROR);
+      return 1;
+    }
+    sel = &para->outp->selector[para->outp->nb_selector];
+    n = 1;
+    if(!strcmp(tmp, "outp.box")) {
+      sel->type = BOX;
+      n = sscanf(string, "%s%lf%lf%lf%lf%lf%lf", tmp, &sel->p0[0], &sel->p0[1],
+                 &sel->p0[2], &sel->p1[0], &sel->p1[1], &sel->p1[2])==7;
+    }
+    else if(!strcmp(tmp, "outp.slice")) {
+      sel->type = SLICE;
+      n = sscanf(string, "%s%s%lf", tmp, tmp2, &sel->p0[0])==3;
+      if(!strcmp(tmp2, "XY"))
+        sel->plane = XY;
+      else if(!strcmp(tmp2, "YZ"))
+        sel->plane = YZ;
+      else if(!strcmp(tmp2, "ZX"))
+        sel->plane = ZX;
+      else
+        n = 0;
+    }
+    else if(!strcmp(tmp, "outp.surface"))
+      sel->type = SURFACE;
+    else {
+      sel->type = PROBE;
+      n = sscanf(string, "%s%lf%lf%lf%lf%lf%lf%d", tmp, &sel->p0[0],
+                 &sel->p0[1], &sel->p0[2], &sel->p1[0], &sel->p1[1],
+                 &sel->p1[2], &sel->nb_point)==8 && sel->nb_point>=2;
+    }
+    if(n==0) {
+      sprintf(msg, "assign_parameter(): Invalid input for %s", tmp);
+      ffd_log(msg, FFD_ERROR);
+      return 1;
+    }
+    para->outp->nb_selector++;
+    sprintf(msg, "assign_parameter(): %s defines output selector %d", tmp,
+            para->outp->nb_selector);
+    ffd_log(msg, FFD_NORMAL);
+  }
+  else if(!strcmp(tmp, "outp.checkpoint_step")) {
+    sscanf(string, "%s%d", tmp, &para->outp->checkpoint_step);
+    sprintf(msg, "assign_parameter(): %s=%d", tmp, para->outp->checkpoint_step);
+    ffd_log(msg, FFD_NORMAL);
+  }
+  else if(!strcmp(tmp, "outp.movie_step")) {
+    sscanf(string, "%s%d", tmp, &para->outp->movie_step);
+    sprintf(msg, "assign_parameter(): %s=%d", tmp, para->outp->movie_step);
+    ffd_log(msg, FFD_NORMAL);
+  }
+  else if(!strcmp(tmp, "outp.movie_buffer")) {
+    sscanf(string, "%s%d", tmp, &para->outp->movie_buffer);
+    sprintf(msg, "assign_parameter(): %s=%d", tmp, para->outp->movie_buffer);
+    ffd_log(msg, FFD_NORMAL);
+  }
+  else if(!strcmp(tmp, "outp.movie_format")) {
+    sscanf(string, "%s%s", tmp, tmp2);
+    sprintf(msg, "assign_parameter(): %s=%s", tmp, tmp2);
+    if(!strcmp(tmp2, "VTK"))
+      para->outp->movie_format = VTK;
+    else if(!strcmp(tmp2, "SERIES"))
+      para->outp->movie_format = SERIES;
+    else {
+      sprintf(msg, "assign_parameter(): %s is not valid input for %s", tmp2, tmp);
+      ffd_log(msg, FFD_ERROR);
+      return 1;
+    }
+    ffd_log(msg, FFD_NORMAL);
+  }
+  else if(!strcmp(tmp, "outp.movie_tolerance")) {
+    sscanf(string, "%s%lf", tmp, &para->outp->movie_tolerance);
+    sprintf(msg, "assign_parameter(): %s=%f", tmp, para->outp->movie_tolerance);
+    ffd_log(msg, FFD_NORMAL);
+  }
   else if(!strcmp(tmp, "outp.v_ref")) {
     sscanf(string, "%s%lf", tmp, &para->outp->v_ref);
     sprintf(msg, "assign_parameter(): %s=%f", tmp, para->outp->v_ref);
@@ -152,6 +240,40 @@ int assign_parameter(PARA_DATA *para, char *string) {
     }
     ffd_log(msg, FFD_NORMAL);
   }
+  else if(!strcmp(tmp, "outp.format")) {
+    sscanf(string, "%s%s", tmp, tmp2);
+    sprintf(msg, "assign_parameter(): %s=%s", tmp, tmp2);
+    if(!strcmp(tmp2, "TECPLOT"))
+      para->outp->format = TECPLOT;
+    else if(!strcmp(tmp2, "VTK"))
+      para->outp->format = VTK;
+    else {
+      sprintf(msg, "assign_parameter(): %s is not valid input for %s", tmp2, tmp);
+      ffd_log(msg, FFD_ERROR);
+      return 1;
+    }
+    ffd_log(msg, FFD_NORMAL);
+  }
+  /* List of fields such as "outp.fields U V W T P"*/
+  else if(!strcmp(tmp, "outp.fields")) {
+    sscanf(string, "%s%n", tmp, &n);
+    para->outp->nb_field = 0;
+    string += n;
+    while(sscanf(string, "%99s%n", tmp2, &n)==1) {
+      id = find_field(tmp2);
+      if(id<0) {
+        sprintf(msg, "assign_parameter(): %s is not valid input for %s",
+                tmp2, tmp);
+        ffd_log(msg, FFD_ERROR);
+        return 1;
+      }
+      if(para->outp->nb_field<=NUT)
+        para->outp->field[para->outp->nb_field++] = id;
+      sprintf(msg, "assign_parameter(): %s includes %s", tmp, tmp2);
+      ffd_log(msg, FFD_NORMAL);
+      string += n;
+    }
+  }
   else if(!strcmp(tmp, "inpu.parameter_file_format")) {
     sscanf(string, "%s%s", tmp, tmp2);
     sprintf(msg, "assign_parameter(): %s=%s", tmp, tmp2);
@@ -167,13 +289,30 @@ int assign_parameter(PARA_DATA *para, char *string) {
   else if(!strcmp(tmp, "inpu.parameter_file_name")) {
     sscanf(string, "%s%s", tmp, tmp_par);
     sprintf (para->inpu->parameter_file_name, "%s%s", para->cosim->para->filePath, tmp_par);
-    sprintf(msg, "assign_parameter(): %s=%s", tmp, para->inpu->parameter_file_name);
+    sprintf(msg, "assign_parameter(): inpu.parameter_file_name=%.900s",
+            para->inpu->parameter_file_name);
     ffd_log(msg, FFD_NORMAL);
   }
   else if(!strcmp(tmp, "inpu.block_file_name")) {
     sscanf(string, "%s%s", tmp, tmp_par);
     sprintf (para->inpu->block_file_name, "%s%s", para->cosim->para->filePath, tmp_par);
-    sprintf(msg, "assign_parameter(): %s=%s", tmp, para->inpu->block_file_name);
+    sprintf(msg, "assign_parameter(): inpu.block_file_name=%.900s",
+            para->inpu->block_file_name);
+    ffd_log(msg, FFD_NORMAL);
+  }
+  else if(!strcmp(tmp, "inpu.geometry_cache")) {
+    sscanf(string, "%s%s", tmp, tmp_par);
+    if(strlen(para->cosim->para->filePath)+strlen(tmp_par)
+       >= sizeof(para->inpu->geometry_cache)) {
+      sprintf(msg, "assign_parameter(): The path of %s is longer than %d "
+              "characters.", tmp, (int) sizeof(para->inpu->geometry_cache)-1);
+      ffd_log(msg, FFD_ERROR);
+      return 1;
+    }
+    strcpy(para->inpu->geometry_cache, para->cosim->para->filePath);
+    strcat(para->inpu->geometry_cache, tmp_par);
+    sprintf(msg, "assign_parameter(): inpu.geometry_cache=%.900s",
+            para->inpu->geometry_cache);
     ffd_log(msg, FFD_NORMAL);
   }
   else if(!strcmp(tmp, "inpu.read_old_ffd_file")) {
@@ -287,6 +426,32 @@ int assign_parameter(PARA_DATA *para, char *string) {
     sprintf(msg, "assign_parameter(): %s=%f", tmp, para->mytime->t_steady);
     ffd_log(msg, FFD_NORMAL);
   }
+  else if(!strcmp(tmp, "mytime.dt_min")) {
+    sscanf(string, "%s%lf", tmp, &para->mytime->dt_min);
+    sprintf(msg, "assign_parameter(): %s=%f", tmp, para->mytime->dt_min);
+    ffd_log(msg, FFD_NORMAL);
+  }
+  else if(!strcmp(tmp, "mytime.dt_max")) {
+    sscanf(string, "%s%lf", tmp, &para->mytime->dt_max);
+    sprintf(msg, "assign_parameter(): %s=%f", tmp, para->mytime->dt_max);
+    ffd_log(msg, FFD_NORMAL);
+  }
+  else if(!strcmp(tmp, "mytime.steady_window")) {
+    sscanf(string, "%s%d", tmp, &para->mytime->steady_window);
+    sprintf(msg, "assign_parameter(): %s=%d", tmp, para->mytime->steady_window);
+    ffd_log(msg, FFD_NORMAL);
+  }
+  else if(!strcmp(tmp, "mytime.steady_tolerance")) {
+    sscanf(string, "%s%lf", tmp, &para->mytime->steady_tolerance);
+    sprintf(msg, "assign_parameter(): %s=%f", tmp,
+            para->mytime->steady_tolerance);
+    ffd_log(msg, FFD_NORMAL);
+  }
+  else if(!strcmp(tmp, "mytime.steady_stop")) {
+    sscanf(string, "%s%d", tmp, &para->mytime->steady_stop);
+    sprintf(msg, "assign_parameter(): %s=%d", tmp, para->mytime->steady_stop);
+    ffd_log(msg, FFD_NORMAL);
+  }
   else if(!strcmp(tmp, "solv.solver")) {
     sscanf(string, "%s%s", tmp, tmp2);
     sprintf(msg, "assign_parameter(): %s=%s", tmp, tmp2);
@@ -340,6 +505,61 @@ int assign_parameter(PARA_DATA *para, char *string) {
     }
     ffd_log(msg, FFD_NORMAL);
   }
+  else if(!strcmp(tmp, "solv.mass_correction")) {
+    sscanf(string, "%s%s", tmp, tmp2);
+    sprintf(msg, "assign_parameter(): %s=%s", tmp, tmp2);
+    if(!strcmp(tmp2, "UNIFORM"))
+      para->solv->mass_correction = UNIFORM;
+    else if(!strcmp(tmp2, "FLOW_WEIGHTED"))
+      para->solv->mass_correction = FLOW_WEIGHTED;
+    else {
+      sprintf(msg, "assign_parameter(): %s is not valid input for %s", tmp2, tmp);
+      ffd_log(msg, FFD_ERROR);
+      return 1;
+    }
+    ffd_log(msg, FFD_NORMAL);
+  }
+  else if(!strcmp(tmp, "solv.memo_tolerance")) {
+    sscanf(string, "%s%lf", tmp, &para->solv->memo_tolerance);
+    sprintf(msg, "assign_parameter(): %s=%f", tmp, para->solv->memo_tolerance);
+    ffd_log(msg, FFD_NORMAL);
+  }
+  else if(!strcmp(tmp, "solv.snapshot")) {
+    sscanf(string, "%s%d", tmp, &para->solv->snapshot);
+    sprintf(msg, "assign_parameter(): %s=%d", tmp, para->solv->snapshot);
+    ffd_log(msg, FFD_NORMAL);
+  }
+  else if(!strcmp(tmp, "solv.cfl")) {
+    sscanf(string, "%s%lf", tmp, &para->solv->cfl);
+    sprintf(msg, "assign_parameter(): %s=%f", tmp, para->solv->cfl);
+    ffd_log(msg, FFD_NORMAL);
+  }
+  else if(!strcmp(tmp, "solv.diffusion_number")) {
+    sscanf(string, "%s%lf", tmp, &para->solv->diffusion_number);
+    sprintf(msg, "assign_parameter(): %s=%f", tmp, para->solv->diffusion_number);
+    ffd_log(msg, FFD_NORMAL);
+  }
+  else if(!strcmp(tmp, "solv.real_time")) {
+    sscanf(string, "%s%lf", tmp, &para->solv->real_time);
+    sprintf(msg, "assign_parameter(): %s=%f", tmp, para->solv->real_time);
+    ffd_log(msg, FFD_NORMAL);
+  }
+  else if(!strcmp(tmp, "solv.min_iteration")) {
+    sscanf(string, "%s%d", tmp, &para->solv->min_iteration);
+    sprintf(msg, "assign_parameter(): %s=%d", tmp, para->solv->min_iteration);
+    ffd_log(msg, FFD_NORMAL);
+  }
+  else if(!strcmp(tmp, "solv.min_iteration_p")) {
+    sscanf(string, "%s%d", tmp, &para->solv->min_iteration_p);
+    sprintf(msg, "assign_parameter(): %s=%d", tmp, para->solv->min_iteration_p);
+    ffd_log(msg, FFD_NORMAL);
+  }
+  else if(!strcmp(tmp, "solv.max_scalar_interval")) {
+    sscanf(string, "%s%d", tmp, &para->solv->max_scalar_interval);
+    sprintf(msg, "assign_parameter(): %s=%d", tmp,
+            para->solv->max_scalar_interval);
+    ffd_log(msg, FFD_NORMAL);
+  }
   else if(!strcmp(tmp, "solv.cosimulation")) {
     sscanf(string, "%s%d", tmp, &para->solv->cosimulation);
     sprintf(msg, "assign_parameter(): %s=%d", tmp, para->solv->cosimulation);
@@ -368,6 +588,22 @@ int assign_parameter(PARA_DATA *para, char *string) {
     sprintf(msg, "assign_parameter(): %s=%f", tmp, para->init->w);
     ffd_log(msg, FFD_NORMAL);
   }
+  else if(!strcmp(tmp, "init.coarse_step")) {
+    sscanf(string, "%s%d", tmp, &para->init->coarse_step);
+    sprintf(msg, "assign_parameter(): %s=%d", tmp, para->init->coarse_step);
+    ffd_log(msg, FFD_NORMAL);
+  }
+  else if(!strcmp(tmp, "init.coarse_ratio")) {
+    sscanf(string, "%s%d", tmp, &para->init->coarse_ratio);
+    sprintf(msg, "assign_parameter(): %s=%d", tmp, para->init->coarse_ratio);
+    ffd_log(msg, FFD_NORMAL);
+  }
+  else if(!strcmp(tmp, "init.coarse_tolerance")) {
+    sscanf(string, "%s%lf", tmp, &para->init->coarse_tolerance);
+    sprintf(msg, "assign_parameter(): %s=%f", tmp,
+            para->init->coarse_tolerance);
+    ffd_log(msg, FFD_NORMAL);
+  }
   /****************************************************************************
   | get the boundary conditions
   ****************************************************************************/
@@ -446,6 +682,7 @@ int assign_parameter(PARA_DATA *para, char *string) {
 		*/
 int read_parameter(PARA_DATA *para) {
   char string[400];
+  FILE *file_para;
 
   /****************************************************************************
   | Open the FFD parameter file
@@ -470,7 +707,7 @@ int read_parameter(PARA_DATA *para) {
   ---------------------------------------------------------------------------*/
   else {
     if((file_para=fopen(para->cosim->para->fileName,"r"))==NULL) {
-      sprintf(msg, "read_parameter(): Could not open the FFD parameter file %s",
+      sprintf(msg, "read_parameter(): Could not open the FFD parameter file %.900s",
               para->cosim->para->fileName);
       ffd_log(msg, FFD_ERROR);
       return 1;
@@ -486,7 +723,7 @@ int read_parameter(PARA_DATA *para) {
       }
       else {
         strncpy(para->cosim->para->filePath, para->cosim->para->fileName, nPath);
-        sprintf(msg, "read_parameter(): Opened file %s for FFD parameters with base directory %s",
+        sprintf(msg, "read_parameter(): Opened file %.450s for FFD parameters with base directory %.450s",
               para->cosim->para->fileName, para->cosim->para->filePath);
         ffd_log(msg, FFD_NORMAL);
       }
@@ -496,7 +733,7 @@ int read_parameter(PARA_DATA *para) {
   /*Use fgets(...) as loop condition, it returns null when it fail to read more characters.*/
   while(fgets(string, 400, file_para) != NULL) {
     if(assign_parameter(para, string)) {
-      sprintf(msg, "read_parameter(): Could not read data from file %s",
+      sprintf(msg, "read_parameter(): Could not read data from file %.900s",
             para->cosim->para->fileName);
       ffd_log(msg, FFD_ERROR);
       return 1;
@@ -507,7 +744,7 @@ int read_parameter(PARA_DATA *para) {
   /*Use feof() to detect what went wrong after one of the main I/O functions failed*/
   /*Do not use feof() as condition of while loop. It will read one more time after last line.*/
   if (!feof(file_para)){
-      sprintf(msg, "read_parameter(): Could not read data from file %s",
+      sprintf(msg, "read_parameter(): Could not read data from file %.900s",
             para->cosim->para->fileName);
       ffd_log(msg, FFD_ERROR);
   }
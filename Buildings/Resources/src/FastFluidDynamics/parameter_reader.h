@@ -23,8 +23,10 @@
 
 #include "utility.h"
 
-FILE *file_para;
-FILE *file_log;
+#ifndef _DATA_WRITER_H
+#define _DATA_WRITER_H
+#include "data_writer.h"
+#endif
 
 /*
 	* Assign the FFD parameters
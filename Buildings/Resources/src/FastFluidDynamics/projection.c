@@ -75,7 +75,7 @@ int project(PARA_DATA *para, REAL **var, int **BINDEX) {
                   + af[IX(i,j,k)] + ab[IX(i,j,k)];
   END_FOR
 
-  GS_P(para, var, IP, p);
+  para->steady->residual = GS_P(para, var, IP, p);
   set_bnd_pressure(para, var, p,BINDEX);
 
   /****************************************************************************
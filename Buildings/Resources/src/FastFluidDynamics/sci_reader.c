@@ -17,11 +17,228 @@
 
 #include "sci_reader.h"
 
+#include <ctype.h>
+
+#define MAX_FAST_DIGITS 15 /* Digits of a number converted without rounding*/
+#define MAX_FAST_EXPONENT 22 /* Largest power of 10 that is exact in a double*/
+
+/*
+	* Map a text file into memory
+	*
+	* @param text Pointer to the text
+	* @param filename Pointer to the name of the file
+	*
+	* @return 0 if no error occurred
+	*/
+static int open_text(TEXT_DATA *text, const char *filename) {
+  text->data = (const char *) map_file(filename, &text->size);
+  text->pos = 0;
+
+  return text->data==NULL;
+} /* End of open_text()*/
+
+/*
+	* Release a text file mapped by open_text()
+	*
+	* @param text Pointer to the text
+	*
+	* @return No return needed
+	*/
+static void close_text(TEXT_DATA *text) {
+  if(text->data!=NULL) unmap_file((const unsigned char *) text->data, text->size);
+  text->data = NULL;
+  text->size = 0;
+  text->pos = 0;
+} /* End of close_text()*/
+
+/*
+	* Skip the white space, including the ends of lines
+	*
+	* @param text Pointer to the text
+	*
+	* @return No return needed
+	*/
+static void skip_space(TEXT_DATA *text) {
+  while(text->pos<text->size && isspace((unsigned char) text->data[text->pos]))
+    text->pos++;
+} /* End of skip_space()*/
+
+/*
+	* Read the rest of the current line like fgets()
+	*
+	* The line always ends with '\n', also if it was the last line of the file
+	* or too long for the string. A '\r' before the end of the line is removed.
+	*
+	* @param text Pointer to the text
+	* @param string Pointer to the line
+	* @param n Number of characters of the string
+	*
+	* @return 0 if the end of the file was reached before the line
+	*/
+static int next_line(TEXT_DATA *text, char *string, int n) {
+  size_t start = text->pos, end;
+  int len;
+
+  if(text->pos>=text->size) {
+    string[0] = '\n';
+    string[1] = '\0';
+    return 0;
+  }
+
+  while(text->pos<text->size && text->data[text->pos]!='\n') text->pos++;
+  end = text->pos;
+  if(text->pos<text->size) text->pos++;
+  if(end>start && text->data[end-1]=='\r') end--;
+
+  len = end-start<(size_t) (n-2) ? (int) (end-start) : n-2;
+  memcpy(string, text->data+start, len);
+  string[len] = '\n';
+  string[len+1] = '\0';
+
+  return 1;
+} /* End of next_line()*/
+
+/*
+	* Read a number like fscanf() with "%lf"
+	*
+	* Numbers with up to MAX_FAST_DIGITS digits and a power of 10 up to
+	* MAX_FAST_EXPONENT are converted with one multiplication or division of
+	* two exact doubles, which gives the correctly rounded value. Other
+	* numbers are converted by strtod().
+	*
+	* @param text Pointer to the text
+	* @param v Pointer to the number
+	*
+	* @return 1 if a number was read
+	*/
+static int next_real(TEXT_DATA *text, REAL *v) {
+  static const double power[MAX_FAST_EXPONENT+1] = {1e0, 1e1, 1e2, 1e3, 1e4,
+    1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+    1e18, 1e19, 1e20, 1e21, 1e22};
+  const char *c, *end;
+  char token[64];
+  double m = 0;
+  int sign = 1, digit = 0, nb_digit = 0, e = 0, e_sign = 1, e_value = 0;
+  size_t len;
+
+  skip_space(text);
+  c = text->data + text->pos;
+  end = text->data + text->size;
+
+  /****************************************************************************
+  | Sign, digits before and after the point and exponent
+  ****************************************************************************/
+  if(c<end && (*c=='-' || *c=='+')) {
+    if(*c=='-') sign = -1;
+    c++;
+  }
+  for(; c<end && *c>='0' && *c<='9'; c++, digit++)
+    if(nb_digit>0 || *c!='0') {
+      m = 10*m + (*c-'0');
+      nb_digit++;
+    }
+  if(c<end && *c=='.')
+    for(c++; c<end && *c>='0' && *c<='9'; c++, digit++, e--)
+      if(nb_digit>0 || *c!='0') {
+        m = 10*m + (*c-'0');
+        nb_digit++;
+      }
+  if(digit>0 && c<end && (*c=='e' || *c=='E')) {
+    c++;
+    if(c<end && (*c=='-' || *c=='+')) {
+      if(*c=='-') e_sign = -1;
+      c++;
+    }
+    for(; c<end && *c>='0' && *c<='9' && e_value<10000; c++)
+      e_value = 10*e_value + (*c-'0');
+    e += e_sign*e_value;
+  }
+
+  /****************************************************************************
+  | Convert the number
+  ****************************************************************************/
+  if(digit>0 && nb_digit<=MAX_FAST_DIGITS
+     && (c==end || isspace((unsigned char) *c))
+     && e>=-MAX_FAST_EXPONENT && e<=MAX_FAST_EXPONENT) {
+    *v = (REAL) (sign * (e<0 ? m/power[-e] : m*power[e]));
+    text->pos = c - text->data;
+    return 1;
+  }
+
+  /* The file is not terminated by 0, so the token is copied for strtod()*/
+  c = text->data + text->pos;
+  for(len=0; c+len<end && !isspace((unsigned char) c[len])
+             && len<sizeof(token)-1; len++)
+    token[len] = c[len];
+  token[len] = '\0';
+  *v = (REAL) strtod(token, (char **) &end);
+  if(end==token) return 0;
+  text->pos += (const char *) end - token;
+
+  return 1;
+} /* End of next_real()*/
+
+/*
+	* Read an integer like fscanf() with "%d"
+	*
+	* @param text Pointer to the text
+	* @param v Pointer to the integer
+	*
+	* @return 1 if an integer was read
+	*/
+static int next_int(TEXT_DATA *text, int *v) {
+  int sign = 1, n = 0, digit = 0;
+
+  skip_space(text);
+  if(text->pos<text->size
+     && (text->data[text->pos]=='-' || text->data[text->pos]=='+')) {
+    if(text->data[text->pos]=='-') sign = -1;
+    text->pos++;
+  }
+  for(; text->pos<text->size && text->data[text->pos]>='0'
+        && text->data[text->pos]<='9'; text->pos++, digit++)
+    n = 10*n + (text->data[text->pos]-'0');
+
+  *v = sign*n;
+  return digit>0;
+} /* End of next_int()*/
+
+/*
+	* Set a variable in a box of cells
+	*
+	* The cells are filled row by row along x, where they are contiguous.
+	*
+	* @param para Pointer to FFD parameters
+	* @param psi Pointer to the variable
+	* @param SI Start of the box in x
+	* @param SJ Start of the box in y
+	* @param SK Start of the box in z
+	* @param EI End of the box in x
+	* @param EJ End of the box in y
+	* @param EK End of the box in z
+	* @param value Value of the variable
+	*
+	* @return No return needed
+	*/
+static void fill_box(PARA_DATA *para, REAL *psi, int SI, int SJ, int SK,
+                     int EI, int EJ, int EK, REAL value) {
+  int IMAX = para->geom->imax+2;
+  int IJMAX = (para->geom->imax+2)*(para->geom->jmax+2);
+  int ii, ij, ik;
+  REAL *row;
+
+  for(ik=SK; ik<=EK; ik++)
+    for(ij=SJ; ij<=EJ; ij++) {
+      row = psi + IX(0,ij,ik);
+      for(ii=SI; ii<=EI; ii++) row[ii] = value;
+    }
+} /* End of fill_box()*/
+
 /*
 	* Read the basic index information from input.cfd
 	*
-	* Specific method for advection will be selected according to the variable
-	* type.
+	* The file stays mapped into memory, so that read_sci_input() continues
+	* from the third line.
 	*
 	* @param para Pointer to FFD parameters
 	* @param var Pointer to FFD simulation variables
@@ -29,25 +246,26 @@
 	* @return 0 if no error occurred
 	*/
 int read_sci_max(PARA_DATA *para, REAL **var) {
+  TEXT_DATA *text = &para->inpu->sci;
   char string[400];
 
   /* Open the file*/
-  if((file_params=fopen(para->inpu->parameter_file_name,"r")) == NULL) {
+  close_text(text);
+  if(open_text(text, para->inpu->parameter_file_name)!=0) {
     fprintf(stderr,"Error:can not open the file \"%s\".\n",
       para->inpu->parameter_file_name);
     return 1;
   }
 
   /* Get the first line for the length in X, Y and Z directions*/
-  fgets(string, 400, file_params);
+  next_line(text, string, 400);
   sscanf(string,"%lf %lf %lf", &para->geom->Lx, &para->geom->Ly, &para->geom->Lz);
 
   /* Get the second line for the number of cells in X, Y and Z directions*/
-  fgets(string, 400, file_params);
+  next_line(text, string, 400);
   sscanf(string,"%d %d %d", &para->geom->imax, &para->geom->jmax,
     &para->geom->kmax);
 
-  fclose(file_params);
   return 0;
 } /* End of read_sci_max()*/
 
@@ -63,6 +281,7 @@ int read_sci_max(PARA_DATA *para, REAL **var) {
 		* @return 0 if no error occurred
 		*/
 int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
+  TEXT_DATA *text = &para->inpu->sci;
   int i, j, k;
   int ii,ij,ik;
   REAL tempx, tempy, tempz;
@@ -84,23 +303,26 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
   REAL *delx, *dely, *delz;
   REAL *flagp = var[FLAGP];
   int bcnameid = -1;
-
-  /* Open the parameter file*/
-  if((file_params=fopen(para->inpu->parameter_file_name,"r")) == NULL ) {
-    sprintf(msg,"read_sci_input(): Could not open the file \"%s\".",
-            para->inpu->parameter_file_name);
-    ffd_log(msg, FFD_ERROR);
-    return 1;
+  /* Cells are not set if they are loaded from the geometry cache*/
+  int fill = para->geom->cached==0;
+
+  /* Open the parameter file unless read_sci_max() left it open*/
+  if(text->data==NULL) {
+    if(open_text(text, para->inpu->parameter_file_name)!=0) {
+      sprintf(msg,"read_sci_input(): Could not open the file \"%.900s\".",
+              para->inpu->parameter_file_name);
+      ffd_log(msg, FFD_ERROR);
+      return 1;
+    }
+    /* Ignore the first and second lines*/
+    next_line(text, string, 400);
+    next_line(text, string, 400);
   }
 
-  sprintf(msg, "read_sci_input(): Start to read sci input file %s",
+  sprintf(msg, "read_sci_input(): Start to read sci input file %.900s",
           para->inpu->parameter_file_name);
   ffd_log(msg, FFD_NORMAL);
 
-  /* Ignore the first and second lines*/
-  fgets(string, 400, file_params);
-  fgets(string, 400, file_params);
-
   /*****************************************************************************
   | Convert the cell dimensions defined by SCI to coordinates in FFD
   *****************************************************************************/
@@ -120,72 +342,71 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
   delz[0]=0;
 
   /* Read cell dimensions in X, Y, Z directions*/
-  for(i=1; i<=imax; i++) fscanf(file_params, "%lf", &delx[i]);
-  fscanf(file_params,"\n");
-  for(j=1; j<=jmax; j++) fscanf(file_params, "%lf", &dely[j]);
-  fscanf(file_params,"\n");
-  for(k=1; k<=kmax; k++) fscanf(file_params, "%lf", &delz[k]);
-  fscanf(file_params,"\n");
-
-  /* Store the locations of grid cell surfaces*/
+  for(i=1; i<=imax; i++) next_real(text, &delx[i]);
+  for(j=1; j<=jmax; j++) next_real(text, &dely[j]);
+  for(k=1; k<=kmax; k++) next_real(text, &delz[k]);
+  skip_space(text);
+
+  /* Get the locations of grid cell surfaces in place of the dimensions*/
   tempx = 0.0; tempy = 0.0; tempz = 0.0;
   for(i=0; i<=imax+1; i++) {
     tempx += delx[i];
     if(i>=imax) tempx = Lx;
-    for(j=0; j<=jmax+1; j++)
-      for(k=0; k<=kmax+1; k++) var[GX][IX(i,j,k)]=tempx;
+    delx[i] = tempx;
   }
 
   for(j=0; j<=jmax+1; j++) {
     tempy += dely[j];
     if(j>=jmax) tempy = Ly;
-    for(i=0; i<=imax+1; i++)
-      for(k=0; k<=kmax+1; k++) var[GY][IX(i,j,k)] = tempy;
+    dely[j] = tempy;
   }
 
   for(k=0; k<=kmax+1; k++) {
     tempz += delz[k];
     if(k>=kmax) tempz = Lz;
-    for(i=0; i<=imax+1; i++)
-      for(j=0; j<=jmax+1; j++) var[GZ][IX(i,j,k)] = tempz;
+    delz[k] = tempz;
   }
 
   /*****************************************************************************
-  | Convert the coordinates for cell surfaces to
+  | Store the coordinates for cell surfaces and
   | the coordinates for the cell center
   *****************************************************************************/
-  FOR_ALL_CELL
+  if(fill) FOR_ALL_CELL
+    gx[IX(i,j,k)] = delx[i];
+    gy[IX(i,j,k)] = dely[j];
+    gz[IX(i,j,k)] = delz[k];
+
     if(i<1)
       x[IX(i,j,k)] = 0;
     else if(i>imax)
       x[IX(i,j,k)] = Lx;
     else
-      x[IX(i,j,k)] = (REAL) 0.5 * (gx[IX(i,j,k)]+gx[IX(i-1,j,k)]);
+      x[IX(i,j,k)] = (REAL) 0.5 * (delx[i]+delx[i-1]);
 
     if(j<1)
       y[IX(i,j,k)] = 0;
     else if(j>jmax)
       y[IX(i,j,k)] = Ly;
     else
-      y[IX(i,j,k)] = (REAL) 0.5 * (gy[IX(i,j,k)]+gy[IX(i,j-1,k)]);
+      y[IX(i,j,k)] = (REAL) 0.5 * (dely[j]+dely[j-1]);
 
     if(k<1)
       z[IX(i,j,k)] = 0;
     else if(k>kmax)
       z[IX(i,j,k)] = Lz;
     else
-      z[IX(i,j,k)] = (REAL) 0.5 * (gz[IX(i,j,k)]+gz[IX(i,j,k-1)]);
+      z[IX(i,j,k)] = (REAL) 0.5 * (delz[k]+delz[k-1]);
   END_FOR
 
   /* Get the wall property*/
-  fgets(string, 400, file_params);
+  next_line(text, string, 400);
   sscanf(string,"%d%d%d%d%d%d", &IWWALL, &IEWALL, &ISWALL,
          &INWALL, &IBWALL, &ITWALL);
 
   /*****************************************************************************
   | Read total number of boundary conditions
   *****************************************************************************/
-  fgets(string, 400, file_params);
+  next_line(text, string, 400);
   sscanf(string,"%d", &para->bc->nb_bc);
   sprintf(msg, "read_sci_input(): para->bc->nb_bc=%d", para->bc->nb_bc);
   ffd_log(msg, FFD_NORMAL);
@@ -194,7 +415,7 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
   | Read the inlet boundary conditions
   *****************************************************************************/
   /* Get number of inlet boundaries*/
-  fgets(string, 400, file_params);
+  next_line(text, string, 400);
   sscanf(string,"%d", &para->bc->nb_inlet);
   sprintf(msg, "read_sci_input(): para->bc->nb_inlet=%d", para->bc->nb_inlet);
   ffd_log(msg, FFD_NORMAL);
@@ -219,7 +440,7 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
       /*.......................................................................
       | Get the names of boundary
       .......................................................................*/
-      fgets(string, 400, file_params);
+      next_line(text, string, 400);
       /* Get the length of name (The name may contain white space)*/
       for(j=0; string[j] != '\n'; j++) {
         continue;
@@ -242,7 +463,7 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
       /*.......................................................................
       | Get the boundary conditions
       .......................................................................*/
-      fgets(string, 400, file_params);
+      next_line(text, string, 400);
       sscanf(string,"%d%d%d%d%d%d%lf%lf%lf%lf%lf", &SI, &SJ, &SK, &EI,
              &EJ, &EK, &TMP, &MASS, &U, &V, &W);
       sprintf(msg, "read_sci_input(): VX=%f, VY=%f, VZ=%f, T=%f, Xi=%f",
@@ -269,7 +490,17 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
         EK = SK + EK;
       }
 
-      /* Assign the inlet boundary condition for each cell*/
+      if(!fill) continue;
+      /* Assign the inlet boundary condition for the box*/
+      fill_box(para, var[TEMPBC], SI, SJ, SK, EI, EJ, EK, TMP);
+      fill_box(para, var[VXBC], SI, SJ, SK, EI, EJ, EK, U);
+      fill_box(para, var[VYBC], SI, SJ, SK, EI, EJ, EK, V);
+      fill_box(para, var[VZBC], SI, SJ, SK, EI, EJ, EK, W);
+      fill_box(para, var[Xi1BC], SI, SJ, SK, EI, EJ, EK, MASS);
+      /* Cell flag to be inlet*/
+      fill_box(para, flagp, SI, SJ, SK, EI, EJ, EK, INLET);
+
+      /* Add each cell to the boundary index*/
       for(ii=SI; ii<=EI; ii++)
         for(ij=SJ; ij<=EJ; ij++)
           for(ik=SK; ik<=EK; ik++) {
@@ -279,13 +510,6 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
             BINDEX[4][index] = i;
             index++;
 
-            var[TEMPBC][IX(ii,ij,ik)] = TMP;
-            var[VXBC][IX(ii,ij,ik)] = U;
-            var[VYBC][IX(ii,ij,ik)] = V;
-            var[VZBC][IX(ii,ij,ik)] = W;
-            var[Xi1BC][IX(ii,ij,ik)] = MASS;
-
-            flagp[IX(ii,ij,ik)] = INLET; /* Cell flag to be inlet*/
             if(para->outp->version==DEBUG) {
               sprintf(msg, "read_sci_input(): get inlet cell[%d,%d,%d]=%.1f",
                 ii, ij, ik, flagp[IX(ii,ij,ik)]);
@@ -300,7 +524,7 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
   /*****************************************************************************
   | Read the outlet boundary conditions
   *****************************************************************************/
-  fgets(string, 400, file_params);
+  next_line(text, string, 400);
   sscanf(string, "%d", &para->bc->nb_outlet);
   sprintf(msg, "read_sci_input(): para->bc->nb_outlet=%d", para->bc->nb_outlet);
   ffd_log(msg, FFD_NORMAL);
@@ -317,7 +541,7 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
       /*.......................................................................
       | Get the names of boundary
       .......................................................................*/
-      fgets(string, 400, file_params);
+      next_line(text, string, 400);
       /* Get the length of name (The name may contain white space)*/
       for(j=0; string[j] != '\n'; j++) {
         continue;
@@ -341,7 +565,7 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
       /*.......................................................................
       | Get the boundary conditions
       .......................................................................*/
-      fgets(string, 400, file_params);
+      next_line(text, string, 400);
       sscanf(string,"%d%d%d%d%d%d%lf%lf%lf%lf%lf",
              &SI, &SJ, &SK, &EI,
              &EJ, &EK, &TMP, &MASS, &U, &V, &W);
@@ -370,7 +594,16 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
         EJ = SJ+EJ-1;
         EK = SK+EK;
       }
-      /* Assign the outlet boundary condition for each cell*/
+      if(!fill) continue;
+      /* Give the initial value, but the value will be overwritten later*/
+      fill_box(para, var[TEMPBC], SI, SJ, SK, EI, EJ, EK, TMP);
+      fill_box(para, var[VXBC], SI, SJ, SK, EI, EJ, EK, U);
+      fill_box(para, var[VYBC], SI, SJ, SK, EI, EJ, EK, V);
+      fill_box(para, var[VZBC], SI, SJ, SK, EI, EJ, EK, W);
+      fill_box(para, var[Xi1BC], SI, SJ, SK, EI, EJ, EK, MASS);
+      fill_box(para, flagp, SI, SJ, SK, EI, EJ, EK, OUTLET);
+
+      /* Add each cell to the boundary index*/
       for(ii=SI; ii<=EI ;ii++)
         for(ij=SJ; ij<=EJ ;ij++)
           for(ik=SK; ik<=EK; ik++) {
@@ -380,13 +613,6 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
             BINDEX[4][index] = para->bc->nb_inlet + i;
             index++;
 
-            /* Give the initial value, but the value will be overwritten later*/
-            var[TEMPBC][IX(ii,ij,ik)] = TMP;
-            var[VXBC][IX(ii,ij,ik)] = U;
-            var[VYBC][IX(ii,ij,ik)] = V;
-            var[VZBC][IX(ii,ij,ik)] = W;
-            var[Xi1BC][IX(ii,ij,ik)] = MASS;
-            flagp[IX(ii,ij,ik)] = OUTLET;
             if(para->outp->version==DEBUG) {
               sprintf(msg, "read_sci_input(): get outlet cell[%d,%d,%d]=%.1f",
                 ii, ij, ik, flagp[IX(ii,ij,ik)]);
@@ -538,12 +764,12 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
   | initialize the para->bc->portID
   *****************************************************************************/
   for (i = 0; i < para->bc->nb_port; i++) {
-	  para->bc->portId[i] = 0;
+	  para->bc->portId[i] = -1;
   }
   /*****************************************************************************
   | Read the internal solid block boundary conditions
   *****************************************************************************/
-  fgets(string, 400, file_params);
+  next_line(text, string, 400);
   sscanf(string, "%d", &para->bc->nb_block);
   sprintf(msg, "read_sci_input(): para->bc->nb_block=%d", para->bc->nb_block);
   ffd_log(msg, FFD_NORMAL);
@@ -560,7 +786,7 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
       /*.......................................................................
       | Get the names of boundary
       .......................................................................*/
-      fgets(string, 400, file_params);
+      next_line(text, string, 400);
       /* Get the length of name (The name may contain white space)*/
       for(j=0; string[j] != '\n'; j++) {
         continue;
@@ -584,7 +810,7 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
       /*.......................................................................
       | Get the boundary conditions
       .......................................................................*/
-      fgets(string, 400, file_params);
+      next_line(text, string, 400);
       /* X_index_start, Y_index_Start, Z_index_Start,*/
       /* X_index_End, Y_index_End, Z_index_End,*/
       /* Thermal Condition (0: Flux; 1:Temperature), Value of thermal condition*/
@@ -618,6 +844,24 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
       else
         EK=EK+SK-1;
 
+      if(!fill || SI>EI || SJ>EJ || SK>EK) continue;
+
+      switch(FLTMP) {
+        case 1:
+          fill_box(para, var[TEMPBC], SI, SJ, SK, EI, EJ, EK, TMP);
+          break;
+        case 0:
+          fill_box(para, var[QFLUXBC], SI, SJ, SK, EI, EJ, EK, TMP);
+          break;
+        default:
+          sprintf(msg, "read_sci_input(): Thermal BC (%d)"
+            "for cell(%d,%d,%d) was not defined",
+            FLTMP, SI, SJ, SK);
+          ffd_log(msg, FFD_ERROR);
+          return 1;
+      }
+      fill_box(para, flagp, SI, SJ, SK, EI, EJ, EK, SOLID); /* Flag for solid*/
+
       for(ii=SI; ii<=EI; ii++)
         for(ij=SJ; ij<=EJ; ij++)
           for(ik=SK; ik<=EK; ik++) {
@@ -627,23 +871,6 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
             BINDEX[3][index] = FLTMP;
             BINDEX[4][index] = i;
             index++;
-
-            switch(FLTMP) {
-              case 1:
-                var[TEMPBC][IX(ii,ij,ik)] = TMP;
-                break;
-              case 0:
-                var[QFLUXBC][IX(ii,ij,ik)] = TMP;
-                break;
-              default:
-                sprintf(msg, "read_sci_input(): Thermal BC (%d)"
-                  "for cell(%d,%d,%d) was not defined",
-                  FLTMP, ii, ij, ik);
-                ffd_log(msg, FFD_ERROR);
-                return 1;
-            }
-
-            flagp[IX(ii,ij,ik)] = SOLID; /* Flag for solid*/
           } /* End of assigning value for internal solid block*/
     }
   }
@@ -651,7 +878,7 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
   /*****************************************************************************
   | Read the wall boundary conditions
   *****************************************************************************/
-  fgets(string, 400, file_params);
+  next_line(text, string, 400);
   sscanf(string,"%d", &para->bc->nb_wall);
   sprintf(msg, "read_sci_input(): para->bc->nb_wall=%d", para->bc->nb_wall);
   ffd_log(msg, FFD_NORMAL);
@@ -712,7 +939,7 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
       /*.......................................................................
       | Get the names of boundary
       .......................................................................*/
-      fgets(string, 400, file_params);
+      next_line(text, string, 400);
       /* Get the length of name (The name may contain white space)*/
       for(j=0; string[j] != '\n'; j++) {
         continue;
@@ -738,7 +965,7 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
       /* X_index_start, Y_index_Start, Z_index_Start,*/
       /* X_index_End, Y_index_End, Z_index_End,*/
       /* Thermal Condition (0: Flux; 1:Temperature), Value of thermal condition*/
-      fgets(string, 400, file_params);
+      next_line(text, string, 400);
       sscanf(string,"%d%d%d%d%d%d%d%lf", &SI, &SJ, &SK, &EI,
              &EJ, &EK, &FLTMP, &TMP);
       sprintf(msg, "read_sci_input(): ThermalBC=%d, T/q_dot=%f",
@@ -774,6 +1001,7 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
       else /* Internal*/
           EK = EK + SK -1;
 
+      if(!fill) continue;
       /* Assign value for each wall cell*/
       for(ii=SI; ii<=EI; ii++)
         for(ij=SJ; ij<=EJ; ij++)
@@ -801,7 +1029,7 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
   | Read the boundary conditions for contaminant source
   | Warning: The data is ignored in current version
   *****************************************************************************/
-  fgets(string, 400, file_params);
+  next_line(text, string, 400);
   sscanf(string,"%d", &para->bc->nb_source);
   sprintf(msg, "read_sci_input(): para->bc->nb_source=%d", para->bc->nb_source);
   ffd_log(msg, FFD_NORMAL);
@@ -819,25 +1047,25 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
     /*Warning: Need to add code to assign the BC value as other part does*/
   }
 
-  para->geom->index=index;
+  if(fill) para->geom->index=index;
 
   /*****************************************************************************
   | Read other simulation data
   *****************************************************************************/
   /* Discard the unused data*/
-  fgets(string, 400, file_params); /*maximum iteration*/
-  fgets(string, 400, file_params); /*convergence rate*/
-  fgets(string, 400, file_params); /*Turbulence model*/
-  fgets(string, 400, file_params); /*initial value*/
-  fgets(string, 400, file_params); /*minimum value*/
-  fgets(string, 400, file_params); /*maximum value*/
-  fgets(string, 400, file_params); /*fts value*/
-  fgets(string, 400, file_params); /*under relaxation*/
-  fgets(string, 400, file_params); /*reference point*/
-  fgets(string, 400, file_params); /*monitoring point*/
+  next_line(text, string, 400); /*maximum iteration*/
+  next_line(text, string, 400); /*convergence rate*/
+  next_line(text, string, 400); /*Turbulence model*/
+  next_line(text, string, 400); /*initial value*/
+  next_line(text, string, 400); /*minimum value*/
+  next_line(text, string, 400); /*maximum value*/
+  next_line(text, string, 400); /*fts value*/
+  next_line(text, string, 400); /*under relaxation*/
+  next_line(text, string, 400); /*reference point*/
+  next_line(text, string, 400); /*monitoring point*/
 
   /* Discard setting for restarting the old FFD simulation*/
-  fgets(string, 400, file_params);
+  next_line(text, string, 400);
   /*
   sscanf(string,"%d", &para->inpu->read_old_ffd_file);
   sprintf(msg, "read_sci_input(): para->inpu->read_old_ffd_file=%d",
@@ -845,12 +1073,12 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
   ffd_log(msg, FFD_NORMAL);
   */
   /* Discard the unused data*/
-  fgets(string, 400, file_params); /*print frequency*/
-  fgets(string, 400, file_params); /*Pressure variable Y/N*/
-  fgets(string, 400, file_params); /*Steady state, buoyancy.*/
+  next_line(text, string, 400); /*print frequency*/
+  next_line(text, string, 400); /*Pressure variable Y/N*/
+  next_line(text, string, 400); /*Steady state, buoyancy.*/
 
   /* Discard physical properties*/
-  fgets(string, 400, file_params);
+  next_line(text, string, 400);
   /*
   sscanf(string,"%f %f %f %f %f %f %f %f %f", &para->prob->rho,
          &para->prob->nu, &para->prob->cond,
@@ -884,7 +1112,7 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
   */
 
   /* Read simulation time settings*/
-  fgets(string, 400, file_params);
+  next_line(text, string, 400);
   sscanf(string,"%lf %lf %d", &para->mytime->t_start, &para->mytime->dt,
     &para->mytime->step_total);
 
@@ -899,18 +1127,18 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
           para->mytime->step_total);
   ffd_log(msg, FFD_NORMAL);
 
-  fgets(string, 400, file_params); /*prandtl*/
+  next_line(text, string, 400); /*prandtl*/
 
   /*****************************************************************************
   | Conclude the reading process
   *****************************************************************************/
-  fclose(file_params);
+  close_text(text);
 
   free(delx);
   free(dely);
   free(delz);
 
-  sprintf(msg, "read_sci_input(): Read sci input file %s",
+  sprintf(msg, "read_sci_input(): Read sci input file %.900s",
           para->inpu->parameter_file_name);
   ffd_log(msg, FFD_NORMAL);
   /* Free the filePath allocated in parameter_reader.c*/
@@ -931,8 +1159,8 @@ int read_sci_input(PARA_DATA *para, REAL **var, int **BINDEX) {
 		* @return 0 if no error occurred
 		*/
 int read_sci_zeroone(PARA_DATA *para, REAL **var, int **BINDEX) {
+  TEXT_DATA text;
   int i, j, k;
-  int delcount=0;
   int mark;
   int imax = para->geom->imax;
   int jmax = para->geom->jmax;
@@ -941,8 +1169,8 @@ int read_sci_zeroone(PARA_DATA *para, REAL **var, int **BINDEX) {
   int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
   REAL *flagp = var[FLAGP];
 
-  if( (file_params=fopen(para->inpu->block_file_name,"r")) == NULL ) {
-    sprintf(msg, "read_sci_input():Could not open file \"%s\"!\n",
+  if(open_text(&text, para->inpu->block_file_name)!=0) {
+    sprintf(msg, "read_sci_input():Could not open file \"%.900s\"!\n",
             para->inpu->block_file_name);
     ffd_log(msg, FFD_ERROR);
     return 1;
@@ -955,26 +1183,17 @@ int read_sci_zeroone(PARA_DATA *para, REAL **var, int **BINDEX) {
   for(k=1;k<=kmax;k++)
     for(j=1;j<=jmax;j++)
       for(i=1;i<=imax;i++) {
-        fscanf(file_params,"%d" ,&mark);
-
         /* mark=1 block cell;mark=0 fluid cell*/
-
-        if(mark==1) {
+        if(next_int(&text, &mark)==1 && mark==1) {
           flagp[IX(i,j,k)] = SOLID;
           BINDEX[0][index] = i;
           BINDEX[1][index] = j;
           BINDEX[2][index] = k;
           index++;
         }
-        delcount++;
-
-        if(delcount==25) {
-          fscanf(file_params,"\n");
-          delcount=0;
-        }
       }
 
-  fclose(file_params);
+  close_text(&text);
   para->geom->index=index;
 
   sprintf(msg, "read_sci_input(): end of reading zeroone.dat.");
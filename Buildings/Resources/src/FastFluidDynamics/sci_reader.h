@@ -34,8 +34,6 @@
 #include "utility.h"
 #endif
 
-FILE *file_params;
-
 /*
 * Read the basic index information from input.cfd
 *
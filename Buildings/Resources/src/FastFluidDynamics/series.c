@@ -0,0 +1,438 @@
+/*
+	*
+	* \file   series.c
+	*
+	* \brief  Write compressed time series of fields
+	*
+	* \author Xu Han
+	*         University of Colorado Boulder
+	*         xuha3556@colorado.edu
+	*
+	* \date   10/18/2026
+	*
+	* A group of bytes is stored in one of three modes:
+	* 0: all bytes are equal; followed by the byte
+	* 1: rANS; followed by the number of symbols (2 bytes), each symbol with
+	*    its frequency (1+2 bytes), the length of the code (4 bytes) and the
+	*    code
+	* 2: raw; followed by the bytes
+	*
+	*/
+
+#include "series.h"
+
+#define RANS_PROB_BITS 12 /* The frequencies of the symbols sum up to 2^12*/
+#define RANS_PROB_SCALE (1UL<<RANS_PROB_BITS)
+#define RANS_L (1UL<<23) /* Lower bound of the state of the coder*/
+#define SERIES_ESCAPE 0xFFFFFFFFUL /* Code of a value kept without quantization*/
+#define PLANE_HEADER 800 /* Bytes reserved for the header of a coded group*/
+
+/*
+	* Check if the host stores the least significant byte first
+	*
+	* @return 1 if the host is little-endian
+	*/
+static int little_endian(void) {
+  unsigned int one = 1;
+
+  return *(unsigned char *) &one==1;
+} /* End of little_endian()*/
+
+/*
+	* Store an unsigned number in n bytes with the least significant first
+	*
+	* @param c Pointer to the bytes
+	* @param v Number
+	* @param n Number of bytes
+	*
+	* @return No return needed
+	*/
+static void set_uint(unsigned char *c, unsigned long v, int n) {
+  int b;
+
+  for(b=0; b<n; b++) {
+    c[b] = (unsigned char) (v%256);
+    v /= 256;
+  }
+} /* End of set_uint()*/
+
+/*
+	* Store a REAL in 8 bytes with the least significant first
+	*
+	* @param c Pointer to the bytes
+	* @param v Value
+	*
+	* @return No return needed
+	*/
+static void set_real(unsigned char *c, REAL v) {
+  unsigned char r[sizeof(REAL)];
+  int b, n = (int) sizeof(REAL);
+
+  memcpy(r, &v, sizeof(REAL));
+  for(b=0; b<n; b++) c[b] = r[little_endian() ? b : n-1-b];
+} /* End of set_real()*/
+
+/*
+	* Write bytes to the file of a time series
+	*
+	* @param series Pointer to the time series
+	* @param data Pointer to the bytes
+	* @param n Number of bytes
+	*
+	* @return 0 if no error occurred
+	*/
+static int put_bytes(SERIES_DATA *series, const void *data, size_t n) {
+  if(fwrite(data, 1, n, series->file)!=n) return 1;
+  series->offset += (unsigned long) n;
+  return 0;
+} /* End of put_bytes()*/
+
+/*
+	* Code a group of bytes
+	*
+	* @param in Pointer to the bytes
+	* @param n Number of bytes
+	* @param out Pointer to the code with space for n+PLANE_HEADER bytes
+	*
+	* @return Length of the code
+	*/
+static int encode_plane(const unsigned char *in, int n, unsigned char *out) {
+  unsigned long count[256], freq[256], cum[256];
+  unsigned long x, x_max, sum;
+  unsigned char *start = out + PLANE_HEADER, *p;
+  int i, s, m, nb_sym = 0, h, len;
+
+  memset(count, 0, sizeof(count));
+  for(i=0; i<n; i++) count[in[i]]++;
+  for(s=0; s<256; s++)
+    if(count[s]>0) nb_sym++;
+
+  if(nb_sym==1) {
+    out[0] = 0;
+    out[1] = in[0];
+    return 2;
+  }
+
+  /****************************************************************************
+  | Scale the counts to frequencies that sum up to RANS_PROB_SCALE
+  ****************************************************************************/
+  sum = 0;
+  for(s=0; s<256; s++) {
+    freq[s] = (unsigned long) ((double) count[s]*RANS_PROB_SCALE/n);
+    if(count[s]>0 && freq[s]==0) freq[s] = 1;
+    sum += freq[s];
+  }
+  while(sum!=RANS_PROB_SCALE) {
+    for(m=0, s=1; s<256; s++)
+      if(freq[s]>freq[m]) m = s;
+    if(sum>RANS_PROB_SCALE) {
+      freq[m]--;
+      sum--;
+    }
+    else {
+      freq[m]++;
+      sum++;
+    }
+  }
+  for(sum=0, s=0; s<256; s++) {
+    cum[s] = sum;
+    sum += freq[s];
+  }
+
+  /****************************************************************************
+  | Code the bytes backwards, stopping if the code gets as long as the bytes
+  ****************************************************************************/
+  p = start + n;
+  x = RANS_L;
+  for(i=n-1; i>=0 && p-start>=8; i--) {
+    s = in[i];
+    x_max = ((RANS_L>>RANS_PROB_BITS)<<8) * freq[s];
+    while(x>=x_max) {
+      *--p = (unsigned char) (x & 0xff);
+      x >>= 8;
+    }
+    x = ((x/freq[s])<<RANS_PROB_BITS) + x%freq[s] + cum[s];
+  }
+  p -= 4;
+  set_uint(p, x, 4);
+  len = (int) (start + n - p);
+
+  /****************************************************************************
+  | Put the frequencies in front of the code
+  ****************************************************************************/
+  h = 0;
+  out[h++] = 1;
+  set_uint(out+h, (unsigned long) nb_sym, 2);
+  h += 2;
+  for(s=0; s<256; s++)
+    if(freq[s]>0) {
+      out[h++] = (unsigned char) s;
+      set_uint(out+h, freq[s], 2);
+      h += 2;
+    }
+  set_uint(out+h, (unsigned long) len, 4);
+  h += 4;
+
+  if(i<0 && h+len<n+1) {
+    memmove(out+h, p, len);
+    return h + len;
+  }
+
+  /* The bytes are stored as they are if coding does not shorten them*/
+  out[0] = 2;
+  memcpy(out+1, in, n);
+  return n + 1;
+} /* End of encode_plane()*/
+
+/*
+	* Code a field of a frame and write it to the file
+	*
+	* @param series Pointer to the time series
+	* @param psi Pointer to the field
+	* @param prev Pointer to the field of the previous frame as read back
+	* @param key 1: Key frame
+	*
+	* @return 0 if no error occurred
+	*/
+static int write_series_field(SERIES_DATA *series, REAL *psi, REAL *prev,
+                              int key) {
+  unsigned char c[sizeof(REAL)], d[sizeof(REAL)];
+  unsigned char *plane = series->plane;
+  unsigned long code;
+  REAL pred, r, q = 2*series->tolerance;
+  int n = series->size, nb = (int) sizeof(REAL);
+  int i, b, nb_plane, nb_esc = 0;
+
+  for(i=0; i<n; i++) {
+    /* A key frame is predicted by the neighboring value*/
+    if(key==1)
+      pred = i>0 ? prev[i-1] : 0;
+    else
+      pred = prev[i];
+
+    /**************************************************************************
+    | Lossless: XOR of the bits
+    **************************************************************************/
+    if(series->tolerance<=0) {
+      memcpy(c, &psi[i], sizeof(REAL));
+      memcpy(d, &pred, sizeof(REAL));
+      for(b=0; b<nb; b++)
+        plane[b*n+i] = c[little_endian() ? b : nb-1-b]
+                     ^ d[little_endian() ? b : nb-1-b];
+      prev[i] = psi[i];
+      continue;
+    }
+
+    /**************************************************************************
+    | Lossy: Multiple of twice the tolerance
+    **************************************************************************/
+    r = floor((psi[i]-pred)/q + 0.5);
+    if(fabs(r)<=1073741824.0 && fabs(pred+r*q-psi[i])<=series->tolerance) {
+      code = r>=0 ? 2*(unsigned long) r : 2*(unsigned long) (-r) - 1;
+      prev[i] = pred + r*q;
+    }
+    else {
+      /* Keep values that are too far from the prediction or not finite*/
+      code = SERIES_ESCAPE;
+      series->esc[nb_esc++] = psi[i];
+      prev[i] = psi[i];
+    }
+    for(b=0; b<4; b++) plane[b*n+i] = (unsigned char) ((code>>(8*b)) & 0xff);
+  }
+
+  /****************************************************************************
+  | Write the coded groups of bytes
+  ****************************************************************************/
+  nb_plane = series->tolerance<=0 ? nb : 4;
+  for(b=0; b<nb_plane; b++)
+    if(put_bytes(series, series->buf,
+                 encode_plane(plane+b*n, n, series->buf))!=0)
+      return 1;
+
+  if(series->tolerance>0) {
+    set_uint(c, (unsigned long) nb_esc, 4);
+    if(put_bytes(series, c, 4)!=0) return 1;
+    for(i=0; i<nb_esc; i++) {
+      set_real(c, series->esc[i]);
+      if(put_bytes(series, c, sizeof(REAL))!=0) return 1;
+    }
+  }
+
+  return 0;
+} /* End of write_series_field()*/
+
+	/*
+		* Create the file of a time series and write its header
+		*
+		* @param para Pointer to FFD parameters
+		* @param var Pointer to FFD simulation variables
+		* @param series Pointer to the time series
+		* @param field Pointer to the IDs of the variables of the fields
+		* @param nb_field Number of the fields
+		* @param filename Pointer to the name of the file
+		*
+		* @return 0 if no error occurred
+		*/
+int open_series(PARA_DATA *para, REAL **var, SERIES_DATA *series,
+                const int *field, int nb_field, char *filename) {
+  int imax = para->geom->imax, jmax = para->geom->jmax;
+  int kmax = para->geom->kmax;
+  int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
+  unsigned char c[sizeof(REAL)];
+  int i, j, k, n, flag;
+
+  series->size = IJMAX*(kmax+2);
+  series->nb_field = nb_field;
+  series->tolerance = para->outp->movie_tolerance>0
+                    ? para->outp->movie_tolerance : 0;
+  series->nb_frame = 0;
+  series->capacity = 0;
+  series->index = NULL;
+  series->offset = 0;
+
+  series->prev = (REAL *) calloc((size_t) nb_field*series->size, sizeof(REAL));
+  series->plane = (unsigned char *) malloc(sizeof(REAL)*series->size);
+  series->buf = (unsigned char *) malloc(series->size+PLANE_HEADER);
+  series->esc = (REAL *) malloc(series->size*sizeof(REAL));
+  if(series->prev==NULL || series->plane==NULL || series->buf==NULL
+     || series->esc==NULL) {
+    ffd_log("open_series(): Could not allocate memory for the time series.",
+            FFD_ERROR);
+    return 1;
+  }
+
+  if((series->file=fopen(filename, "wb"))==NULL) {
+    sprintf(msg, "open_series(): Could not open file %s.", filename);
+    ffd_log(msg, FFD_ERROR);
+    return 1;
+  }
+
+  /****************************************************************************
+  | Write the header
+  ****************************************************************************/
+  flag = put_bytes(series, "FFDSERIE", 8);
+  set_uint(c, (unsigned long) imax+2, 4);
+  flag = flag || put_bytes(series, c, 4);
+  set_uint(c, (unsigned long) jmax+2, 4);
+  flag = flag || put_bytes(series, c, 4);
+  set_uint(c, (unsigned long) kmax+2, 4);
+  flag = flag || put_bytes(series, c, 4);
+  set_uint(c, (unsigned long) nb_field, 4);
+  flag = flag || put_bytes(series, c, 4);
+  for(n=0; n<nb_field; n++) {
+    set_uint(c, (unsigned long) field[n], 4);
+    flag = flag || put_bytes(series, c, 4);
+  }
+  set_real(c, series->tolerance);
+  flag = flag || put_bytes(series, c, sizeof(REAL));
+
+  for(i=0; i<imax+2; i++) {
+    set_real(c, var[X][IX(i,0,0)]);
+    flag = flag || put_bytes(series, c, sizeof(REAL));
+  }
+  for(j=0; j<jmax+2; j++) {
+    set_real(c, var[Y][IX(0,j,0)]);
+    flag = flag || put_bytes(series, c, sizeof(REAL));
+  }
+  for(k=0; k<kmax+2; k++) {
+    set_real(c, var[Z][IX(0,0,k)]);
+    flag = flag || put_bytes(series, c, sizeof(REAL));
+  }
+
+  if(flag!=0) {
+    sprintf(msg, "open_series(): Could not write file %s.", filename);
+    ffd_log(msg, FFD_ERROR);
+    return 1;
+  }
+
+  return 0;
+} /* End of open_series()*/
+
+	/*
+		* Add a frame to a time series
+		*
+		* Nothing is written to the log, so that the function can run in other
+		* threads than the one of FFD.
+		*
+		* @param series Pointer to the time series
+		* @param psi Pointer to the fields of the frame
+		* @param t Time of the frame
+		* @param step Time step of the frame
+		*
+		* @return 0 if no error occurred
+		*/
+int write_series_frame(SERIES_DATA *series, REAL **psi, REAL t, int step) {
+  SERIES_ENTRY *entry;
+  unsigned char head[sizeof(REAL)+5];
+  int key = series->nb_frame%SERIES_KEY_INTERVAL==0;
+  int n;
+
+  if(series->nb_frame==series->capacity) {
+    n = series->capacity>0 ? 2*series->capacity : 64;
+    entry = (SERIES_ENTRY *) realloc(series->index, n*sizeof(SERIES_ENTRY));
+    if(entry==NULL) return 1;
+    series->index = entry;
+    series->capacity = n;
+  }
+
+  entry = &series->index[series->nb_frame];
+  entry->t = t;
+  entry->step = step;
+  entry->key = key;
+  entry->offset = series->offset;
+
+  set_real(head, t);
+  set_uint(head+sizeof(REAL), (unsigned long) step, 4);
+  head[sizeof(REAL)+4] = (unsigned char) key;
+  if(put_bytes(series, head, sizeof(head))!=0) return 1;
+
+  for(n=0; n<series->nb_field; n++)
+    if(write_series_field(series, psi[n],
+                          series->prev+(size_t) n*series->size, key)!=0)
+      return 1;
+
+  series->nb_frame++;
+  return 0;
+} /* End of write_series_frame()*/
+
+	/*
+		* Write the index of the frames, close the file and free the buffers
+		*
+		* @param series Pointer to the time series
+		*
+		* @return 0 if no error occurred
+		*/
+int close_series(SERIES_DATA *series) {
+  unsigned char c[sizeof(REAL)+13];
+  unsigned long offset = series->offset;
+  int n, flag = 0;
+
+  if(series->file!=NULL) {
+    for(n=0; n<series->nb_frame && flag==0; n++) {
+      set_real(c, series->index[n].t);
+      set_uint(c+sizeof(REAL), (unsigned long) series->index[n].step, 4);
+      c[sizeof(REAL)+4] = (unsigned char) series->index[n].key;
+      set_uint(c+sizeof(REAL)+5, series->index[n].offset, 8);
+      flag = put_bytes(series, c, sizeof(REAL)+13);
+    }
+    set_uint(c, offset, 8);
+    set_uint(c+8, (unsigned long) series->nb_frame, 4);
+    flag = flag || put_bytes(series, c, 12);
+    if(fclose(series->file)!=0) flag = 1;
+    series->file = NULL;
+  }
+
+  if(series->prev!=NULL) free(series->prev);
+  if(series->plane!=NULL) free(series->plane);
+  if(series->buf!=NULL) free(series->buf);
+  if(series->esc!=NULL) free(series->esc);
+  if(series->index!=NULL) free(series->index);
+  series->prev = NULL;
+  series->plane = NULL;
+  series->buf = NULL;
+  series->esc = NULL;
+  series->index = NULL;
+
+  return flag;
+} /* End of close_series()*/
+
@@ -0,0 +1,86 @@
+/*
+	*
+	* @file   series.h
+	*
+	* @brief  Write compressed time series of fields
+	*
+	* @author Xu Han
+	*         University of Colorado Boulder
+	*         xuha3556@colorado.edu
+	*
+	* @date   10/18/2026
+	*
+	* A time series keeps the frames of the animation in one file. A field is
+	* coded as the difference to the same field in the previous frame, or to
+	* the neighboring value in a key frame. Every SERIES_KEY_INTERVAL frames
+	* is a key frame. If outp.movie_tolerance is 0, the difference is the XOR
+	* of the bits and the fields are kept without loss. Otherwise the
+	* difference is quantized so that no value differs by more than the
+	* tolerance. The bytes of the differences are sorted by their position
+	* in the values and each group is coded by an entropy coder (rANS). An
+	* index of the frames at the end of the file allows to read any frame.
+	*
+	* All numbers are stored with the least significant byte first:
+	*
+	* Header: "FFDSERIE", imax+2, jmax+2, kmax+2, number of fields (4 bytes
+	*         each), ID of each field (4 bytes each), tolerance (8 bytes) and
+	*         coordinates of the grid lines in x, y and z (8 bytes each)
+	* Frame:  time (8 bytes), time step (4 bytes), 1 for a key frame (1 byte)
+	*         and the coded fields
+	* Index:  time (8 bytes), time step (4 bytes), 1 for a key frame (1 byte)
+	*         and position in the file (8 bytes) of each frame
+	* End:    position of the index (8 bytes) and number of frames (4 bytes)
+	*
+	*/
+#ifndef _SERIES_H
+#define _SERIES_H
+#endif
+
+#ifndef _DATA_STRUCTURE_H
+#define _DATA_STRUCTURE_H
+#include "data_structure.h"
+#endif
+
+#ifndef _UTILITY_H
+#define _UTILITY_H
+#include "utility.h"
+#endif
+
+/*
+	* Create the file of a time series and write its header
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	* @param series Pointer to the time series
+	* @param field Pointer to the IDs of the variables of the fields
+	* @param nb_field Number of the fields
+	* @param filename Pointer to the name of the file
+	*
+	* @return 0 if no error occurred
+	*/
+int open_series(PARA_DATA *para, REAL **var, SERIES_DATA *series,
+                const int *field, int nb_field, char *filename);
+
+/*
+	* Add a frame to a time series
+	*
+	* Nothing is written to the log, so that the function can run in other
+	* threads than the one of FFD.
+	*
+	* @param series Pointer to the time series
+	* @param psi Pointer to the fields of the frame
+	* @param t Time of the frame
+	* @param step Time step of the frame
+	*
+	* @return 0 if no error occurred
+	*/
+int write_series_frame(SERIES_DATA *series, REAL **psi, REAL t, int step);
+
+/*
+	* Write the index of the frames, close the file and free the buffers
+	*
+	* @param series Pointer to the time series
+	*
+	* @return 0 if no error occurred
+	*/
+int close_series(SERIES_DATA *series);
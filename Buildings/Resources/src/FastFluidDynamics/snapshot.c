@@ -0,0 +1,305 @@
+/*
+	*
+	* \file   snapshot.c
+	*
+	* \brief  Keep the FFD states at the synchronization points
+	*
+	* \author Xu Han
+	*         University of Colorado Boulder
+	*         xuha3556@colorado.edu
+	*
+	* \date   10/18/2026
+	*
+	* A state consists of the variables that are carried from one time step to
+	* the next. Each variable is compressed without loss: a value is replaced
+	* by the XOR with its neighbor in the array, which has leading zero bytes
+	* for smooth fields, and only the remaining bytes are stored. Two values
+	* share one byte holding their numbers of leading zero bytes.
+	*
+	*/
+
+#include "snapshot.h"
+
+/* Variables carried from one time step to the next*/
+static const int snap_var[] = {VX, VY, VZ, VXM, VYM, VZM, VXS, VYS, VZS, IP,
+  QFLUXBC, QFLUX, TEMP, TEMPS, TEMPM, FLAGP, VXBC, VYBC, VZBC, TEMPBC,
+  Xi1, Xi2, Xi1S, Xi2S, Xi1BC, Xi2BC, C1, C2, C1S, C2S, C1BC, C2BC, NUT};
+#define NB_SNAP_VAR (sizeof(snap_var)/sizeof(snap_var[0]))
+
+/*
+	* Get the positions of the bytes of a REAL from the most significant one
+	*
+	* @param order Pointer to the positions
+	*
+	* @return No return needed
+	*/
+static void byte_order(int *order) {
+  REAL one = 1.0;
+  unsigned char c[sizeof(REAL)];
+  int b, n = (int) sizeof(REAL);
+
+  memcpy(c, &one, sizeof(REAL));
+  /* The sign and exponent of 1.0 are in the most significant byte*/
+  for(b=0; b<n; b++)
+    order[b] = c[n-1]!=0 ? n-1-b : b;
+} /* End of byte_order()*/
+
+/*
+	* Compress a variable
+	*
+	* @param psi Pointer to the variable
+	* @param size Number of values
+	* @param order Positions of the bytes from the most significant one
+	* @param buf Pointer to the compressed data
+	*
+	* @return Number of bytes written to buf
+	*/
+static size_t compress_variable(REAL *psi, int size, int *order,
+                                unsigned char *buf) {
+  unsigned char prev[sizeof(REAL)], cur[sizeof(REAL)], x[sizeof(REAL)];
+  unsigned char *head = buf;
+  size_t n = 0;
+  int i, b, nz, nb = (int) sizeof(REAL);
+
+  memset(prev, 0, sizeof(REAL));
+  for(i=0; i<size; i++) {
+    memcpy(cur, &psi[i], sizeof(REAL));
+    for(b=0; b<nb; b++) {
+      x[b] = cur[b] ^ prev[b];
+      prev[b] = cur[b];
+    }
+    for(nz=0; nz<nb && x[order[nz]]==0; nz++);
+
+    /* Two values share the byte with the numbers of leading zero bytes*/
+    if(i%2==0) {
+      head = buf + n;
+      *head = (unsigned char) (nz<<4);
+      n++;
+    }
+    else
+      *head |= (unsigned char) nz;
+
+    for(b=nz; b<nb; b++) buf[n++] = x[order[b]];
+  }
+
+  return n;
+} /* End of compress_variable()*/
+
+/*
+	* Expand a variable compressed by compress_variable()
+	*
+	* @param psi Pointer to the variable
+	* @param size Number of values
+	* @param order Positions of the bytes from the most significant one
+	* @param buf Pointer to the compressed data
+	*
+	* @return Number of bytes read from buf
+	*/
+static size_t expand_variable(REAL *psi, int size, int *order,
+                              unsigned char *buf) {
+  unsigned char prev[sizeof(REAL)], x[sizeof(REAL)];
+  unsigned char head = 0;
+  size_t n = 0;
+  int i, b, nz, nb = (int) sizeof(REAL);
+
+  memset(prev, 0, sizeof(REAL));
+  for(i=0; i<size; i++) {
+    if(i%2==0) {
+      head = buf[n++];
+      nz = head>>4;
+    }
+    else
+      nz = head & 15;
+
+    memset(x, 0, sizeof(REAL));
+    for(b=nz; b<nb; b++) x[order[b]] = buf[n++];
+    for(b=0; b<nb; b++) prev[b] ^= x[b];
+    memcpy(&psi[i], prev, sizeof(REAL));
+  }
+
+  return n;
+} /* End of expand_variable()*/
+
+/*
+	* Compress the current state and add it to the ring of snapshots
+	*
+	* The oldest snapshot is dropped if the ring is full.
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	*
+	* @return 0 if no error occurred
+	*/
+int take_snapshot(PARA_DATA *para, REAL **var) {
+  SNAP_DATA *snap = para->snap;
+  SNAPSHOT *s;
+  int size = (para->geom->imax+2)*(para->geom->jmax+2)*(para->geom->kmax+2);
+  int order[sizeof(REAL)];
+  size_t n, i;
+
+  if(para->solv->snapshot<=0) return 0;
+
+  /****************************************************************************
+  | Allocate the ring and the buffer for the largest compressed state
+  ****************************************************************************/
+  if(snap->slot==NULL) {
+    snap->nb = para->solv->snapshot;
+    snap->slot = (SNAPSHOT *) calloc(snap->nb, sizeof(SNAPSHOT));
+    snap->tmp = (unsigned char *)
+      malloc(NB_SNAP_VAR*((size_t) size*sizeof(REAL)+(size+1)/2));
+    if(snap->slot==NULL || snap->tmp==NULL) {
+      ffd_log("take_snapshot(): Could not allocate memory for the snapshots.",
+              FFD_ERROR);
+      return 1;
+    }
+    snap->head = 0;
+    snap->tail = 0;
+  }
+
+  /****************************************************************************
+  | Compress the variables
+  ****************************************************************************/
+  byte_order(order);
+  n = 0;
+  for(i=0; i<NB_SNAP_VAR; i++)
+    n += compress_variable(var[snap_var[i]], size, order, snap->tmp+n);
+
+  /****************************************************************************
+  | Copy the compressed state to the next slot
+  ****************************************************************************/
+  if(snap->head-snap->tail==snap->nb) snap->tail++;
+  s = &snap->slot[snap->head%snap->nb];
+  if(s->capacity<n) {
+    if(s->buf!=NULL) free(s->buf);
+    s->buf = (unsigned char *) malloc(n);
+    if(s->buf==NULL) {
+      ffd_log("take_snapshot(): Could not allocate memory for the snapshot.",
+              FFD_ERROR);
+      s->capacity = 0;
+      return 1;
+    }
+    s->capacity = n;
+  }
+  memcpy(s->buf, snap->tmp, n);
+  s->size = n;
+  s->t = para->mytime->t;
+  s->step = para->mytime->step_current;
+  snap->head++;
+
+  if(para->outp->version==DEBUG) {
+    sprintf(msg, "take_snapshot(): Kept the state at t=%f[s] in %d bytes "
+            "(%.1f%% of the variables)", s->t, (int) n,
+            100.0*n/(NB_SNAP_VAR*size*sizeof(REAL)));
+    ffd_log(msg, FFD_NORMAL);
+  }
+
+  return 0;
+} /* End of take_snapshot()*/
+
+/*
+	* Restore the latest state at or before the given time
+	*
+	* The snapshots taken after the restored state are dropped. If no state
+	* is kept, FFD continues from its current state at the given time.
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	* @param t Time to which Modelica stepped back
+	*
+	* @return 0 if no error occurred
+	*/
+int restore_snapshot(PARA_DATA *para, REAL **var, REAL t) {
+  SNAP_DATA *snap = para->snap;
+  SNAPSHOT *s = NULL;
+  int size = (para->geom->imax+2)*(para->geom->jmax+2)*(para->geom->kmax+2);
+  int order[sizeof(REAL)];
+  int m;
+  size_t n, i;
+
+  /****************************************************************************
+  | Find the latest state at or before t
+  ****************************************************************************/
+  for(m=snap->head-1; m>=snap->tail && snap->slot!=NULL; m--)
+    if(snap->slot[m%snap->nb].t<=t+SMALL) {
+      s = &snap->slot[m%snap->nb];
+      break;
+    }
+
+  if(s==NULL) {
+    sprintf(msg, "restore_snapshot(): Warning: Modelica stepped back to "
+            "t=%f[s] but no state at or before that time is kept "
+            "(solv.snapshot=%d). Continue with the state at t=%f[s].", t,
+            para->solv->snapshot, para->mytime->t);
+    ffd_log(msg, FFD_NORMAL);
+    /* Follow the time of Modelica to avoid stepping back in every window*/
+    para->mytime->t = t;
+    snap->restored = 1;
+    return 0;
+  }
+
+  /****************************************************************************
+  | Expand the variables
+  ****************************************************************************/
+  byte_order(order);
+  n = 0;
+  for(i=0; i<NB_SNAP_VAR; i++)
+    n += expand_variable(var[snap_var[i]], size, order, s->buf+n);
+
+  if(n!=s->size) {
+    sprintf(msg, "restore_snapshot(): Expanded %d bytes of the state at "
+            "t=%f[s] but %d bytes were kept.", (int) n, s->t, (int) s->size);
+    ffd_log(msg, FFD_ERROR);
+    return 1;
+  }
+
+  if(fabs(s->t-t)>SMALL) {
+    sprintf(msg, "restore_snapshot(): Warning: No state is kept at t=%f[s]. "
+            "Use the state at t=%f[s] instead.", t, s->t);
+    ffd_log(msg, FFD_NORMAL);
+  }
+
+  sprintf(msg, "restore_snapshot(): Modelica stepped back from t=%f[s] to "
+          "t=%f[s]. Restored the state at t=%f[s].", para->mytime->t, t, s->t);
+  ffd_log(msg, FFD_NORMAL);
+
+  /****************************************************************************
+  | Continue from the restored state at the time requested by Modelica
+  ****************************************************************************/
+  para->mytime->t = t;
+  para->mytime->step_current = s->step;
+  /* The coefficients, the memorized windows and the record of the assigned
+     boundary conditions belong to the dropped state*/
+  para->cache->step = -1;
+  para->memo->nb_window = 0;
+  para->memo->steady = 0;
+  para->bc->assigned = 0;
+
+  snap->head = m + 1;
+  snap->restored = 1;
+  snap->nb_restore++;
+
+  return 0;
+} /* End of restore_snapshot()*/
+
+/*
+	* Free the ring of snapshots
+	*
+	* @param para Pointer to FFD parameters
+	*
+	* @return No return needed
+	*/
+void free_snapshot(PARA_DATA *para) {
+  SNAP_DATA *snap = para->snap;
+  int i;
+
+  if(snap->slot!=NULL) {
+    for(i=0; i<snap->nb; i++)
+      if(snap->slot[i].buf!=NULL) free(snap->slot[i].buf);
+    free(snap->slot);
+    snap->slot = NULL;
+  }
+  if(snap->tmp!=NULL) {
+    free(snap->tmp);
+    snap->tmp = NULL;
+  }
+} /* End of free_snapshot()*/
@@ -0,0 +1,66 @@
+/*
+	*
+	* @file   snapshot.h
+	*
+	* @brief  Keep the FFD states at the synchronization points
+	*
+	* @author Xu Han
+	*         University of Colorado Boulder
+	*         xuha3556@colorado.edu
+	*
+	* @date   10/18/2026
+	*
+	* FFD keeps the states of the last solv.snapshot synchronization points in
+	* a ring. If Modelica steps back, for example after rejecting a step, FFD
+	* restores the state at the time of the new window and computes the window
+	* again instead of continuing from the rejected state.
+	*
+	*/
+#ifndef _SNAPSHOT_H
+#define _SNAPSHOT_H
+#endif
+
+#ifndef _DATA_STRUCTURE_H
+#define _DATA_STRUCTURE_H
+#include "data_structure.h"
+#endif
+
+#ifndef _UTILITY_H
+#define _UTILITY_H
+#include "utility.h"
+#endif
+
+/*
+	* Compress the current state and add it to the ring of snapshots
+	*
+	* The oldest snapshot is dropped if the ring is full.
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	*
+	* @return 0 if no error occurred
+	*/
+int take_snapshot(PARA_DATA *para, REAL **var);
+
+/*
+	* Restore the latest state at or before the given time
+	*
+	* The snapshots taken after the restored state are dropped. If no state
+	* is kept, FFD continues from its current state at the given time.
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	* @param t Time to which Modelica stepped back
+	*
+	* @return 0 if no error occurred
+	*/
+int restore_snapshot(PARA_DATA *para, REAL **var, REAL t);
+
+/*
+	* Free the ring of snapshots
+	*
+	* @param para Pointer to FFD parameters
+	*
+	* @return No return needed
+	*/
+void free_snapshot(PARA_DATA *para);
@@ -36,11 +36,18 @@ int FFD_solver(PARA_DATA *para, REAL **var, int **BINDEX) {
   int step_total = para->mytime->step_total;
   REAL t_steady = para->mytime->t_steady;
   double t_cosim;
+  double dt0 = para->mytime->dt;
+  double dt;
   int flag, next;
+  /* Start and number of steps of the last computed window*/
+  double t_window = para->mytime->t, dt_window = 0;
+  int step_window = para->mytime->step_current, n_window = 0, n;
 
   if(para->solv->cosimulation == 1)
     t_cosim = para->mytime->t + para->cosim->modelica->dt;
 
+  para->rt->t_start = wall_time();
+
   /***************************************************************************
   | Solver Loop
   ***************************************************************************/
@@ -49,6 +56,9 @@ int FFD_solver(PARA_DATA *para, REAL **var, int **BINDEX) {
     /*-------------------------------------------------------------------------*/
     /* Integration*/
     /*-------------------------------------------------------------------------*/
+    if(para->solv->cosimulation == 1)
+      set_time_step(para, var, dt0, t_cosim);
+
     flag = vel_step(para, var, BINDEX);
     if(flag != 0) {
       ffd_log("FFD_solver(): Could not solve velocity.", FFD_ERROR);
@@ -57,23 +67,53 @@ int FFD_solver(PARA_DATA *para, REAL **var, int **BINDEX) {
     else if(para->outp->version==DEBUG)
       ffd_log("FFD_solver(): solved velocity step.", FFD_NORMAL);
 
-    flag = temp_step(para, var, BINDEX);
+    /* Behind the real-time deadline, temperature and species are updated
+       every few steps over the time since their last update. They are always
+       updated in the last step of a window.*/
+    para->rt->scalar_dt += para->mytime->dt;
+    para->rt->scalar_step++;
+    if(para->rt->scalar_step>=para->rt->scalar_interval
+       || (para->solv->cosimulation==1
+           && para->mytime->t+para->mytime->dt>t_cosim-SMALL)) {
+      dt = para->mytime->dt;
+      para->mytime->dt = para->rt->scalar_dt;
+
+      flag = temp_step(para, var, BINDEX);
+      if(flag != 0) {
+        ffd_log("FFD_solver(): Could not solve temperature.", FFD_ERROR);
+        return flag;
+      }
+      else if(para->outp->version==DEBUG)
+        ffd_log("FFD_solver(): solved temperature step.", FFD_NORMAL);
+
+      flag = den_step(para, var, BINDEX);
+      if(flag != 0) {
+        ffd_log("FFD_solver(): Could not solve trace substance.", FFD_ERROR);
+        return flag;
+      }
+      else if(para->outp->version==DEBUG)
+        ffd_log("FFD_solver(): solved density step.", FFD_NORMAL);
+
+      para->mytime->dt = dt;
+      para->rt->scalar_dt = 0;
+      para->rt->scalar_step = 0;
+    }
+
+    timing(para);
+
+    /* Copy the fields of a frame of the animation for the writer thread*/
+    flag = take_movie_frame(para, var);
     if(flag != 0) {
-      ffd_log("FFD_solver(): Could not solve temperature.", FFD_ERROR);
+      ffd_log("FFD_solver(): Could not take the frame of the animation.",
+              FFD_ERROR);
       return flag;
     }
-    else if(para->outp->version==DEBUG)
-      ffd_log("FFD_solver(): solved temperature step.", FFD_NORMAL);
 
-    flag = den_step(para, var, BINDEX);
+    flag = take_checkpoint(para, var);
     if(flag != 0) {
-      ffd_log("FFD_solver(): Could not solve trace substance.", FFD_ERROR);
+      ffd_log("FFD_solver(): Could not write the checkpoint.", FFD_ERROR);
       return flag;
     }
-    else if(para->outp->version==DEBUG)
-      ffd_log("FFD_solver(): solved density step.", FFD_NORMAL);
-
-    timing(para);
 
     /*-------------------------------------------------------------------------*/
     /* Process for Coupled simulation*/
@@ -88,6 +128,25 @@ int FFD_solver(PARA_DATA *para, REAL **var, int **BINDEX) {
           ffd_log("FFD_solver(): Coupled simulation, reached synchronization point",
                   FFD_NORMAL);
 
+        /* Check the wall clock time used for the window*/
+        check_real_time(para, para->cosim->modelica->dt);
+
+        /* The steps are shortened and adapted, so they are counted*/
+        n_window = para->mytime->step_current - step_window;
+        dt_window = para->mytime->t - t_window;
+
+        /* With an adaptive time step, the steps are weighted by their size
+           and the last step of the window is part of the average*/
+        if(para->solv->cfl>0) {
+          flag = surface_integrate(para, var, BINDEX);
+          if(flag == 0) flag = add_time_averaged_data(para, var);
+          if(flag != 0) {
+            ffd_log("FFD_solver(): Could not add the averaged data.",
+              FFD_ERROR);
+            return flag;
+          }
+        }
+
         /* Average the FFD simulation data*/
         flag = average_time(para, var);
         if(flag != 0) {
@@ -109,37 +168,63 @@ int FFD_solver(PARA_DATA *para, REAL **var, int **BINDEX) {
           ffd_log(msg, FFD_NORMAL);
         }
 				else{
+					/* Send the data of the finished window first, so that Modelica
+					   does not wait while FFD assigns the new boundary conditions*/
+					flag =  write_cosim_data(para, var);
+					if(flag != 0) {
+						ffd_log("FFD_solver(): Could not write coupled simulation data.", FFD_ERROR);
+						return flag;
+					}
+
 					/* the data for coupled simulation*/
 					flag = read_cosim_data(para, var, BINDEX);
 					if(flag != 0) {
 						ffd_log("FFD_solver(): Could not read coupled simulation data.", FFD_ERROR);
 						return flag;
 					}
-				}
-        /*.......................................................................
-        | Check if Modelica asks to stop the simulation
-        .......................................................................*/
-        if(para->cosim->para->flag==0) {
-          /* Stop the solver*/
-          next = 0;
-          sprintf(msg,
-                  "ffd_solver(): Received stop command from Modelica at "
-                  "FFD time: %f[s], Modelica Time: %f[s].",
-                  para->mytime->t, para->cosim->modelica->t);
-          ffd_log(msg, FFD_NORMAL);
-        }				
-				else{
-					flag =  write_cosim_data(para, var);
-					if(flag != 0) {
-						ffd_log("FFD_solver(): Could not write coupled simulation data.", FFD_ERROR);
-						return flag;
+					/* Continue from the restored state if Modelica stepped back*/
+					if(para->snap->restored==1) t_cosim = para->mytime->t;
+
+					/* Skip the windows with unchanged inputs once the flow is steady*/
+					while(para->memo->skip==1 && para->cosim->para->flag!=0) {
+						t_cosim += para->cosim->modelica->dt;
+						para->mytime->t = t_cosim;
+						/* Count the time steps of the window as if they were computed*/
+						/* with the steps of the last computed window*/
+						n = (int) (n_window*para->cosim->modelica->dt/dt_window + 0.5);
+						para->mytime->step_current += n>1 ? n : 1;
+						flag = write_cosim_memo(para);
+						if(flag != 0) {
+							ffd_log("FFD_solver(): Could not write the memorized data.", FFD_ERROR);
+							return flag;
+						}
+						flag = read_cosim_data(para, var, BINDEX);
+						if(flag != 0) {
+							ffd_log("FFD_solver(): Could not read coupled simulation data.", FFD_ERROR);
+							return flag;
+						}
+						if(para->snap->restored==1) t_cosim = para->mytime->t;
 					}
 
-        sprintf(msg, "ffd_solver(): Synchronized data at t=%f[s]\n", para->mytime->t);
-        ffd_log(msg, FFD_NORMAL);
+					/* Check if Modelica asked to stop while FFD was waiting*/
+					if(para->cosim->para->flag==0) {
+						next = 0;
+						sprintf(msg,
+										"ffd_solver(): Received stop command from Modelica at "
+										"FFD time: %f[s], Modelica Time: %f[s].",
+										para->mytime->t, para->cosim->modelica->t);
+						ffd_log(msg, FFD_NORMAL);
+					}
+					else {
+						sprintf(msg, "ffd_solver(): Synchronized data at t=%f[s]\n", para->mytime->t);
+						ffd_log(msg, FFD_NORMAL);
+					}
 				}
         /* Set the next synchronization time*/
         t_cosim += para->cosim->modelica->dt;
+        t_window = para->mytime->t;
+        step_window = para->mytime->step_current;
+        para->rt->t_start = wall_time();
         /* Reset all the averaged data to 0*/
         flag = reset_time_averaged_data(para, var);
         if(flag != 0) {
@@ -231,7 +316,16 @@ int FFD_solver(PARA_DATA *para, REAL **var, int **BINDEX) {
           return 1;
         }
       }
-      next = para->mytime->step_current < step_total ? 1 : 0;
+
+      /* Start the average or end the run once the flow is steady*/
+      flag = monitor_steady_state(para, var);
+      if(flag != 0) {
+        ffd_log("FFD_solver(): Could not monitor the steady state.",
+          FFD_ERROR);
+        return flag;
+      }
+      next = para->mytime->step_current < step_total
+             && para->steady->stop==0 ? 1 : 0;
     }
   } /* End of While loop*/
 
@@ -393,6 +487,14 @@ int vel_step(PARA_DATA *para, REAL **var,int **BINDEX) {
     return flag;
   }
 
+  /* Update the coefficients shared by all the equations*/
+  flag = update_coef_cache(para, var, BINDEX);
+  if(flag!=0) {
+    ffd_log("vel_step(): Could not update the coefficient cache.",
+            FFD_ERROR);
+    return flag;
+  }
+
   return flag;
 } /* End of vel_step( )*/
 
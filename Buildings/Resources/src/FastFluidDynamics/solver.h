@@ -73,6 +73,21 @@
 #include "cosimulation.h"
 #endif
 
+#ifndef _CHECKPOINT_H
+#define _CHECKPOINT_H
+#include "checkpoint.h"
+#endif
+
+#ifndef _MOVIE_H
+#define _MOVIE_H
+#include "movie.h"
+#endif
+
+#ifndef _STEADY_STATE_H
+#define _STEADY_STATE_H
+#include "steady_state.h"
+#endif
+
 /*
 	* FFD solver
 	*
@@ -39,8 +39,9 @@ REAL GS_P(PARA_DATA *para, REAL **var, int Type, REAL *x) {
 
   /****************************************************************************
   | Solve the space using G-S sovler for 5 * 6 = 30 times
+  | (fewer sweeps if a real-time deadline was missed)
   ****************************************************************************/
-  for(it=0; it<5; it++) {
+  for(it=0; it<para->rt->it_p; it++) {
     /*-------------------------------------------------------------------------
     | Solve in X(1->imax), Y(1->jmax), Z(1->kmax)
     -------------------------------------------------------------------------*/
@@ -160,7 +161,7 @@ REAL Gauss_Seidel(PARA_DATA *para, REAL **var, REAL *flag, REAL *x) {
   /****************************************************************************
   | Gauss-Seidel solver
   ****************************************************************************/
-  for(it=0; it<20; it++) {
+  for(it=0; it<para->rt->it; it++) {
     for(i=1; i<=imax; i++)
       for(j=1; j<=jmax; j++)
         for(k=1; k<=kmax; k++) {
@@ -0,0 +1,200 @@
+/*
+	*
+	* \file   steady_state.c
+	*
+	* \brief  Detect the steady state of a single simulation
+	*
+	* \author Xu Han
+	*         University of Colorado Boulder
+	*         xuha3556@colorado.edu
+	*
+	* \date   10/18/2026
+	*
+	* The room temperature and the velocity at the center of the room are the
+	* values that set_sensor_data() gives Modelica in a cosimulation.
+	*
+	*/
+
+#include "steady_state.h"
+
+/*
+	* Compare the window that ended with the previous window
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	*
+	* @return 1 if the window was steady
+	*/
+static int steady_window(PARA_DATA *para, REAL **var) {
+  STEADY_DATA *steady = para->steady;
+  int imax = para->geom->imax, jmax = para->geom->jmax;
+  int kmax = para->geom->kmax;
+  int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
+  int i, j, k, d, nb = steady->nb;
+  REAL tol = para->mytime->steady_tolerance;
+  REAL TRoo = steady->TRoo / nb, vel = steady->vel / nb, res = steady->res / nb;
+  REAL umax = 0, du = 0, Tmin, Tmax, tmp;
+  REAL dTRoo, dvel, dres;
+
+  /****************************************************************************
+  | Largest velocity, change of velocity and range of temperature
+  ****************************************************************************/
+  Tmin = var[TEMP][IX(1,1,1)];
+  Tmax = Tmin;
+  FOR_EACH_CELL
+    if(var[FLAGP][IX(i,j,k)]!=FLUID) continue;
+    tmp = var[TEMP][IX(i,j,k)];
+    if(tmp<Tmin) Tmin = tmp;
+    if(tmp>Tmax) Tmax = tmp;
+
+    for(d=0; d<3; d++) {
+      tmp = (REAL) fabs(var[VX+d][IX(i,j,k)]);
+      if(tmp>umax) umax = tmp;
+      tmp = (REAL) fabs(var[VX+d][IX(i,j,k)]-steady->u[d][IX(i,j,k)]);
+      if(tmp>du) du = tmp;
+    }
+  END_FOR
+
+  dTRoo = (REAL) fabs(TRoo-steady->TRooLast) / (Tmax-Tmin+SMALL);
+  dvel = (REAL) fabs(vel-steady->velLast) / (umax+SMALL);
+  du = du / (umax+SMALL);
+  dres = steady->resLast>0 ? (REAL) fabs(res-steady->resLast)/steady->resLast
+       : 0;
+
+  if(steady->nb_window>0) {
+    sprintf(msg, "steady_window(): Window %d ended at t=%f[s]: room "
+            "temperature %f (change %e), velocity %f[m/s] (change %e), "
+            "velocity change %e, residual %e (change %e).",
+            steady->nb_window+1, para->mytime->t, TRoo, dTRoo, vel, dvel, du,
+            res, dres);
+    ffd_log(msg, FFD_NORMAL);
+  }
+
+  steady->TRooLast = TRoo;
+  steady->velLast = vel;
+  steady->resLast = res;
+
+  return steady->nb_window>0 && dTRoo<=tol && dvel<=tol && du<=tol
+         && dres<=STEADY_RESIDUAL_CHANGE;
+} /* End of steady_window()*/
+
+/*
+	* Start a window
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	*
+	* @return No return needed
+	*/
+static void start_window(PARA_DATA *para, REAL **var) {
+  STEADY_DATA *steady = para->steady;
+  size_t size = (size_t) (para->geom->imax+2)*(para->geom->jmax+2)
+              * (para->geom->kmax+2);
+  int d;
+
+  for(d=0; d<3; d++)
+    memcpy(steady->u[d], var[VX+d], size*sizeof(REAL));
+  steady->nb = 0;
+  steady->TRoo = 0;
+  steady->vel = 0;
+  steady->res = 0;
+} /* End of start_window()*/
+
+	/*
+		* Monitor the flow for the steady state
+		*
+		* @param para Pointer to FFD parameters
+		* @param var Pointer to FFD simulation variables
+		*
+		* @return 0 if no error occurred
+		*/
+int monitor_steady_state(PARA_DATA *para, REAL **var) {
+  STEADY_DATA *steady = para->steady;
+  int imax = para->geom->imax, jmax = para->geom->jmax;
+  int kmax = para->geom->kmax;
+  int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
+  size_t size = (size_t) (imax+2)*(jmax+2)*(kmax+2);
+  int d, flag, window = para->mytime->steady_window;
+  REAL u = var[VX][IX(imax/2,jmax/2,kmax/2)],
+       v = var[VY][IX(imax/2,jmax/2,kmax/2)],
+       w = var[VZ][IX(imax/2,jmax/2,kmax/2)];
+
+  if(window<1 || steady->stop==1) return 0;
+
+  /****************************************************************************
+  | Start the first window
+  ****************************************************************************/
+  if(steady->u[0]==NULL) {
+    for(d=0; d<3; d++) {
+      steady->u[d] = (REAL *) malloc(size*sizeof(REAL));
+      if(steady->u[d]==NULL) {
+        ffd_log("monitor_steady_state(): Could not allocate memory for the "
+                "velocity.", FFD_ERROR);
+        return 1;
+      }
+    }
+    start_window(para, var);
+    return 0;
+  }
+
+  steady->TRoo += average_volume(para, var, var[TEMP]);
+  steady->vel += (REAL) sqrt(u*u + v*v + w*w);
+  steady->res += steady->residual;
+  steady->nb++;
+  if(steady->nb<window) return 0;
+
+  /****************************************************************************
+  | Compare the window with the previous one
+  ****************************************************************************/
+  if(steady_window(para, var)==1)
+    steady->nb_steady++;
+  else
+    steady->nb_steady = 0;
+  steady->nb_window++;
+  start_window(para, var);
+
+  if(steady->nb_steady<STEADY_WINDOWS) return 0;
+
+  /* Average the steady flow instead of waiting for mytime.t_steady*/
+  if(para->outp->cal_mean==0) {
+    para->outp->cal_mean = 1;
+    flag = reset_time_averaged_data(para, var);
+    if(flag != 0) {
+      ffd_log("monitor_steady_state(): Could not reset averaged data.",
+              FFD_ERROR);
+      return flag;
+    }
+    sprintf(msg, "monitor_steady_state(): The flow is steady at t=%f[s] "
+            "after %d windows of %d time steps. Start to calculate mean "
+            "properties instead of at t_steady=%f[s].", para->mytime->t,
+            steady->nb_window, window, para->mytime->t_steady);
+    ffd_log(msg, FFD_NORMAL);
+  }
+  else if(para->mytime->steady_stop==1 && para->mytime->step_mean>=window) {
+    steady->stop = 1;
+    sprintf(msg, "monitor_steady_state(): The flow is steady and was averaged "
+            "over %d time steps. Stop at t=%f[s] after %d of %d time steps.",
+            para->mytime->step_mean, para->mytime->t,
+            para->mytime->step_current, para->mytime->step_total);
+    ffd_log(msg, FFD_NORMAL);
+  }
+
+  return 0;
+} /* End of monitor_steady_state()*/
+
+	/*
+		* Free the memory of the steady state detection
+		*
+		* @param para Pointer to FFD parameters
+		*
+		* @return No return needed
+		*/
+void free_steady_state(PARA_DATA *para) {
+  int d;
+
+  for(d=0; d<3; d++)
+    if(para->steady->u[d]!=NULL) {
+      free(para->steady->u[d]);
+      para->steady->u[d] = NULL;
+    }
+} /* End of free_steady_state()*/
@@ -0,0 +1,69 @@
+/*
+	*
+	* @file   steady_state.h
+	*
+	* @brief  Detect the steady state of a single simulation
+	*
+	* @author Xu Han
+	*         University of Colorado Boulder
+	*         xuha3556@colorado.edu
+	*
+	* @date   10/18/2026
+	*
+	* If mytime.steady_window is larger than 0, the time steps of a single
+	* simulation are grouped into windows of mytime.steady_window steps.
+	* At the end of each window, the flow is compared with the previous
+	* window:
+	*
+	* - the mean room temperature, relative to the range of the temperature
+	* - the mean velocity at the center of the room, relative to the largest
+	*   velocity
+	* - the largest change of the velocity in the window, relative to the
+	*   largest velocity
+	* - the mean residual of the pressure, relative to the previous window
+	*
+	* The flow is steady once STEADY_WINDOWS windows in a row changed less
+	* than mytime.steady_tolerance and the residual leveled off. FFD then
+	* starts the time average if mytime.t_steady has not been reached. If
+	* mytime.steady_stop is 1, the simulation ends once the steady flow was
+	* averaged for a window.
+	*
+	*/
+#ifndef _STEADY_STATE_H
+#define _STEADY_STATE_H
+#endif
+
+#ifndef _DATA_STRUCTURE_H
+#define _DATA_STRUCTURE_H
+#include "data_structure.h"
+#endif
+
+#ifndef _UTILITY_H
+#define _UTILITY_H
+#include "utility.h"
+#endif
+
+#define STEADY_WINDOWS 2 /* Consecutive steady windows for a steady state*/
+#define STEADY_RESIDUAL_CHANGE 0.1 /* Relative change of the mean residual of a leveled off residual*/
+
+/*
+	* Monitor the flow for the steady state
+	*
+	* The function has to be called at the end of each time step of a single
+	* simulation, after the data for the time average was added.
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	*
+	* @return 0 if no error occurred
+	*/
+int monitor_steady_state(PARA_DATA *para, REAL **var);
+
+/*
+	* Free the memory of the steady state detection
+	*
+	* @param para Pointer to FFD parameters
+	*
+	* @return No return needed
+	*/
+void free_steady_state(PARA_DATA *para);
@@ -15,6 +15,11 @@
 	*
 	*/
 
+/* Needed for clock_gettime() and nanosleep() with -std=c89*/
+#ifndef _MSC_VER
+#define _POSIX_C_SOURCE 199309L
+#endif
+
 #include "timing.h"
 
 	/*
@@ -31,10 +36,223 @@ void timing(PARA_DATA *para) {
   para->mytime->step_current += 1;
   para->mytime->t_end = clock();
 
-  cputime= ((double) (clock() - para->mytime->t_start) / CLOCKS_PER_SEC);
+  /* Progress of the time steps is rate limited unless outp.log_level is 2*/
+  if(ffd_log_enabled(FFD_PROGRESS)) {
+    cputime= ((double) (clock() - para->mytime->t_start) / CLOCKS_PER_SEC);
 
-  sprintf(msg, "Physical time=%.4f s, CPU time=%.4f s, Time Ratio=%.4f",
-         para->mytime->t, cputime, para->mytime->t/cputime);
-  ffd_log(msg, FFD_NORMAL);
+    sprintf(msg, "Physical time=%.4f s, CPU time=%.4f s, Time Ratio=%.4f",
+           para->mytime->t, cputime, para->mytime->t/cputime);
+    ffd_log(msg, FFD_PROGRESS);
+  }
 
 } /* End of timing( )*/
+
+/*
+	* Set the size of the next time step in the coupled simulation
+	*
+	* The CFL condition uses the sum of the velocity components over the cell
+	* widths and the diffusion condition the largest diffusivity in the cell.
+	* The semi-Lagrangian advection is stable for any CFL number, so the limits
+	* control the accuracy rather than the stability.
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	* @param dt0 Time step size defined by the input file
+	* @param t_next Time of the next synchronization point
+	*
+	* @return 0 if no error occurred
+	*/
+int set_time_step(PARA_DATA *para, REAL **var, double dt0, double t_next) {
+  int i, j, k;
+  int imax = para->geom->imax, jmax = para->geom->jmax;
+  int kmax = para->geom->kmax;
+  int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
+  REAL cfl = para->solv->cfl, dif = para->solv->diffusion_number;
+  REAL nu, dx, dy, dz, c, d, c_max = 0, d_max = 0;
+  double dt = dt0, rest = t_next - para->mytime->t;
+
+  /****************************************************************************
+  | Fixed time step: shorten the step only if it passes the synchronization
+  ****************************************************************************/
+  if(cfl<=0) {
+    if(dt>rest+SMALL) dt = rest;
+    para->mytime->dt = dt;
+    return 0;
+  }
+
+  /****************************************************************************
+  | Adaptive time step: find the largest velocity and diffusivity
+  ****************************************************************************/
+  nu = para->prob->alpha>para->prob->nu ? para->prob->alpha : para->prob->nu;
+
+  FOR_EACH_CELL
+    if(var[FLAGP][IX(i,j,k)]!=FLUID) continue;
+
+    dx = length_x(para, var, i, j, k);
+    dy = length_y(para, var, i, j, k);
+    dz = length_z(para, var, i, j, k);
+
+    c = (REAL) fabs(var[VX][IX(i,j,k)])/dx + (REAL) fabs(var[VY][IX(i,j,k)])/dy
+      + (REAL) fabs(var[VZ][IX(i,j,k)])/dz;
+    if(c>c_max) c_max = c;
+
+    if(dif>0) {
+      d = nu;
+      if(para->prob->tur_model==CHEN) d += var[NUT][IX(i,j,k)];
+      d *= 1/(dx*dx) + 1/(dy*dy) + 1/(dz*dz);
+      if(d>d_max) d_max = d;
+    }
+  END_FOR
+
+  /****************************************************************************
+  | Limit the step
+  ****************************************************************************/
+  /* A step shortened for the synchronization point does not slow the growth*/
+  dt = 2 * (para->mytime->dt_free>0 ? para->mytime->dt_free : para->mytime->dt);
+  if(c_max>0 && cfl/c_max<dt) dt = cfl/c_max;
+  if(dif>0 && d_max>0 && dif/d_max<dt) dt = dif/d_max;
+  if(para->mytime->dt_max>0 && dt>para->mytime->dt_max)
+    dt = para->mytime->dt_max;
+  if(para->mytime->dt_min>0 && dt<para->mytime->dt_min)
+    dt = para->mytime->dt_min;
+  para->mytime->dt_free = dt;
+
+  /****************************************************************************
+  | Land on the synchronization point without leaving a very short last step
+  ****************************************************************************/
+  if(dt>=rest-SMALL)
+    dt = rest;
+  else if(2*dt>rest)
+    dt = 0.5*rest;
+
+  para->mytime->dt = dt;
+
+  if(para->outp->version==DEBUG) {
+    sprintf(msg, "set_time_step(): dt=%f[s] with CFL=%f and diffusion "
+            "number=%f", dt, c_max*dt, d_max*dt);
+    ffd_log(msg, FFD_NORMAL);
+  }
+
+  return 0;
+} /* End of set_time_step()*/
+
+/*
+	* Get the wall clock time
+	*
+	* @return Wall clock time in seconds from an arbitrary origin
+	*/
+double wall_time(void) {
+#ifdef _MSC_VER
+  LARGE_INTEGER freq, count;
+
+  QueryPerformanceFrequency(&freq);
+  QueryPerformanceCounter(&count);
+  return (double) count.QuadPart / (double) freq.QuadPart;
+#else
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double) now.tv_sec + 1e-9 * (double) now.tv_nsec;
+#endif
+} /* End of wall_time()*/
+
+/*
+	* Pause the current thread
+	*
+	* @param ms Time in milliseconds
+	*
+	* @return No return needed
+	*/
+void ffd_sleep(int ms) {
+#ifdef _MSC_VER
+  Sleep(ms);
+#else
+  struct timespec t;
+
+  t.tv_sec = ms/1000;
+  t.tv_nsec = (long) (ms%1000) * 1000000L;
+  nanosleep(&t, NULL);
+#endif
+} /* End of ffd_sleep()*/
+
+/*
+	* Check the real-time deadline of the finished window
+	*
+	* A window must be computed within dt_window/solv.real_time seconds of
+	* wall clock time. If it took longer, the deadline is counted as missed and
+	* the accuracy is lowered by one level: first the Gauss-Seidel sweeps are
+	* halved down to solv.min_iteration and solv.min_iteration_p, then the
+	* interval between the updates of temperature and species is doubled up to
+	* solv.max_scalar_interval. If a window took less than half of the allowed
+	* time, the last degradation is reverted. Every change is reported.
+	*
+	* @param para Pointer to FFD parameters
+	* @param dt_window Length of the finished window
+	*
+	* @return 0 if no error occurred
+	*/
+int check_real_time(PARA_DATA *para, double dt_window) {
+  REAL_TIME_DATA *rt = para->rt;
+  int it_min = para->solv->min_iteration, it_p_min = para->solv->min_iteration_p;
+  double used, allowed;
+
+  if(para->solv->real_time<=0) return 0;
+
+  used = wall_time() - rt->t_start;
+  allowed = dt_window / para->solv->real_time;
+
+  /* The floors cannot be above the full accuracy or below one sweep*/
+  if(it_min<1) it_min = 1;
+  if(it_min>GS_ITERATION) it_min = GS_ITERATION;
+  if(it_p_min<1) it_p_min = 1;
+  if(it_p_min>GS_P_ITERATION) it_p_min = GS_P_ITERATION;
+
+  /****************************************************************************
+  | Missed the deadline: lower the accuracy by one level
+  ****************************************************************************/
+  if(used>allowed) {
+    rt->nb_miss++;
+    sprintf(msg, "check_real_time(): Missed the deadline of the window ending "
+            "at t=%f[s] with %f[s] used and %f[s] allowed (%d missed)",
+            para->mytime->t, used, allowed, rt->nb_miss);
+    ffd_log(msg, FFD_NORMAL);
+
+    if(rt->it>it_min || rt->it_p>it_p_min) {
+      rt->it = rt->it/2>it_min ? rt->it/2 : it_min;
+      rt->it_p = rt->it_p/2>it_p_min ? rt->it_p/2 : it_p_min;
+      sprintf(msg, "check_real_time(): Reduced the Gauss-Seidel sweeps to %d "
+              "and for pressure to %d", rt->it, rt->it_p);
+      ffd_log(msg, FFD_NORMAL);
+    }
+    else if(2*rt->scalar_interval<=para->solv->max_scalar_interval) {
+      rt->scalar_interval *= 2;
+      sprintf(msg, "check_real_time(): Update temperature and species every "
+              "%d time steps", rt->scalar_interval);
+      ffd_log(msg, FFD_NORMAL);
+    }
+    else {
+      ffd_log("check_real_time(): Warning: The accuracy is at its floors and "
+              "cannot be lowered further.", FFD_NORMAL);
+    }
+  }
+  /****************************************************************************
+  | Well ahead of the deadline: revert the last degradation
+  ****************************************************************************/
+  else if(used<0.5*allowed) {
+    if(rt->scalar_interval>1) {
+      rt->scalar_interval /= 2;
+      sprintf(msg, "check_real_time(): Update temperature and species every "
+              "%d time steps", rt->scalar_interval);
+      ffd_log(msg, FFD_NORMAL);
+    }
+    else if(rt->it<GS_ITERATION || rt->it_p<GS_P_ITERATION) {
+      rt->it = 2*rt->it<GS_ITERATION ? 2*rt->it : GS_ITERATION;
+      rt->it_p = 2*rt->it_p<GS_P_ITERATION ? 2*rt->it_p : GS_P_ITERATION;
+      sprintf(msg, "check_real_time(): Restored the Gauss-Seidel sweeps to %d "
+              "and for pressure to %d", rt->it, rt->it_p);
+      ffd_log(msg, FFD_NORMAL);
+    }
+  }
+
+  return 0;
+} /* End of check_real_time()*/
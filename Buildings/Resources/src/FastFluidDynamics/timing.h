@@ -28,6 +28,11 @@
 #include "utility.h"
 #endif
 
+#ifndef _GEOMETRY_H
+#define _GEOMETRY_H
+#include "geometry.h"
+#endif
+
 /*
 	* Calculate the simulation time and time ratio
 	*
@@ -36,3 +41,51 @@
 	* @return No return needed
 	*/
 void timing(PARA_DATA *para);
+
+/*
+	* Set the size of the next time step in the coupled simulation
+	*
+	* With a fixed time step (solv.cfl=0), the step is only shortened if it
+	* would pass the next synchronization point. Otherwise, the step is limited
+	* by the CFL number and the diffusion number, grows by at most a factor of 2
+	* and is bounded by mytime.dt_min and mytime.dt_max. The last steps of a
+	* window are adjusted to land exactly on the synchronization point. The
+	* growth starts from the last step that was not adjusted.
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	* @param dt0 Time step size defined by the input file
+	* @param t_next Time of the next synchronization point
+	*
+	* @return 0 if no error occurred
+	*/
+int set_time_step(PARA_DATA *para, REAL **var, double dt0, double t_next);
+
+/*
+	* Get the wall clock time
+	*
+	* @return Wall clock time in seconds from an arbitrary origin
+	*/
+double wall_time(void);
+
+/*
+	* Pause the current thread
+	*
+	* @param ms Time in milliseconds
+	*
+	* @return No return needed
+	*/
+void ffd_sleep(int ms);
+
+/*
+	* Check the real-time deadline of the finished window
+	*
+	* Counts the missed deadlines and lowers the accuracy of the solver within
+	* the floors defined by the input file if a deadline was missed.
+	*
+	* @param para Pointer to FFD parameters
+	* @param dt_window Length of the finished window
+	*
+	* @return 0 if no error occurred
+	*/
+int check_real_time(PARA_DATA *para, double dt_window);
@@ -17,6 +17,20 @@
 
 #include "utility.h"
 
+#ifndef _MSC_VER
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+FFD_THREAD_LOCAL char msg[1000];
+
+/* Coupled simulation data of the FFD instance running in current thread*/
+static FFD_THREAD_LOCAL CosimulationData *log_cosim = NULL;
+
+/* Log file of the FFD instance running in current thread*/
+static FFD_THREAD_LOCAL LOG_DATA *log_data = NULL;
+
 	/*
 		* Check the residual of equation
 		*
@@ -48,9 +62,157 @@ REAL check_residual(PARA_DATA *para, REAL **var, REAL *x) {
 
 }/* End of check_residual( )*/
 
+	/*
+		* Write the queued text of a log file until the log is closed
+		*
+		* The FFD thread only moves head and the flush thread only moves tail, so
+		* the queue needs no lock.
+		*
+		* @param p Pointer to the log
+		*
+		* @return No return needed
+		*/
+#ifdef _MSC_VER
+static DWORD WINAPI log_flush_thread(void *p) {
+#else
+static void *log_flush_thread(void *p) {
+#endif
+  LOG_DATA *log = (LOG_DATA *) p;
+  unsigned long head, t;
+  size_t i, n;
+  int stop;
+
+  for(;;) {
+    stop = log->stop;
+    FFD_BARRIER();
+    head = log->head;
+
+    if(head!=log->tail) {
+      for(t=log->tail; t!=head; t+=n) {
+        i = (size_t) (t%LOG_BUFFER);
+        n = (size_t) (head-t);
+        if(n>LOG_BUFFER-i) n = LOG_BUFFER-i;
+        fwrite(log->buf+i, 1, n, log->file);
+      }
+      fflush(log->file);
+      FFD_BARRIER();
+      log->tail = head;
+    }
+    else if(stop)
+      break;
+    else
+      ffd_sleep(LOG_FLUSH_INTERVAL);
+  }
+
+  return 0;
+} /* End of log_flush_thread()*/
+
+	/*
+		* Open the log file of the current thread
+		*
+		* @param truncate 1: Start a new file; 0: Append to the file
+		*
+		* @return 0 if no error occurred
+		*/
+static int log_open(int truncate) {
+  LOG_DATA *log;
+
+  if(log_data!=NULL) {
+    if(truncate==0) return 0;
+    ffd_log_close();
+  }
+
+  log = (LOG_DATA *) calloc(1, sizeof(LOG_DATA));
+  if(log==NULL) return 1;
+
+  if(log_cosim==NULL || log_cosim->id==0)
+    strcpy(log->name, "ffd.log");
+  else
+    sprintf(log->name, "ffd%d.log", log_cosim->id);
+
+  log->file = fopen(log->name, truncate==1 ? "w" : "a");
+  if(log->file==NULL) {
+    free(log);
+    return 1;
+  }
+  log->level = 1;
+  log->t_progress = wall_time();
+
+  /* Without the queue or the thread, the text is written directly*/
+  log->buf = (char *) malloc(LOG_BUFFER);
+  if(log->buf!=NULL) {
+#ifdef _MSC_VER
+    log->thread = CreateThread(NULL, 0, log_flush_thread, (void *) log, 0,
+                               NULL);
+    log->async = log->thread!=NULL;
+#else
+    log->async = pthread_create(&log->thread, NULL, log_flush_thread,
+                                (void *) log)==0;
+#endif
+  }
+
+  log_data = log;
+  return 0;
+} /* End of log_open()*/
+
+	/*
+		* Add text to the log file of the current thread
+		*
+		* @param text Pointer to the text
+		*
+		* @return No return needed
+		*/
+static void log_put(const char *text) {
+  LOG_DATA *log = log_data;
+  size_t i, m, n = strlen(text);
+  unsigned long space;
+
+  if(log->async==0) {
+    fputs(text, log->file);
+    return;
+  }
+
+  while(n>0) {
+    /* Wait for the flush thread if the queue is full*/
+    space = LOG_BUFFER - (log->head-log->tail);
+    if(space==0) {
+      ffd_sleep(1);
+      continue;
+    }
+    m = n<space ? n : (size_t) space;
+    i = (size_t) (log->head%LOG_BUFFER);
+    if(m>LOG_BUFFER-i) m = LOG_BUFFER-i;
+    memcpy(log->buf+i, text, m);
+    FFD_BARRIER();
+    log->head += m;
+    text += m;
+    n -= m;
+  }
+} /* End of log_put()*/
+
+	/*
+		* Wait until the queued text of the current thread is in the log file
+		*
+		* @return No return needed
+		*/
+void ffd_log_flush(void) {
+  if(log_data==NULL) return;
+
+  if(log_data->async==0) {
+    fflush(log_data->file);
+    return;
+  }
+
+  while(log_data->tail!=log_data->head)
+    ffd_sleep(1);
+} /* End of ffd_log_flush()*/
+
 	/*
 		* Write the log file
 		*
+		* The message is queued and written by a flush thread. Error messages are
+		* in the file before the error is reported to Modelica.
+		*
 		* @param message Pointer the message
 		* @param msg_type Type of message
 		*
@@ -58,31 +220,134 @@ REAL check_residual(PARA_DATA *para, REAL **var, REAL *x) {
 		*/
 void ffd_log(char *message, FFD_MSG_TYPE msg_type) {
   char mymsg[400];
-  if(msg_type==FFD_NEW) {
-    if((file_log=fopen("ffd.log","w+"))==NULL) {
-        fprintf(stderr, "Error: Cannot open log file.\n");
-        exit(1);
+
+  if(log_data==NULL || msg_type==FFD_NEW) {
+    if(log_open(msg_type==FFD_NEW)!=0) {
+      fprintf(stderr, "Error: Cannot open log file.\n");
+      exit(1);
     }
   }
-  else if((file_log=fopen("ffd.log","a+"))==NULL) {
-    fprintf(stderr,"Error: Cannot open log file.\n");
-    exit(1);
-  }
 
   switch(msg_type) {
     case FFD_WARNING:
     case FFD_ERROR:
-      fprintf(file_log, "ERROR in %s\n", message);
-      sprintf(mymsg, "ERROR in FFD: %s\n", message);
-      modelicaError(mymsg);
+      log_put("ERROR in ");
+      log_put(message);
+      log_put("\n");
+      ffd_log_flush();
+      sprintf(mymsg, "ERROR in FFD: %.380s\n", message);
+      if(log_cosim!=NULL) modelicaError(log_cosim, mymsg);
       break;
     /* Normal log*/
     default:
-      fprintf(file_log, "%s\n", message);
+      if(log_data->level<1) return;
+      log_put(message);
+      log_put("\n");
   }
-  fclose(file_log);
 } /* End of ffd_log()*/
 
+	/*
+		* Check if a message would be written to the log file
+		*
+		* Call it before formatting messages in frequently executed code. At log
+		* level 1, a progress message is enabled at most every
+		* LOG_PROGRESS_INTERVAL seconds.
+		*
+		* @param msg_type Type of message
+		*
+		* @return 1 if the message would be written, 0 otherwise
+		*/
+int ffd_log_enabled(FFD_MSG_TYPE msg_type) {
+  int level = log_data==NULL ? 1 : log_data->level;
+  double now;
+
+  switch(msg_type) {
+    case FFD_WARNING:
+    case FFD_ERROR:
+    case FFD_NEW:
+      return 1;
+    case FFD_PROGRESS:
+      if(level>=2) return 1;
+      if(level<1 || log_data==NULL) return level>=1;
+      now = wall_time();
+      if(now-log_data->t_progress<LOG_PROGRESS_INTERVAL) return 0;
+      log_data->t_progress = now;
+      return 1;
+    default:
+      return level>=1;
+  }
+} /* End of ffd_log_enabled()*/
+
+	/*
+		* Set the log level of the current thread
+		*
+		* @param level 0: errors only; 1: normal messages with progress at most
+		*        every LOG_PROGRESS_INTERVAL seconds; 2: progress of every time step
+		*
+		* @return No return needed
+		*/
+void set_log_level(int level) {
+  if(log_data==NULL && log_open(0)!=0) return;
+  log_data->level = level;
+} /* End of set_log_level()*/
+
+	/*
+		* Write the rest of the queue and close the log file of the current thread
+		*
+		* @return No return needed
+		*/
+void ffd_log_close(void) {
+  LOG_DATA *log = log_data;
+
+  if(log==NULL) return;
+
+  if(log->async==1) {
+    log->stop = 1;
+    FFD_BARRIER();
+#ifdef _MSC_VER
+    WaitForSingleObject(log->thread, INFINITE);
+    CloseHandle(log->thread);
+#else
+    pthread_join(log->thread, NULL);
+#endif
+  }
+  fclose(log->file);
+  if(log->buf!=NULL) free(log->buf);
+  free(log);
+  log_data = NULL;
+} /* End of ffd_log_close()*/
+
+	/*
+		* Set the FFD instance running in current thread
+		*
+		* @param cosim Pointer to the coupled simulation data, NULL for stand
+		*        alone simulation
+		*
+		* @return No return needed
+		*/
+void set_log_instance(CosimulationData *cosim) {
+  log_cosim = cosim;
+} /* End of set_log_instance()*/
+
+	/*
+		* Get the name of an output file of the FFD instance
+		*
+		* The first instance uses the base name. The other instances append their
+		* index, so that several rooms do not overwrite the files of each other.
+		*
+		* @param para Pointer to FFD parameters
+		* @param base Base name of the file
+		* @param name Pointer to the name of the file
+		*
+		* @return No return needed
+		*/
+void instance_file_name(PARA_DATA *para, char *base, char *name) {
+  if(para->solv->cosimulation==0 || para->cosim->id==0)
+    strcpy(name, base);
+  else
+    sprintf(name, "%s%d", base, para->cosim->id);
+} /* End of instance_file_name()*/
+
 	/*
 		* Check the outflow rate of the scalar psi
 		*
@@ -318,7 +583,7 @@ int average_time(PARA_DATA *para, REAL **var) {
   int imax = para->geom->imax, jmax = para->geom->jmax;
   int kmax = para->geom->kmax;
   int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
-  int step = para->mytime->step_mean;
+  REAL step = para->mytime->w_mean;
 
   FOR_ALL_CELL
     var[VXM][IX(i,j,k)] = var[VXM][IX(i,j,k)] / step;
@@ -396,6 +661,7 @@ int reset_time_averaged_data (PARA_DATA *para, REAL **var) {
 
   /*Reset the time step to 0*/
   para->mytime->step_mean = 0;
+  para->mytime->w_mean = 0;
   return 0;
 } /* End of reset_time_averaged_data()*/
 
@@ -413,38 +679,41 @@ int add_time_averaged_data(PARA_DATA *para, REAL **var) {
   int imax = para->geom->imax, jmax = para->geom->jmax;
   int kmax = para->geom->kmax;
   int size = (imax+2) * (jmax+2) * (kmax+2);
+  /* Weight the steps by their size if the time step is adaptive*/
+  REAL w = para->solv->cfl>0 ? (REAL) para->mytime->dt : 1;
 
   /* All the cells*/
   for(i=0; i<size; i++) {
-    var[VXM][i] += var[VX][i];
-    var[VYM][i] += var[VY][i];
-    var[VZM][i] += var[VZ][i];
-    var[TEMPM][i] += var[TEMP][i];
+    var[VXM][i] += w*var[VX][i];
+    var[VYM][i] += w*var[VY][i];
+    var[VZM][i] += w*var[VZ][i];
+    var[TEMPM][i] += w*var[TEMP][i];
   }
 
   /* Wall surfaces*/
   for(i=0; i<para->bc->nb_wall; i++)
-    para->bc->temHeaMean[i] += para->bc->temHeaAve[i];
+    para->bc->temHeaMean[i] += w*para->bc->temHeaAve[i];
 
   /* Fluid ports*/
   for(i=0; i<para->bc->nb_port; i++) {
-    para->bc->TPortMean[i] += para->bc->TPortAve[i];
-    para->bc->velPortMean[i] += para->bc->velPortAve[i];
+    para->bc->TPortMean[i] += w*para->bc->TPortAve[i];
+    para->bc->velPortMean[i] += w*para->bc->velPortAve[i];
 
     for(j=0; j<para->bc->nb_Xi; j++)
-      para->bc->XiPortMean[i][j] += para->bc->XiPortAve[i][j];
+      para->bc->XiPortMean[i][j] += w*para->bc->XiPortAve[i][j];
     for(j=0; j<para->bc->nb_C; j++)
-      para->bc->CPortMean[i][j] += para->bc->CPortAve[i][j];
+      para->bc->CPortMean[i][j] += w*para->bc->CPortAve[i][j];
 
   }
 
   /* Sensor data*/
-  para->sens->TRooMean += para->sens->TRoo;
+  para->sens->TRooMean += w*para->sens->TRoo;
   for(j=0; j<para->sens->nb_sensor; j++)
-    para->sens->senValMean[j] += para->sens->senVal[j];
+    para->sens->senValMean[j] += w*para->sens->senVal[j];
 
   /* Update the step*/
   para->mytime->step_mean++;
+  para->mytime->w_mean += w;
 
   return 0;
 } /* End of add_time_averaged_data()*/
@@ -459,94 +728,18 @@ int add_time_averaged_data(PARA_DATA *para, REAL **var) {
 		* @return 0 if no error occurred
 		*/
 REAL qwall(PARA_DATA *para, REAL **var,int **BINDEX) {
-  int i, j, k;
-  int it;
-  int index = para->geom->index;
+  int f, c;
   int imax = para->geom->imax, jmax = para->geom->jmax;
-  int kmax = para->geom->kmax;
   int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
+  int *start = para->geom->face_start;
   REAL *psi=var[TEMP];
-  REAL *gx = var[GX], *gy = var[GY], *gz = var[GZ];
   REAL coeff_h=para->prob->coeff_h;
   REAL qwall=0;
+  BOUNDARY_FACE *face = para->geom->face;
 
-  REAL *flagp = var[FLAGP];
-
-  for(it=0; it<index; it++) {
-    i=BINDEX[0][it];
-    j=BINDEX[1][it];
-    k=BINDEX[2][it];
-
-    if(flagp[IX(i,j,k)]==1) {
-      if(i==0) {
-        if(flagp[IX(i+1,j,k)]<0) {
-          qwall += (psi[IX(i,j,k)]-psi[IX(i+1,j,k)])*coeff_h
-                *(gy[IX(i,j,k)]-gy[IX(i,j-1,k)])*(gz[IX(i,j,k)]-gz[IX(i,j,k-1)]);
-        }
-      }
-      else if(i==imax+1) {
-	      if(flagp[IX(i-1,j,k)]<0) {
-          qwall += (psi[IX(i,j,k)]-psi[IX(i-1,j,k)])*coeff_h
-                *(gy[IX(i,j,k)]-gy[IX(i,j-1,k)])*(gz[IX(i,j,k)]-gz[IX(i,j,k-1)]);
-        }
-      }
-		  else {
-			  if(flagp[IX(i+1,j,k)]<0) {
-          qwall += (psi[IX(i,j,k)]-psi[IX(i+1,j,k)])*coeff_h
-                *(gy[IX(i,j,k)]-gy[IX(i,j-1,k)])*(gz[IX(i,j,k)]-gz[IX(i,j,k-1)]);
-        }
-				if(flagp[IX(i-1,j,k)]<0) {
-          qwall += (psi[IX(i,j,k)]-psi[IX(i-1,j,k)])*coeff_h
-                *(gy[IX(i,j,k)]-gy[IX(i,j-1,k)])*(gz[IX(i,j,k)]-gz[IX(i,j,k-1)]);
-        }
-			}
-
-	  	if(j==0) {
-        if(flagp[IX(i,j+1,k)]<0) {
-          qwall += (psi[IX(i,j,k)]-psi[IX(i,j+1,k)])*coeff_h
-                *(gx[IX(i,j,k)]-gx[IX(i-1,j,k)])*(gz[IX(i,j,k)]-gz[IX(i,j,k-1)]);
-       }
-		  }
-		  else if(j==jmax+1) {
-		    if(flagp[IX(i,j-1,k)]<0) {
-         qwall += (psi[IX(i,j,k)]-psi[IX(i,j-1,k)])*coeff_h
-                *(gx[IX(i,j,k)]-gx[IX(i-1,j,k)])*(gz[IX(i,j,k)]-gz[IX(i,j,k-1)]);
-        }
-	  	}
-		  else {
-		    if(flagp[IX(i,j-1,k)]<0) {
-          qwall += (psi[IX(i,j,k)]-psi[IX(i,j-1,k)])*coeff_h
-                *(gx[IX(i,j,k)]-gx[IX(i-1,j,k)])*(gz[IX(i,j,k)]-gz[IX(i,j,k-1)]);
-      }
-			  if(flagp[IX(i,j+1,k)]<0) {
-          qwall += (psi[IX(i,j,k)]-psi[IX(i,j+1,k)])*coeff_h
-                *(gx[IX(i,j,k)]-gx[IX(i-1,j,k)])*(gz[IX(i,j,k)]-gz[IX(i,j,k-1)]);
-        }
-			}
-
-			if(k==0) {
-        if(flagp[IX(i,j,k+1)]<0) {
-          qwall += (psi[IX(i,j,k)]-psi[IX(i,j,k+1)])*coeff_h
-                *(gy[IX(i,j,k)]-gy[IX(i,j-1,k)])*(gx[IX(i,j,k)]-gx[IX(i-1,j,k)]);
-        }
-			}
-			else if(k==kmax+1) {
-		    if(flagp[IX(i,j,k-1)]<0) {
-          qwall += (psi[IX(i,j,k)]-psi[IX(i,j,k-1)])*coeff_h
-                *(gy[IX(i,j,k)]-gy[IX(i,j-1,k)])*(gx[IX(i,j,k)]-gx[IX(i-1,j,k)]);
-        }
-      }
-      else {
-        if(flagp[IX(i,j,k+1)]<0) {
-          qwall += (psi[IX(i,j,k)]-psi[IX(i,j,k+1)])*coeff_h
-                *(gy[IX(i,j,k)]-gy[IX(i,j-1,k)])*(gx[IX(i,j,k)]-gx[IX(i-1,j,k)]);
-        }
-        if(flagp[IX(i,j,k-1)]<0) {
-          qwall += (psi[IX(i,j,k)]-psi[IX(i,j,k-1)])*coeff_h
-                *(gy[IX(i,j,k)]-gy[IX(i,j-1,k)])*(gx[IX(i,j,k)]-gx[IX(i-1,j,k)]);
-        }
-      }
-    }
+  for(f=start[SOLID]; f<start[SOLID+1]; f++) {
+    c = IX(face[f].i,face[f].j,face[f].k);
+    qwall += (psi[c]-psi[c+face[f].nb])*coeff_h*face[f].area;
   }
 
   return qwall;
@@ -556,77 +749,62 @@ REAL qwall(PARA_DATA *para, REAL **var,int **BINDEX) {
 	/*
 		* Free memory for BINDEX
 		*
-		* @param BINDEX Pointer to the boundary index
+		* @param BINDEX Pointer to the boundary index, may be NULL
 		*
-		* @return 0 if no error occurred
+		* @return No return needed
 		*/
 void free_index(int **BINDEX) {
-  if(BINDEX[0]) free(BINDEX[0]);
-  if(BINDEX[1]) free(BINDEX[1]);
-  if(BINDEX[2]) free(BINDEX[2]);
+  int i;
+
+  if(BINDEX==NULL) return;
+  for(i=0; i<5; i++)
+    if(BINDEX[i]!=NULL) free(BINDEX[i]);
+  free(BINDEX);
 } /* End of free_index ()*/
 
 	/*
-		* Free memory for FFD simulation variables
+		* Shrink BINDEX to the number of boundary cells
 		*
-		* @param var Pointer to FFD simulation variables
+		* BINDEX is allocated for the whole grid before the boundary cells are
+		* read. Only para->geom->index entries are used after reading.
+		*
+		* @param para Pointer to FFD parameters
+		* @param BINDEX Pointer to the boundary index
 		*
 		* @return 0 if no error occurred
 		*/
+int compact_index(PARA_DATA *para, int **BINDEX) {
+  int i;
+  int *tmp;
+
+  for(i=0; i<5; i++) {
+    tmp = (int *) realloc(BINDEX[i], (para->geom->index+1)*sizeof(int));
+    if(tmp==NULL) {
+      sprintf(msg, "compact_index(): Could not reallocate memory for "
+              "BINDEX[%d].", i);
+      ffd_log(msg, FFD_ERROR);
+      return 1;
+    }
+    BINDEX[i] = tmp;
+  }
+
+  return 0;
+} /* End of compact_index()*/
+
+	/*
+		* Free memory for FFD simulation variables
+		*
+		* @param var Pointer to FFD simulation variables, may be NULL
+		*
+		* @return No return needed
+		*/
 void free_data(REAL **var) {
-  if(var[X]) free(var[X]);
-  if(var[Y]) free(var[Y]);
-  if(var[Z]) free(var[Z]);
-  if(var[VX]) free(var[VX]);
-  if(var[VY]) free(var[VY]);
-  if(var[VZ]) free(var[VZ]);
-  if(var[VXS]) free(var[VXS]);
-  if(var[VYS]) free(var[VYS]);
-  if(var[VZS]) free(var[VZS]);
-  if(var[VXM]) free(var[VXM]);
-  if(var[VYM]) free(var[VYM]);
-  if(var[VZM]) free(var[VZM]);
-  if(var[TEMP]) free(var[TEMP]);
-  if(var[TEMPM]) free(var[TEMPM]);
-  if(var[TEMPS]) free(var[TEMPS]);
-  if(var[IP]) free(var[IP]);
-  if(var[TMP1]) free(var[TMP1]);
-  if(var[TMP2]) free(var[TMP2]);
-  if(var[TMP3]) free(var[TMP3]);
-  if(var[AP]) free(var[AP]);
-  if(var[AN]) free(var[AN]);
-  if(var[AS]) free(var[AS]);
-  if(var[AE]) free(var[AE]);
-  if(var[AW]) free(var[AW]);
-  if(var[AF]) free(var[AF]);
-  if(var[AB]) free(var[AB]);
-  if(var[B])  free(var[B]);
-  if(var[GX])  free(var[GX]);
-  if(var[GY])  free(var[GY]);
-  if(var[GZ])  free(var[GZ]);
-  if(var[AP0])  free(var[AP0]);
-  if(var[PP])  free(var[PP]);
-  if(var[FLAGP])  free(var[FLAGP]);
-  if(var[FLAGU])  free(var[FLAGU]);
-  if(var[FLAGV])  free(var[FLAGV]);
-  if(var[FLAGW])  free(var[FLAGW]);
-  if(var[LOCMIN])  free(var[LOCMIN]);
-  if(var[LOCMAX])  free(var[LOCMAX]);
-  if(var[VXBC])  free(var[VXBC]);
-  if(var[VYBC])  free(var[VYBC]);
-  if(var[VZBC])  free(var[VZBC]);
-  if(var[TEMPBC])  free(var[TEMPBC]);
-  if(var[Xi1])  free(var[Xi1]);
-  if(var[Xi2])  free(var[Xi2]);
-  if(var[Xi1BC])  free(var[Xi1BC]);
-  if(var[Xi2BC])  free(var[Xi2BC]);
-  if(var[C1])  free(var[C1]);
-  if(var[C2])  free(var[C2]);
-  if(var[C1BC])  free(var[C1BC]);
-  if(var[C2BC])  free(var[C2BC]);
-  if(var[QFLUXBC])  free(var[QFLUXBC]);
-  if(var[QFLUX])  free(var[QFLUX]);
+  int i;
 
+  if(var==NULL) return;
+  for(i=0; i<=NUT; i++)
+    if(var[i]!=NULL) free(var[i]);
+  free(var);
 } /* End of free_data()*/
 
 	/*
@@ -730,3 +908,134 @@ REAL V_global_min(PARA_DATA *para, REAL **var) {
 
   return sqrt(Vmin);
 } /* End of V_global_min()*/
+
+	/*
+		* Hash a name
+		*
+		* @param name Pointer to the name
+		*
+		* @return Hash value of the name
+		*/
+unsigned long hash_name(const char *name) {
+  unsigned long h = 5381;
+
+  while(*name!='\0')
+    h = h*33 + (unsigned char) *name++;
+
+  return h;
+} /* End of hash_name()*/
+
+	/*
+		* Build a hash table of names with linear probing
+		*
+		* @param name Pointer to the names
+		* @param n Number of names
+		* @param size Pointer to the number of entries in the table
+		*
+		* @return Pointer to the table holding the positions of the names,
+		*         -1 for empty entries; NULL if an error occurred
+		*/
+int *build_name_table(char **name, int n, int *size) {
+  int i, h, *table;
+
+  /* Keep the table at most half full*/
+  for(*size=2; *size<2*n; *size*=2);
+
+  table = (int *) malloc(*size*sizeof(int));
+  if(table==NULL) return NULL;
+
+  for(h=0; h<*size; h++) table[h] = -1;
+
+  for(i=0; i<n; i++) {
+    h = (int) (hash_name(name[i]) & (unsigned long) (*size-1));
+    while(table[h]!=-1) h = (h+1) & (*size-1);
+    table[h] = i;
+  }
+
+  return table;
+} /* End of build_name_table()*/
+
+	/*
+		* Find a name in a hash table built by build_name_table()
+		*
+		* @param name Pointer to the names in the table
+		* @param table Pointer to the table
+		* @param size Number of entries in the table
+		* @param key Name to find
+		*
+		* @return Position of the name, -1 if the name is not found
+		*/
+int find_name(char **name, int *table, int size, const char *key) {
+  int h = (int) (hash_name(key) & (unsigned long) (size-1));
+
+  while(table[h]!=-1) {
+    if(strcmp(name[table[h]], key)==0) return table[h];
+    h = (h+1) & (size-1);
+  }
+
+  return -1;
+} /* End of find_name()*/
+
+	/*
+		* Map a file into memory for reading
+		*
+		* @param filename Pointer to the name of the file
+		* @param size Pointer to the number of bytes of the file
+		*
+		* @return Pointer to the content of the file, NULL if it failed
+		*/
+const unsigned char *map_file(const char *filename, size_t *size) {
+  void *data;
+#ifdef _MSC_VER
+  HANDLE file, map;
+  DWORD high, low;
+
+  file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+                     OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if(file==INVALID_HANDLE_VALUE) return NULL;
+  low = GetFileSize(file, &high);
+  if(low==INVALID_FILE_SIZE || high!=0 || low==0) {
+    CloseHandle(file);
+    return NULL;
+  }
+  map = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  CloseHandle(file);
+  if(map==NULL) return NULL;
+  /* The view keeps the mapping open*/
+  data = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(map);
+  *size = (size_t) low;
+#else
+  struct stat info;
+  int fd;
+
+  fd = open(filename, O_RDONLY);
+  if(fd<0) return NULL;
+  if(fstat(fd, &info)!=0 || info.st_size==0) {
+    close(fd);
+    return NULL;
+  }
+  data = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(data==MAP_FAILED) return NULL;
+  *size = (size_t) info.st_size;
+#endif
+
+  return (const unsigned char *) data;
+} /* End of map_file()*/
+
+	/*
+		* Release a file mapped by map_file()
+		*
+		* @param data Pointer to the content of the file
+		* @param size Number of bytes of the file
+		*
+		* @return No return needed
+		*/
+void unmap_file(const unsigned char *data, size_t size) {
+#ifdef _MSC_VER
+  UnmapViewOfFile(data);
+#else
+  munmap((void *) data, size);
+#endif
+} /* End of unmap_file()*/
@@ -34,8 +34,11 @@
 #include "geometry.h"
 #endif
 
+#ifndef _TIMING_H
+#define _TIMING_H
+#include "timing.h"
+#endif
 
-FILE *file_log;
 
 /*
 	* Check the residual of equation
@@ -51,6 +54,9 @@ REAL check_residual(PARA_DATA *para, REAL **var, REAL *x);
 /*
 	* Write the log file
 	*
+	* The message is queued and written by a flush thread. Error messages are
+	* in the file before the error is reported to Modelica.
+	*
 	* @param message Pointer the message
 	* @param msg_type Type of message
 	*
@@ -58,6 +64,64 @@ REAL check_residual(PARA_DATA *para, REAL **var, REAL *x);
 	*/
 void ffd_log(char *message, FFD_MSG_TYPE msg_type);
 
+/*
+	* Check if a message would be written to the log file
+	*
+	* Call it before formatting messages in frequently executed code.
+	*
+	* @param msg_type Type of message
+	*
+	* @return 1 if the message would be written, 0 otherwise
+	*/
+int ffd_log_enabled(FFD_MSG_TYPE msg_type);
+
+/*
+	* Set the log level of the current thread
+	*
+	* @param level 0: errors only; 1: normal messages with progress at most
+	*        every LOG_PROGRESS_INTERVAL seconds; 2: progress of every time step
+	*
+	* @return No return needed
+	*/
+void set_log_level(int level);
+
+/*
+	* Wait until the queued text of the current thread is in the log file
+	*
+	* @return No return needed
+	*/
+void ffd_log_flush(void);
+
+/*
+	* Write the rest of the queue and close the log file of the current thread
+	*
+	* @return No return needed
+	*/
+void ffd_log_close(void);
+
+/*
+	* Set the FFD instance running in current thread
+	*
+	* The log file and the error messages of ffd_log() belong to this instance.
+	*
+	* @param cosim Pointer to the coupled simulation data, NULL for stand
+	*        alone simulation
+	*
+	* @return No return needed
+	*/
+void set_log_instance(CosimulationData *cosim);
+
+/*
+	* Get the name of an output file of the FFD instance
+	*
+	* @param para Pointer to FFD parameters
+	* @param base Base name of the file
+	* @param name Pointer to the name of the file
+	*
+	* @return No return needed
+	*/
+void instance_file_name(PARA_DATA *para, char *base, char *name);
+
 /*
 	* Check the outflow rate of the scalar psi
 	*
@@ -180,18 +244,28 @@ REAL qwall(PARA_DATA *para, REAL **var,int **BINDEX);
 /*
 	* Free memory for BINDEX
 	*
+	* @param BINDEX Pointer to the boundary index, may be NULL
+	*
+	* @return No return needed
+	*/
+void free_index(int **BINDEX);
+
+/*
+	* Shrink BINDEX to the number of boundary cells
+	*
+	* @param para Pointer to FFD parameters
 	* @param BINDEX Pointer to the boundary index
 	*
 	* @return 0 if no error occurred
 	*/
-void free_index(int **BINDEX);
+int compact_index(PARA_DATA *para, int **BINDEX);
 
 /*
 	* Free memory for FFD simulation variables
 	*
-	* @param var Pointer to FFD simulation variables
+	* @param var Pointer to FFD simulation variables, may be NULL
 	*
-	* @return 0 if no error occurred
+	* @return No return needed
 	*/
 void free_data(REAL **var);
 
@@ -234,3 +308,56 @@ REAL V_global_max(PARA_DATA *para, REAL **var);
 	* @return Vmin Minimum velocity in the simulated domain
 	*/
 REAL V_global_min(PARA_DATA *para, REAL **var);
+
+/*
+	* Hash a name
+	*
+	* @param name Pointer to the name
+	*
+	* @return Hash value of the name
+	*/
+unsigned long hash_name(const char *name);
+
+/*
+	* Build a hash table of names with linear probing
+	*
+	* @param name Pointer to the names
+	* @param n Number of names
+	* @param size Pointer to the number of entries in the table
+	*
+	* @return Pointer to the table holding the positions of the names,
+	*         -1 for empty entries; NULL if an error occurred
+	*/
+int *build_name_table(char **name, int n, int *size);
+
+/*
+	* Find a name in a hash table built by build_name_table()
+	*
+	* @param name Pointer to the names in the table
+	* @param table Pointer to the table
+	* @param size Number of entries in the table
+	* @param key Name to find
+	*
+	* @return Position of the name, -1 if the name is not found
+	*/
+int find_name(char **name, int *table, int size, const char *key);
+
+/*
+	* Map a file into memory for reading
+	*
+	* @param filename Pointer to the name of the file
+	* @param size Pointer to the number of bytes of the file
+	*
+	* @return Pointer to the content of the file, NULL if it failed
+	*/
+const unsigned char *map_file(const char *filename, size_t *size);
+
+/*
+	* Release a file mapped by map_file()
+	*
+	* @param data Pointer to the content of the file
+	* @param size Number of bytes of the file
+	*
+	* @return No return needed
+	*/
+void unmap_file(const unsigned char *data, size_t size);
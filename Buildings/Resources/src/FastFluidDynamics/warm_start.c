@@ -0,0 +1,680 @@
+/*
+	*
+	* \file   warm_start.c
+	*
+	* \brief  Start from a steady solution on a coarser grid
+	*
+	* \author Xu Han
+	*         University of Colorado Boulder
+	*         xuha3556@colorado.edu
+	*
+	* \date   10/18/2026
+	*
+	* The coarse grid is a second FFD context that shares the boundary data
+	* with the simulation. It is freed before the simulation starts.
+	*
+	*/
+
+#include "warm_start.h"
+
+/* Boundary conditions averaged over the fine cells of a coarse cell*/
+static const int warm_start_bc[] = {VXBC, VYBC, VZBC, TEMPBC, QFLUXBC, Xi1BC,
+  Xi2BC, C1BC, C2BC};
+#define NB_WARM_START_BC ((int) (sizeof(warm_start_bc)/sizeof(int)))
+
+#define IXC(i,j,k) ((i)+(IMAXC)*(j)+(IJMAXC)*(k))
+
+/*
+	* Rank of a boundary type when it represents a coarse cell
+	*
+	* @param t Type of the fine cell
+	*
+	* @return Higher rank for the type that wins
+	*/
+static int boundary_rank(int t) {
+  if(t==INLET) return 3;
+  else if(t==OUTLET) return 2;
+  else if(t==SOLID) return 1;
+  else return 0;
+} /* End of boundary_rank()*/
+
+/*
+	* Free the arrays of a direction
+	*
+	* @param axis Pointer to the direction
+	*
+	* @return No return needed
+	*/
+static void free_axis(WARM_START_AXIS *axis) {
+  int l;
+
+  if(axis->map!=NULL) free(axis->map);
+  if(axis->w!=NULL) free(axis->w);
+  if(axis->wc!=NULL) free(axis->wc);
+  if(axis->gc!=NULL) free(axis->gc);
+  for(l=0; l<2; l++) {
+    if(axis->lo[l]!=NULL) free(axis->lo[l]);
+    if(axis->t[l]!=NULL) free(axis->t[l]);
+  }
+} /* End of free_axis()*/
+
+/*
+	* Merge the fine cells along one direction
+	*
+	* A direction is coarsened if it keeps at least WARM_START_MIN_CELLS
+	* cells. The last coarse cell may have fewer fine cells.
+	*
+	* @param var Pointer to FFD simulation variables
+	* @param d Direction: 0: x, 1: y, 2: z
+	* @param n Number of interior fine cells
+	* @param stride Offset between two neighboring cells in the direction
+	* @param ratio Number of fine cells merged into a coarse cell
+	* @param axis Pointer to the direction
+	*
+	* @return 0 if no error occurred
+	*/
+static int setup_axis(REAL **var, int d, int n, int stride, int ratio,
+                      WARM_START_AXIS *axis) {
+  REAL *g = var[GX+d];
+  int m, l, r, nc;
+
+  r = n>=WARM_START_MIN_CELLS*ratio ? ratio : 1;
+  nc = (n+r-1) / r;
+  axis->n = n;
+  axis->r = r;
+  axis->nc = nc;
+
+  axis->map = (int *) malloc((n+2)*sizeof(int));
+  axis->w = (REAL *) malloc((n+2)*sizeof(REAL));
+  axis->wc = (REAL *) malloc((nc+2)*sizeof(REAL));
+  axis->gc = (REAL *) malloc((nc+2)*sizeof(REAL));
+  for(l=0; l<2; l++) {
+    axis->lo[l] = (int *) malloc((n+2)*sizeof(int));
+    axis->t[l] = (REAL *) malloc((n+2)*sizeof(REAL));
+  }
+  if(axis->map==NULL || axis->w==NULL || axis->wc==NULL || axis->gc==NULL
+     || axis->lo[0]==NULL || axis->lo[1]==NULL || axis->t[0]==NULL
+     || axis->t[1]==NULL) {
+    ffd_log("setup_axis(): Could not allocate memory for the coarse grid.",
+            FFD_ERROR);
+    return 1;
+  }
+
+  for(m=0; m<=n+1; m++) {
+    if(m<1)
+      axis->map[m] = 0;
+    else if(m>n)
+      axis->map[m] = nc + 1;
+    else
+      axis->map[m] = (m-1)/r + 1;
+    axis->w[m] = (m<1 || m>n) ? 1 : g[m*stride] - g[(m-1)*stride];
+  }
+
+  axis->gc[0] = g[0];
+  for(m=1; m<=nc; m++)
+    axis->gc[m] = g[(m*r<n ? m*r : n)*stride];
+  axis->gc[nc+1] = g[(n+1)*stride];
+
+  for(m=0; m<=nc+1; m++)
+    axis->wc[m] = (m<1 || m>nc) ? 1 : axis->gc[m] - axis->gc[m-1];
+
+  return 0;
+} /* End of setup_axis()*/
+
+/*
+	* Find the coarse points around a fine point along one direction
+	*
+	* The coarse points p[0], p[stride], ... do not decrease.
+	*
+	* @param p Pointer to the coordinate of the first coarse point
+	* @param stride Offset between two coarse points
+	* @param n Number of coarse points
+	* @param q Coordinate of the fine point
+	* @param t Pointer to the weight of the coarse point above
+	*
+	* @return Coarse point below the fine point
+	*/
+static int bracket(const REAL *p, int stride, int n, REAL q, REAL *t) {
+  int lo = 0, hi = n-1, mid;
+  REAL d;
+
+  while(hi-lo>1) {
+    mid = (lo+hi) / 2;
+    if(p[mid*stride]<=q)
+      lo = mid;
+    else
+      hi = mid;
+  }
+
+  d = p[hi*stride] - p[lo*stride];
+  *t = d>0 ? (q-p[lo*stride])/d : 0;
+  if(*t<0) *t = 0;
+  else if(*t>1) *t = 1;
+
+  return lo;
+} /* End of bracket()*/
+
+/*
+	* Set the cells, the boundaries and the initial values of the coarse grid
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	* @param BINDEX Pointer to boundary index
+	* @param pc Pointer to the parameters of the coarse grid
+	* @param vc Pointer to the variables of the coarse grid
+	* @param BINDEXc Pointer to boundary index of the coarse grid
+	* @param axis Pointer to the three directions
+	*
+	* @return 0 if no error occurred
+	*/
+static int restrict_grid(PARA_DATA *para, REAL **var, int **BINDEX,
+                         PARA_DATA *pc, REAL **vc, int **BINDEXc,
+                         WARM_START_AXIS *axis) {
+  int imax = para->geom->imax, jmax = para->geom->jmax;
+  int kmax = para->geom->kmax;
+  int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
+  int imaxc = pc->geom->imax, jmaxc = pc->geom->jmax, kmaxc = pc->geom->kmax;
+  int IMAXC = imaxc+2, IJMAXC = (imaxc+2)*(jmaxc+2);
+  int size = (imax+2)*(jmax+2)*(kmax+2);
+  int sizec = (imaxc+2)*(jmaxc+2)*(kmaxc+2);
+  int i, j, k, c, f, it, n, t, index;
+  int *pos, *rep;
+  REAL w, *flagp = var[FLAGP], *flagpc = vc[FLAGP];
+  REAL *wtot = vc[TMP1], *wsol = vc[TMP2], *wsum = vc[TMP3];
+  REAL src = 0, srcc = 0;
+
+  pos = (int *) malloc(size*sizeof(int));
+  rep = (int *) malloc(sizec*sizeof(int));
+  if(pos==NULL || rep==NULL) {
+    ffd_log("restrict_grid(): Could not allocate memory for the coarse grid.",
+            FFD_ERROR);
+    if(pos!=NULL) free(pos);
+    if(rep!=NULL) free(rep);
+    return 1;
+  }
+
+  /****************************************************************************
+  | Coordinates and initial values of the coarse cells
+  ****************************************************************************/
+  for(k=0; k<=kmaxc+1; k++)
+    for(j=0; j<=jmaxc+1; j++)
+      for(i=0; i<=imaxc+1; i++) {
+        c = IXC(i,j,k);
+        vc[GX][c] = axis[0].gc[i];
+        vc[GY][c] = axis[1].gc[j];
+        vc[GZ][c] = axis[2].gc[k];
+        vc[X][c] = i<1 ? axis[0].gc[0] : (i>imaxc ? axis[0].gc[imaxc+1]
+                 : (REAL) 0.5*(axis[0].gc[i-1]+axis[0].gc[i]));
+        vc[Y][c] = j<1 ? axis[1].gc[0] : (j>jmaxc ? axis[1].gc[jmaxc+1]
+                 : (REAL) 0.5*(axis[1].gc[j-1]+axis[1].gc[j]));
+        vc[Z][c] = k<1 ? axis[2].gc[0] : (k>kmaxc ? axis[2].gc[kmaxc+1]
+                 : (REAL) 0.5*(axis[2].gc[k-1]+axis[2].gc[k]));
+        vc[VX][c] = para->init->u;
+        vc[VY][c] = para->init->v;
+        vc[VZ][c] = para->init->w;
+        vc[TEMP][c] = para->init->T;
+        vc[FLAGP][c] = FLUID;
+        vc[FLAGU][c] = FLUID;
+        vc[FLAGV][c] = FLUID;
+        vc[FLAGW][c] = FLUID;
+        rep[c] = -1;
+      }
+
+  /* First boundary cell of each fine cell*/
+  for(f=0; f<size; f++) pos[f] = -1;
+  for(it=para->geom->index-1; it>=0; it--)
+    pos[IX(BINDEX[0][it],BINDEX[1][it],BINDEX[2][it])] = it;
+
+  /****************************************************************************
+  | Find the solid fraction and the boundary that represents each coarse cell
+  ****************************************************************************/
+  FOR_ALL_CELL
+    f = IX(i,j,k);
+    c = IXC(axis[0].map[i], axis[1].map[j], axis[2].map[k]);
+    w = axis[0].w[i] * axis[1].w[j] * axis[2].w[k];
+    t = (int) flagp[f];
+
+    wtot[c] += w;
+    if(t==SOLID) wsol[c] += w;
+    if(pos[f]>=0 && (rep[c]<0
+       || boundary_rank(t)>boundary_rank((int) flagp[rep[c]])))
+      rep[c] = f;
+
+    vc[TEMPS][c] += var[TEMPS][f];
+    src += var[TEMPS][f];
+  END_FOR
+
+  for(c=0; c<sizec; c++) {
+    t = rep[c]>=0 ? (int) flagp[rep[c]] : FLUID;
+    if(t!=INLET && t!=OUTLET)
+      t = wsol[c]>0.5*wtot[c] ? SOLID : FLUID;
+    flagpc[c] = t;
+    if(t==FLUID || (rep[c]>=0 && (int) flagp[rep[c]]!=t)) rep[c] = -1;
+    wsum[c] = 0;
+  }
+
+  /****************************************************************************
+  | Average the boundary conditions over the fine cells of the same kind
+  ****************************************************************************/
+  FOR_ALL_CELL
+    f = IX(i,j,k);
+    c = IXC(axis[0].map[i], axis[1].map[j], axis[2].map[k]);
+    if(rep[c]<0 || pos[f]<0 || (int) flagp[f]!=(int) flagpc[c]) continue;
+    /* Walls with a fixed temperature and with a fixed heat flux differ*/
+    if(flagpc[c]==SOLID && BINDEX[3][pos[f]]!=BINDEX[3][pos[rep[c]]])
+      continue;
+
+    w = axis[0].w[i] * axis[1].w[j] * axis[2].w[k];
+    wsum[c] += w;
+    for(n=0; n<NB_WARM_START_BC; n++)
+      vc[warm_start_bc[n]][c] += w*var[warm_start_bc[n]][f];
+  END_FOR
+
+  /****************************************************************************
+  | Build the boundary index of the coarse grid
+  ****************************************************************************/
+  index = 0;
+  for(k=0; k<=kmaxc+1; k++)
+    for(j=0; j<=jmaxc+1; j++)
+      for(i=0; i<=imaxc+1; i++) {
+        c = IXC(i,j,k);
+        if(flagpc[c]==FLUID) srcc += vc[TEMPS][c];
+        else vc[TEMPS][c] = 0;
+
+        if(rep[c]<0) continue;
+
+        /* Inlets keep the flow rate of their fine cells*/
+        for(n=0; n<NB_WARM_START_BC; n++) {
+          if(warm_start_bc[n]<=VZBC && warm_start_bc[n]>=VXBC
+             && flagpc[c]!=SOLID)
+            vc[warm_start_bc[n]][c] /= axis[0].wc[i]*axis[1].wc[j]
+                                     * axis[2].wc[k];
+          else if(wsum[c]>0)
+            vc[warm_start_bc[n]][c] /= wsum[c];
+        }
+
+        BINDEXc[0][index] = i;
+        BINDEXc[1][index] = j;
+        BINDEXc[2][index] = k;
+        BINDEXc[3][index] = BINDEX[3][pos[rep[c]]];
+        BINDEXc[4][index] = BINDEX[4][pos[rep[c]]];
+        index++;
+      }
+  pc->geom->index = index;
+
+  /* The heat sources of the solid coarse cells go to the fluid cells*/
+  if(srcc!=0)
+    for(c=0; c<sizec; c++) vc[TEMPS][c] *= src / srcc;
+
+  for(c=0; c<sizec; c++) {
+    wtot[c] = 0;
+    wsol[c] = 0;
+    wsum[c] = 0;
+  }
+  free(pos);
+  free(rep);
+
+  /****************************************************************************
+  | Pre-calculate the data of the coarse grid as set_initial_data() does
+  ****************************************************************************/
+  mark_cell(pc, vc);
+  pc->geom->volFlu = fluid_volume(pc, vc);
+
+  if(compact_index(pc, BINDEXc)!=0 || boundary_face(pc, vc, BINDEXc)!=0) {
+    ffd_log("restrict_grid(): Could not build the boundaries of the coarse "
+            "grid.", FFD_ERROR);
+    return 1;
+  }
+
+  if(pc->prob->tur_model==CHEN
+     && (wall_distance(pc, vc)!=0 || nu_t_chen_zero_equ_field(pc, vc)!=0)) {
+    ffd_log("restrict_grid(): Could not compute the turbulent viscosity "
+            "of the coarse grid.", FFD_ERROR);
+    return 1;
+  }
+
+  return 0;
+} /* End of restrict_grid()*/
+
+/*
+	* Solve the coarse grid until it is steady
+	*
+	* The coarse grid keeps no time average, so the arrays of the means hold
+	* the values of the previous time step.
+	*
+	* @param pc Pointer to the parameters of the coarse grid
+	* @param vc Pointer to the variables of the coarse grid
+	* @param BINDEXc Pointer to boundary index of the coarse grid
+	* @param du Pointer to the relative change of the velocity in the last step
+	* @param dT Pointer to the relative change of the temperature in the last step
+	*
+	* @return Number of time steps; -1 if the coarse grid could not be solved
+	*/
+static int solve_coarse(PARA_DATA *pc, REAL **vc, int **BINDEXc,
+                        REAL *du, REAL *dT) {
+  int imax = pc->geom->imax, jmax = pc->geom->jmax, kmax = pc->geom->kmax;
+  int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
+  size_t size = (size_t) (imax+2)*(jmax+2)*(kmax+2)*sizeof(REAL);
+  int i, j, k, d, step;
+  REAL tol = pc->init->coarse_tolerance;
+  REAL umax, dumax, Tmin, Tmax, dTmax, u;
+
+  *du = 0;
+  *dT = 0;
+
+  for(step=1; step<=pc->init->coarse_step; step++) {
+    for(d=0; d<3; d++) memcpy(vc[VXM+d], vc[VX+d], size);
+    memcpy(vc[TEMPM], vc[TEMP], size);
+
+    if(vel_step(pc, vc, BINDEXc)!=0 || temp_step(pc, vc, BINDEXc)!=0
+       || den_step(pc, vc, BINDEXc)!=0) {
+      sprintf(msg, "solve_coarse(): Warning: Could not solve the time step %d "
+              "on the coarse grid.", step);
+      ffd_log(msg, FFD_NORMAL);
+      return -1;
+    }
+    pc->mytime->t += pc->mytime->dt;
+    pc->mytime->step_current++;
+
+    /*-------------------------------------------------------------------------
+    | Largest change of the fluid cells relative to the range of the values
+    -------------------------------------------------------------------------*/
+    umax = 0;
+    dumax = 0;
+    dTmax = 0;
+    Tmin = vc[TEMP][IX(1,1,1)];
+    Tmax = Tmin;
+    FOR_EACH_CELL
+      if(vc[FLAGP][IX(i,j,k)]!=FLUID) continue;
+      for(d=0; d<3; d++) {
+        u = (REAL) fabs(vc[VX+d][IX(i,j,k)]);
+        if(u>umax) umax = u;
+        u = (REAL) fabs(vc[VX+d][IX(i,j,k)]-vc[VXM+d][IX(i,j,k)]);
+        if(u>dumax) dumax = u;
+      }
+      u = vc[TEMP][IX(i,j,k)];
+      if(u<Tmin) Tmin = u;
+      if(u>Tmax) Tmax = u;
+      u = (REAL) fabs(vc[TEMP][IX(i,j,k)]-vc[TEMPM][IX(i,j,k)]);
+      if(u>dTmax) dTmax = u;
+    END_FOR
+
+    *du = dumax / (umax+SMALL);
+    *dT = dTmax / (Tmax-Tmin+SMALL);
+
+    /* A diverged solution is not used*/
+    if(*du!=*du || *dT!=*dT) {
+      sprintf(msg, "solve_coarse(): Warning: The coarse grid diverged in the "
+              "time step %d.", step);
+      ffd_log(msg, FFD_NORMAL);
+      return -1;
+    }
+
+    if(*du<=tol && *dT<=tol) break;
+  }
+
+  return step>pc->init->coarse_step ? pc->init->coarse_step : step;
+} /* End of solve_coarse()*/
+
+/*
+	* Interpolate a variable of the coarse grid to a fine point
+	*
+	* @param pc Pointer to the parameters of the coarse grid
+	* @param vc Pointer to the variables of the coarse grid
+	* @param psi Pointer to the variable of the coarse grid
+	* @param lo Coarse points below the fine point in each direction
+	* @param t Weights of the coarse points above in each direction
+	* @param fluid 1: Only the fluid cells contribute if there is any
+	*
+	* @return Interpolated value
+	*/
+static REAL interpolate(PARA_DATA *pc, REAL **vc, REAL *psi, int *lo,
+                        REAL *t, int fluid) {
+  int imax = pc->geom->imax, jmax = pc->geom->jmax;
+  int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
+  int n, c;
+  REAL w, sum = 0, wsum = 0, sum_all = 0;
+
+  for(n=0; n<8; n++) {
+    c = IX(lo[0]+(n&1), lo[1]+((n>>1)&1), lo[2]+((n>>2)&1));
+    w = ((n&1) ? t[0] : 1-t[0]) * (((n>>1)&1) ? t[1] : 1-t[1])
+      * (((n>>2)&1) ? t[2] : 1-t[2]);
+    sum_all += w*psi[c];
+    if(fluid==0 || vc[FLAGP][c]==FLUID) {
+      sum += w*psi[c];
+      wsum += w;
+    }
+  }
+
+  if(fluid==0)
+    return sum_all;
+  else
+    return wsum>SMALL ? sum/wsum : sum_all;
+} /* End of interpolate()*/
+
+/*
+	* Interpolate the solution of the coarse grid to the fluid cells
+	*
+	* The velocities are interpolated to the surfaces where they are
+	* stored, the temperature and the pressure to the cell centers.
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	* @param pc Pointer to the parameters of the coarse grid
+	* @param vc Pointer to the variables of the coarse grid
+	* @param axis Pointer to the three directions
+	*
+	* @return No return needed
+	*/
+static void prolong(PARA_DATA *para, REAL **var, PARA_DATA *pc, REAL **vc,
+                    WARM_START_AXIS *axis) {
+  int imax = para->geom->imax, jmax = para->geom->jmax;
+  int kmax = para->geom->kmax;
+  int IMAX = imax+2, IJMAX = (imax+2)*(jmax+2);
+  int imaxc = pc->geom->imax, jmaxc = pc->geom->jmax;
+  int stride[3], stridec[3];
+  int i, j, k, d, e, l, m, lo[3];
+  int idx[3];
+  REAL t[3];
+
+  stride[0] = 1;
+  stride[1] = IMAX;
+  stride[2] = IJMAX;
+  stridec[0] = 1;
+  stridec[1] = imaxc+2;
+  stridec[2] = (imaxc+2)*(jmaxc+2);
+
+  /* The grids are structured, so the coarse points around a fine point
+     are found in each direction once*/
+  for(d=0; d<3; d++)
+    for(l=0; l<2; l++)
+      for(m=0; m<=axis[d].n+1; m++)
+        axis[d].lo[l][m] = bracket(l==0 ? vc[X+d] : vc[GX+d], stridec[d],
+                                   axis[d].nc+2,
+                                   l==0 ? var[X+d][m*stride[d]]
+                                        : var[GX+d][m*stride[d]],
+                                   &axis[d].t[l][m]);
+
+  FOR_EACH_CELL
+    idx[0] = i;
+    idx[1] = j;
+    idx[2] = k;
+
+    /* Velocity component d is stored on the surface in direction d*/
+    for(d=0; d<3; d++) {
+      if(var[FLAGU+d][IX(i,j,k)]!=FLUID) continue;
+      for(e=0; e<3; e++) {
+        l = e==d ? 1 : 0;
+        lo[e] = axis[e].lo[l][idx[e]];
+        t[e] = axis[e].t[l][idx[e]];
+      }
+      var[VX+d][IX(i,j,k)] = interpolate(pc, vc, vc[VX+d], lo, t, 0);
+    }
+
+    if(var[FLAGP][IX(i,j,k)]!=FLUID) continue;
+    for(e=0; e<3; e++) {
+      lo[e] = axis[e].lo[0][idx[e]];
+      t[e] = axis[e].t[0][idx[e]];
+    }
+    var[TEMP][IX(i,j,k)] = interpolate(pc, vc, vc[TEMP], lo, t, 1);
+    var[IP][IX(i,j,k)] = interpolate(pc, vc, vc[IP], lo, t, 1);
+  END_FOR
+} /* End of prolong()*/
+
+/*
+	* Free the coarse grid
+	*
+	* @param c Pointer to the context of the coarse grid
+	*
+	* @return No return needed
+	*/
+static void free_coarse(FFD_CONTEXT *c) {
+  free_context(c);
+  free(c);
+} /* End of free_coarse()*/
+
+	/*
+		* Set the initial values from a steady solution on a coarse grid
+		*
+		* @param para Pointer to FFD parameters
+		* @param var Pointer to FFD simulation variables
+		* @param BINDEX Pointer to boundary index
+		*
+		* @return 0 if no error occurred
+		*/
+int warm_start(PARA_DATA *para, REAL **var, int **BINDEX) {
+  FFD_CONTEXT *c;
+  PARA_DATA *pc;
+  WARM_START_AXIS axis[3];
+  int n[3], stride[3];
+  int d, r, step, flag = 0;
+  REAL du, dT;
+  double t0 = wall_time();
+
+  if(para->init->coarse_step<1 || para->inpu->read_old_ffd_file==1)
+    return 0;
+
+  n[0] = para->geom->imax;
+  n[1] = para->geom->jmax;
+  n[2] = para->geom->kmax;
+  stride[0] = 1;
+  stride[1] = para->geom->imax+2;
+  stride[2] = (para->geom->imax+2)*(para->geom->jmax+2);
+
+  memset(axis, 0, sizeof(axis));
+  for(d=0; d<3 && flag==0; d++)
+    flag = setup_axis(var, d, n[d], stride[d], para->init->coarse_ratio,
+                      &axis[d]);
+
+  if(flag==0 && axis[0].r==1 && axis[1].r==1 && axis[2].r==1) {
+    sprintf(msg, "warm_start(): Warning: The grid %dx%dx%d is too small for a "
+            "coarse grid with init.coarse_ratio=%d. The simulation starts "
+            "from the initial values.", n[0], n[1], n[2],
+            para->init->coarse_ratio);
+    ffd_log(msg, FFD_NORMAL);
+    for(d=0; d<3; d++) free_axis(&axis[d]);
+    return 0;
+  }
+
+  c = flag==0 ? (FFD_CONTEXT *) calloc(1, sizeof(FFD_CONTEXT)) : NULL;
+  if(c==NULL) {
+    ffd_log("warm_start(): Could not allocate memory for the coarse grid.",
+            FFD_ERROR);
+    for(d=0; d<3; d++) free_axis(&axis[d]);
+    return 1;
+  }
+
+  /****************************************************************************
+  | Parameters of the coarse grid
+  ****************************************************************************/
+  pc = &c->para;
+  pc->geom = &c->geom;
+  pc->inpu = &c->inpu;
+  pc->outp = &c->outp;
+  pc->prob = &c->prob;
+  pc->mytime = &c->mytime;
+  pc->solv = &c->solv;
+  pc->init = &c->init;
+  pc->cache = &c->cache;
+  pc->memo = &c->memo;
+  pc->snap = &c->snap;
+  pc->rt = &c->rt;
+  pc->movie = &c->movie;
+  pc->steady = &c->steady;
+  /* Only read from the solver of the coarse grid*/
+  pc->bc = para->bc;
+  pc->sens = para->sens;
+  pc->cosim = para->cosim;
+
+  c->geom = *para->geom;
+  c->geom.imax = axis[0].nc;
+  c->geom.jmax = axis[1].nc;
+  c->geom.kmax = axis[2].nc;
+  c->geom.dx = c->geom.Lx / c->geom.imax;
+  c->geom.dy = c->geom.Ly / c->geom.jmax;
+  c->geom.dz = c->geom.Lz / c->geom.kmax;
+  c->geom.pindex = c->geom.jmax / 2;
+  c->geom.index = 0;
+  c->geom.face = NULL;
+  c->geom.nb_face = 0;
+  c->geom.cached = 0;
+
+  c->prob = *para->prob;
+  c->init = *para->init;
+  c->rt = *para->rt;
+  c->cache.step = -1;
+
+  c->outp = *para->outp;
+  c->outp.version = RUN;
+  c->outp.cal_mean = 0;
+
+  c->solv = *para->solv;
+  c->solv.cosimulation = 0;
+  c->solv.memo_tolerance = 0;
+  c->solv.snapshot = 0;
+  c->solv.real_time = 0;
+
+  /* The coarse cells allow a larger time step for the same CFL number*/
+  r = axis[0].r;
+  for(d=1; d<3; d++)
+    if(axis[d].r<r) r = axis[d].r;
+  c->mytime = *para->mytime;
+  c->mytime.t = 0;
+  c->mytime.step_current = 0;
+  c->mytime.dt = para->mytime->dt * r;
+
+  /****************************************************************************
+  | Solve the coarse grid and interpolate the solution
+  ****************************************************************************/
+  if(allocate_memory(c)!=0
+     || restrict_grid(para, var, BINDEX, pc, c->var, c->BINDEX, axis)!=0) {
+    ffd_log("warm_start(): Could not set the coarse grid.", FFD_ERROR);
+    flag = 1;
+  }
+  else {
+    sprintf(msg, "warm_start(): Solving the coarse grid %dx%dx%d with %d "
+            "boundary cells and a time step of %f[s].", c->geom.imax,
+            c->geom.jmax, c->geom.kmax, c->geom.index, c->mytime.dt);
+    ffd_log(msg, FFD_NORMAL);
+
+    step = solve_coarse(pc, c->var, c->BINDEX, &du, &dT);
+    if(step<0)
+      ffd_log("warm_start(): Warning: The simulation starts from the initial "
+              "values.", FFD_NORMAL);
+    else {
+      prolong(para, var, pc, c->var, axis);
+      sprintf(msg, "warm_start(): Interpolated the coarse grid after %d time "
+              "steps (%f[s]) in %.3f[s]; relative change in the last step: "
+              "velocity %e, temperature %e%s.", step, c->mytime.t,
+              wall_time()-t0, du, dT,
+              du<=c->init.coarse_tolerance && dT<=c->init.coarse_tolerance
+              ? "" : " (not steady)");
+      ffd_log(msg, FFD_NORMAL);
+    }
+  }
+
+  free_coarse(c);
+  for(d=0; d<3; d++) free_axis(&axis[d]);
+
+  return flag;
+} /* End of warm_start()*/
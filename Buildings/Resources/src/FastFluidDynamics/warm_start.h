@@ -0,0 +1,84 @@
+/*
+	*
+	* @file   warm_start.h
+	*
+	* @brief  Start from a steady solution on a coarser grid
+	*
+	* @author Xu Han
+	*         University of Colorado Boulder
+	*         xuha3556@colorado.edu
+	*
+	* @date   10/18/2026
+	*
+	* If init.coarse_step is larger than 0, FFD merges init.coarse_ratio
+	* cells in each direction into one cell and solves the flow on the
+	* coarse grid until the relative change in a time step is below
+	* init.coarse_tolerance or init.coarse_step time steps are done. The
+	* velocities, the temperature and the pressure of the coarse grid are
+	* then interpolated to the fluid cells of the grid of the simulation.
+	*
+	* The cells and boundary conditions of the coarse grid are derived from
+	* the cells of the simulation: a coarse cell is an inlet or an outlet if
+	* one of its cells is, a solid if solid cells fill more than half of it,
+	* and fluid otherwise. The velocities of the inlets are scaled, so that
+	* the coarse grid has the same inflow.
+	*
+	*/
+#ifndef _WARM_START_H
+#define _WARM_START_H
+#endif
+
+#ifndef _DATA_STRUCTURE_H
+#define _DATA_STRUCTURE_H
+#include "data_structure.h"
+#endif
+
+#ifndef _UTILITY_H
+#define _UTILITY_H
+#include "utility.h"
+#endif
+
+#ifndef _SOLVER_H
+#define _SOLVER_H
+#include "solver.h"
+#endif
+
+#ifndef _SCI_READER_H
+#define _SCI_READER_H
+#include "sci_reader.h"
+#endif
+
+#ifndef _CHEN_ZERO_EQU_MODEL_H
+#define _CHEN_ZERO_EQU_MODEL_H
+#include "chen_zero_equ_model.h"
+#endif
+
+#define WARM_START_MIN_CELLS 4 /* Fewest coarse cells in a coarsened direction*/
+
+/* Cells of the fine and the coarse grid along one direction*/
+typedef struct {
+  int n; /* Number of interior fine cells*/
+  int r; /* Number of fine cells in a coarse cell; 1: not coarsened*/
+  int nc; /* Number of interior coarse cells*/
+  int *map; /* map[n+2]: Coarse cell of each fine cell*/
+  REAL *w; /* w[n+2]: Width of the fine cells; 1 for the ghost cells*/
+  REAL *wc; /* wc[nc+2]: Width of the coarse cells; 1 for the ghost cells*/
+  REAL *gc; /* gc[nc+2]: Surfaces of the coarse cells*/
+  int *lo[2]; /* lo[l][n+2]: Coarse point below a fine point; l=0: centers, 1: surfaces*/
+  REAL *t[2]; /* t[l][n+2]: Weight of the coarse point above a fine point*/
+}WARM_START_AXIS;
+
+/*
+	* Set the initial values from a steady solution on a coarse grid
+	*
+	* Nothing is done if init.coarse_step is 0 or if the initial values are
+	* read from a previous simulation. The function has to be called after
+	* the boundary conditions are assigned.
+	*
+	* @param para Pointer to FFD parameters
+	* @param var Pointer to FFD simulation variables
+	* @param BINDEX Pointer to boundary index
+	*
+	* @return 0 if no error occurred
+	*/
+int warm_start(PARA_DATA *para, REAL **var, int **BINDEX);